@@ -0,0 +1,352 @@
+#include "utils/Common.h"
+
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+// Regression gate between two Benchmarks.out JSON results (baseline then candidate):
+//   - per benchmark, one-sided Mann-Whitney U test on the repetition samples
+//     (no normality assumption, robust to outliers),
+//   - a regression is a change of the tracked metric (median by default) above the threshold
+//     AND significant (p-value below alpha), so noise alone never fails the gate,
+//   - a benchmark of the baseline missing from the candidate fails the gate (unless --allow-missing),
+//     so does one with too few repetitions for its p-value to ever be below alpha,
+//   - exit code 1 on any failure, 2 on unreadable input, an unknown metric or a result without
+//     the metric (e.g. written by another version), to be used locally or in CI.
+
+namespace
+{
+    struct Result
+    {
+        std::string name_;
+        std::map<std::string, double> metrics_; // min, median, p99, max, mean
+        std::vector<double> samples_;
+    };
+    struct Run
+    {
+        std::map<std::string, std::string> context_;
+        std::vector<Result> results_;
+    };
+
+    // Minimal reader of the JSON written by BenchmarkRunner (objects, arrays, strings, numbers)
+    class JsonReader
+    {
+    public:
+        explicit JsonReader(const std::string& json) : json_(json) {}
+
+        bool read(Run& run)
+        {
+            if (!accept('{')) return false;
+            do
+            {
+                std::string key;
+                if (!string(key) || !accept(':')) return false;
+                if ("context" == key) { if (!context(run)) return false; }
+                else if ("benchmarks" == key) { if (!benchmarks(run)) return false; }
+                else if (!skip()) return false;
+            } while (accept(','));
+            return accept('}');
+        }
+
+    private:
+        bool context(Run& run)
+        {
+            if (!accept('{')) return false;
+            if (accept('}')) return true;
+            do
+            {
+                std::string key, value;
+                if (!string(key) || !accept(':')) return false;
+                const auto start = pos_;
+                if (!skip()) return false;
+                value = json_.substr(start, pos_ - start);
+                run.context_[key] = value;
+            } while (accept(','));
+            return accept('}');
+        }
+        bool benchmarks(Run& run)
+        {
+            if (!accept('[')) return false;
+            if (accept(']')) return true;
+            do
+            {
+                Result result;
+                if (!accept('{')) return false;
+                do
+                {
+                    std::string key;
+                    if (!string(key) || !accept(':')) return false;
+                    if ("name" == key) { if (!string(result.name_)) return false; }
+                    else if ("samples" == key)
+                    {
+                        if (!accept('[')) return false;
+                        if (!accept(']'))
+                        {
+                            do
+                            {
+                                double sample = 0.0;
+                                if (!number(sample)) return false;
+                                result.samples_.emplace_back(sample);
+                            } while (accept(','));
+                            if (!accept(']')) return false;
+                        }
+                    }
+                    else if (peek() == '-' || (peek() >= '0' && peek() <= '9'))
+                    {
+                        double value = 0.0;
+                        if (!number(value)) return false;
+                        result.metrics_[key] = value;
+                    }
+                    else if (!skip()) return false;
+                } while (accept(','));
+                if (!accept('}')) return false;
+                run.results_.emplace_back(std::move(result));
+            } while (accept(','));
+            return accept(']');
+        }
+
+        char peek()
+        {
+            while (pos_ < json_.size() && isspace(static_cast<unsigned char>(json_[pos_]))) ++pos_;
+            return pos_ < json_.size() ? json_[pos_] : '\0';
+        }
+        bool accept(char c)
+        {
+            if (peek() != c) return false;
+            ++pos_;
+            return true;
+        }
+        bool string(std::string& str)
+        {
+            if (!accept('"')) return false;
+            str.clear();
+            while (pos_ < json_.size() && json_[pos_] != '"')
+            {
+                if ('\\' == json_[pos_] && pos_+1 < json_.size()) ++pos_;
+                str += json_[pos_++];
+            }
+            return accept('"');
+        }
+        bool number(double& value)
+        {
+            peek();
+            const char* begin = json_.c_str() + pos_;
+            char* end = nullptr;
+            value = strtod(begin, &end);
+            if (end == begin) return false;
+            pos_ += static_cast<size_t>(end - begin);
+            return true;
+        }
+        // Any value
+        bool skip()
+        {
+            const auto c = peek();
+            if ('"' == c) { std::string str; return string(str); }
+            if ('{' == c || '[' == c)
+            {
+                const auto close = ('{' == c) ? '}' : ']';
+                ++pos_;
+                if (accept(close)) return true;
+                do
+                {
+                    if ('}' == close)
+                    {
+                        std::string key;
+                        if (!string(key) || !accept(':')) return false;
+                    }
+                    if (!skip()) return false;
+                } while (accept(','));
+                return accept(close);
+            }
+            const auto start = pos_;
+            while (pos_ < json_.size() && (isalnum(static_cast<unsigned char>(json_[pos_])) || strchr("+-.", json_[pos_]))) ++pos_;
+            return pos_ > start;
+        }
+
+        const std::string& json_;
+        size_t pos_ = 0;
+    };
+
+    bool load(const std::string& filename, Run& run)
+    {
+        std::ifstream file(filename);
+        if (!file) return false;
+        std::stringstream content;
+        content << file.rdbuf();
+        const auto json = content.str();
+        return JsonReader(json).read(run);
+    }
+
+    // One-sided Mann-Whitney U test (normal approximation with ties and continuity corrections):
+    // p-value of "candidate samples are stochastically greater than baseline ones"
+    double mannWhitneyGreater(const std::vector<double>& baseline, const std::vector<double>& candidate)
+    {
+        const auto n1 = static_cast<double>(baseline.size());
+        const auto n2 = static_cast<double>(candidate.size());
+        if (baseline.empty() || candidate.empty()) return 1.0;
+        std::vector<std::pair<double, bool>> all; // value, from candidate
+        for (auto sample : baseline) all.emplace_back(sample, false);
+        for (auto sample : candidate) all.emplace_back(sample, true);
+        std::sort(all.begin(), all.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        auto rankSum = 0.0; // of candidate samples
+        auto ties = 0.0;
+        for (auto i = 0UL; i < all.size(); )
+        {
+            auto j = i;
+            while (j < all.size() && all[j].first == all[i].first) ++j;
+            const auto rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0; // average rank
+            for (auto k = i; k < j; ++k) if (all[k].second) rankSum += rank;
+            const auto t = static_cast<double>(j - i);
+            ties += t * t * t - t;
+            i = j;
+        }
+        const auto n = n1 + n2;
+        const auto u = rankSum - n2 * (n2 + 1.0) / 2.0;
+        const auto mu = n1 * n2 / 2.0;
+        const auto sigma = std::sqrt(n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0))));
+        if (sigma <= 0.0) return u > mu ? 0.0 : 1.0;
+        const auto z = (u - mu - 0.5) / sigma;
+        return 0.5 * std::erfc(z / std::sqrt(2.0));
+    }
+
+    // Lowest p-value reachable with these sample sizes (all candidate samples above baseline ones)
+    double minPValue(size_t nbBaseline, size_t nbCandidate)
+    {
+        std::vector<double> baseline(nbBaseline), candidate(nbCandidate);
+        for (auto i = 0UL; i < nbBaseline; ++i) baseline[i] = static_cast<double>(i);
+        for (auto i = 0UL; i < nbCandidate; ++i) candidate[i] = static_cast<double>(nbBaseline + i);
+        return mannWhitneyGreater(baseline, candidate);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> files;
+    auto threshold = 5.0;   // in %
+    auto alpha = 0.01;
+    const std::set<std::string> metrics{ "min", "median", "p99", "max", "mean" };
+    std::string metric("median");
+    std::string filter;
+    auto allowMissing = false;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--threshold") && i+1 < argc) threshold = std::stod(argv[++i]);
+        else if (!strcmp(argv[i], "--alpha") && i+1 < argc) alpha = std::stod(argv[++i]);
+        else if (!strcmp(argv[i], "--metric") && i+1 < argc)
+        {
+            metric = argv[++i];
+            if (!metrics.count(metric))
+            {
+                std::cerr << "Unknown metric [" << metric << "] (min, median, p99, max or mean)" << std::endl;
+                return 2;
+            }
+        }
+        else if (!strcmp(argv[i], "--filter") && i+1 < argc) filter = argv[++i];
+        else if (!strcmp(argv[i], "--allow-missing")) allowMissing = true;
+        else if ('-' != argv[i][0]) files.emplace_back(argv[i]);
+        else
+        {
+            files.clear();
+            break;
+        }
+    }
+    if (files.size() != 2)
+    {
+        std::cerr << "Usage:\t" << argv[0] << " <baseline.json> <candidate.json> [--threshold <%>] (default 5)"
+            " [--alpha <p-value>] (default 0.01) [--metric min|median|p99|max|mean] (default median) [--filter <substring>] [--allow-missing]" << std::endl;
+        return 2;
+    }
+
+    Run baseline, candidate;
+    for (auto run : { std::make_pair(&files[0], &baseline), std::make_pair(&files[1], &candidate) })
+    {
+        if (!load(*run.first, *run.second))
+        {
+            std::cerr << "Unable to read benchmark results [" << *run.first << "]" << std::endl;
+            return 2;
+        }
+    }
+    for (const auto* key : { "host", "compiler", "cpu", "depth" })
+    {
+        if (baseline.context_[key] != candidate.context_[key])
+            std::cout << "Warning: " << key << " differs (" << baseline.context_[key] << " vs "
+                << candidate.context_[key] << "), results may not be comparable" << std::endl;
+    }
+
+    std::map<std::string, const Result*> baselineResults;
+    for (const auto& result : baseline.results_) baselineResults[result.name_] = &result;
+
+    std::cout << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(12) << "baseline"
+        << std::setw(12) << "candidate" << std::setw(10) << "change" << std::setw(12) << "p-value" << "  (" << metric << " ns/op)" << std::endl;
+    auto nbRegressions = 0U, nbMissing = 0U, nbTooFewSamples = 0U, nbNoMetric = 0U;
+    for (const auto& result : candidate.results_)
+    {
+        if (!filter.empty() && result.name_.find(filter) == std::string::npos) continue;
+        auto itBaseline = baselineResults.find(result.name_);
+        if (itBaseline == baselineResults.end())
+        {
+            std::cout << std::left << std::setw(48) << result.name_ << "  new (no baseline)" << std::endl;
+            continue;
+        }
+        const auto& base = *itBaseline->second;
+        baselineResults.erase(itBaseline);
+        auto itBaseMetric = base.metrics_.find(metric);
+        auto itMetric = result.metrics_.find(metric);
+        if (itBaseMetric == base.metrics_.end() || itMetric == result.metrics_.end() || itBaseMetric->second <= 0.0)
+        {
+            std::cout << std::left << std::setw(48) << result.name_ << "  no [" << metric << "] metric" << std::endl;
+            ++nbNoMetric;
+            continue;
+        }
+        const auto change = (itMetric->second / itBaseMetric->second - 1.0) * 100.0;
+        const auto minP = minPValue(base.samples_.size(), result.samples_.size());
+        if (minP >= alpha)
+        {
+            std::cout << std::left << std::setw(48) << result.name_ << "  too few repetitions ([" << base.samples_.size()
+                << "] and [" << result.samples_.size() << "]): p-value >= " << minP << ", never below alpha" << std::endl;
+            ++nbTooFewSamples;
+            continue;
+        }
+        const auto pSlower = mannWhitneyGreater(base.samples_, result.samples_);
+        const auto pFaster = mannWhitneyGreater(result.samples_, base.samples_);
+        const char* verdict = "";
+        const auto p = (change > 0.0) ? pSlower : pFaster;
+        if (change > threshold && pSlower < alpha)
+        {
+            verdict = "  REGRESSION";
+            ++nbRegressions;
+        }
+        else if (change < -threshold && pFaster < alpha) verdict = "  faster";
+        std::cout << std::left << std::setw(48) << result.name_ << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << itBaseMetric->second << std::setw(12) << itMetric->second
+            << std::setw(9) << std::showpos << change << std::noshowpos << '%'
+            << std::setw(12) << std::setprecision(4) << p << verdict << std::endl;
+    }
+    for (const auto& missing : baselineResults)
+    {
+        if (filter.empty() || missing.first.find(filter) != std::string::npos)
+        {
+            std::cout << std::left << std::setw(48) << missing.first << "  missing from candidate" << std::endl;
+            if (!allowMissing) ++nbMissing;
+        }
+    }
+
+    std::cout << std::defaultfloat;
+    if (nbNoMetric)
+    {
+        std::cout << nbNoMetric << " benchmark(s) without a positive [" << metric << "] metric, not compared" << std::endl;
+        return 2;
+    }
+    if (nbRegressions || nbMissing || nbTooFewSamples)
+    {
+        std::cout << nbRegressions << " regression(s) above " << threshold << "% (alpha " << alpha << "), "
+            << nbMissing << " missing, " << nbTooFewSamples << " with too few repetitions" << std::endl;
+        return 1;
+    }
+    std::cout << "No regression above " << threshold << "% (alpha " << alpha << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "Benchmark.h"
+
+#include <utils/Tsc.h>
+
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+#include <sched.h>
+#include <unistd.h>
+
+bool BenchmarkRunner::parse(int argc, char** argv, Options& options)
+{
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--warmup") && i+1 < argc) options.warmup_ = static_cast<unsigned int>(std::stoul(argv[++i]));
+        else if (!strcmp(argv[i], "--repetitions") && i+1 < argc) options.repetitions_ = static_cast<unsigned int>(std::stoul(argv[++i]));
+        else if (!strcmp(argv[i], "--cpu") && i+1 < argc) options.cpu_ = std::stoi(argv[++i]);
+        else if (!strcmp(argv[i], "--depth") && i+1 < argc) options.depth_ = std::stoul(argv[++i]);
+        else if (!strcmp(argv[i], "--ops") && i+1 < argc) options.nbOps_ = std::stoul(argv[++i]);
+        else if (!strcmp(argv[i], "--chunks") && i+1 < argc) options.nbChunks_ = std::stoul(argv[++i]);
+        else if (!strcmp(argv[i], "--filter") && i+1 < argc) options.filter_ = argv[++i];
+        else if (!strcmp(argv[i], "--json") && i+1 < argc) options.json_ = argv[++i];
+        else
+        {
+            std::cerr << "Usage:\t" << argv[0] << " [--warmup <n>] [--repetitions <n>] [--cpu <cpu>] [--depth <levels>]"
+                " [--ops <n>] [--chunks <n>] [--filter <substring>] [--json <file>]" << std::endl;
+            return false;
+        }
+    }
+    if (options.repetitions_ < 1) options.repetitions_ = 1;
+    if (options.nbOps_ < 1) options.nbOps_ = 1;
+    if (options.nbChunks_ < 1) options.nbChunks_ = 1;
+    return true;
+}
+
+bool BenchmarkRunner::pin(int cpu)
+{
+    if (cpu < 0) return true;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(static_cast<size_t>(cpu) % CPU_SETSIZE, &cpuset);
+    return 0 == sched_setaffinity(0, sizeof(cpuset), &cpuset);
+}
+
+void BenchmarkRunner::add(Benchmark&& benchmark)
+{
+    if (options_.filter_.empty() || benchmark.name_.find(options_.filter_) != std::string::npos)
+        benchmarks_.emplace_back(std::move(benchmark));
+}
+
+int BenchmarkRunner::run(std::ostream& os)
+{
+    if (!pin(options_.cpu_))
+    {
+        std::cerr << "Unable to pin on cpu [" << options_.cpu_ << "]" << std::endl;
+        return -1;
+    }
+    tsc::nsPerTick(); // calibrate once
+
+    os << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(12) << "ops"
+        << std::setw(12) << "min" << std::setw(12) << "median" << std::setw(12) << "p99"
+        << std::setw(12) << "max" << std::setw(12) << "mean" << "  (ns/op)" << std::endl;
+    std::vector<double> chunkSamples;
+    for (auto& benchmark : benchmarks_)
+    {
+        BenchmarkResult result;
+        result.name_ = benchmark.name_;
+        result.nbOps_ = benchmark.nbOps_;
+        const auto chunk = (benchmark.nbOps_ + options_.nbChunks_ - 1) / options_.nbChunks_;
+        chunkSamples.clear();
+        for (auto rep = 0U; rep < options_.warmup_ + options_.repetitions_; ++rep)
+        {
+            if (benchmark.setup_) benchmark.setup_();
+            auto ticks = 0ULL;
+            for (auto first = 0UL; first < benchmark.nbOps_; first += chunk)
+            {
+                const auto last = std::min(first + chunk, benchmark.nbOps_);
+                const auto start = tsc::now();
+                benchmark.run_(first, last);
+                const auto end = tsc::now();
+                ticks += end - start;
+                if (rep >= options_.warmup_)
+                    chunkSamples.emplace_back(tsc::toNs(end - start) / static_cast<double>(last - first));
+            }
+            if (rep >= options_.warmup_)
+                result.samples_.emplace_back(tsc::toNs(ticks) / static_cast<double>(benchmark.nbOps_));
+        }
+
+        auto sorted = result.samples_;
+        std::sort(sorted.begin(), sorted.end());
+        const auto nb = sorted.size();
+        result.min_ = sorted.front();
+        result.median_ = (nb & 1) ? sorted[nb/2] : (sorted[nb/2-1] + sorted[nb/2]) / 2.0;
+        result.max_ = sorted.back();
+        // Nearest rank
+        const auto rank = (99 * chunkSamples.size() + 99) / 100 - 1;
+        std::nth_element(chunkSamples.begin(), chunkSamples.begin() + static_cast<std::ptrdiff_t>(rank), chunkSamples.end());
+        result.p99_ = chunkSamples[rank];
+        auto sum = 0.0;
+        for (auto sample : sorted) sum += sample;
+        result.mean_ = sum / static_cast<double>(nb);
+
+        os << std::left << std::setw(48) << result.name_ << std::right << std::setw(12) << result.nbOps_
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << result.min_ << std::setw(12) << result.median_ << std::setw(12) << result.p99_
+            << std::setw(12) << result.max_ << std::setw(12) << result.mean_ << std::endl;
+        results_.emplace_back(std::move(result));
+    }
+
+    if (!options_.json_.empty() && !writeJson())
+    {
+        std::cerr << "Unable to write [" << options_.json_ << "]" << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+bool BenchmarkRunner::writeJson() const
+{
+    std::ofstream json(options_.json_);
+    if (!json) return false;
+
+    auto quoted = [](const std::string& str)
+    {
+        std::string quoted("\"");
+        for (auto c : str)
+        {
+            if ('"' == c || '\\' == c) quoted += '\\';
+            quoted += c;
+        }
+        return quoted + '"';
+    };
+    char hostname[256] = "";
+    gethostname(hostname, sizeof(hostname)-1);
+    char date[32] = "";
+    const auto now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    json << std::setprecision(17);
+    json << "{\n  \"context\": {\n"
+        << "    \"date\": " << quoted(date) << ",\n"
+        << "    \"host\": " << quoted(hostname) << ",\n"
+        << "    \"compiler\": " << quoted(__VERSION__) << ",\n"
+        << "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"cpu\": " << options_.cpu_ << ",\n"
+        << "    \"ns_per_tick\": " << tsc::nsPerTick() << ",\n"
+        << "    \"warmup\": " << options_.warmup_ << ",\n"
+        << "    \"repetitions\": " << options_.repetitions_ << ",\n"
+        << "    \"chunks\": " << options_.nbChunks_ << ",\n"
+        << "    \"depth\": " << options_.depth_ << "\n  },\n"
+        << "  \"benchmarks\": [";
+    for (auto i = 0UL; i < results_.size(); ++i)
+    {
+        const auto& result = results_[i];
+        json << (i ? ",\n" : "\n")
+            << "    {\n      \"name\": " << quoted(result.name_) << ",\n"
+            << "      \"unit\": \"ns/op\",\n"
+            << "      \"ops\": " << result.nbOps_ << ",\n"
+            << "      \"min\": " << result.min_ << ",\n"
+            << "      \"median\": " << result.median_ << ",\n"
+            << "      \"p99\": " << result.p99_ << ",\n"
+            << "      \"max\": " << result.max_ << ",\n"
+            << "      \"mean\": " << result.mean_ << ",\n"
+            << "      \"samples\": [";
+        for (auto j = 0UL; j < result.samples_.size(); ++j)
+            json << (j ? ", " : "") << result.samples_[j];
+        json << "]\n    }";
+    }
+    json << "\n  ]\n}\n";
+    return static_cast<bool>(json);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Reproducible micro-benchmarks (separate from rapidcheck unit tests):
+//   - each repetition calls setup (not measured) then run on consecutive chunks of its nbOps
+//     operations, each chunk timed with the TSC,
+//   - first repetitions are warmup (not kept),
+//   - one sample per repetition (ns per operation) => min, median, max and mean of the repetitions,
+//     and one per chunk => p99 of the chunks (a slow chunk hides in a repetition mean),
+//   - results printed as a table and optionally written as JSON (with every repetition sample)
+//     for BenchCompare.out.
+
+struct Benchmark
+{
+    std::string name_;
+    size_t nbOps_ = 1;
+    std::function<void()> setup_;
+    // Operations [first, last) of the repetition (last == nbOps_ for its last chunk)
+    std::function<void(size_t first, size_t last)> run_;
+};
+
+struct BenchmarkResult
+{
+    std::string name_;
+    size_t nbOps_ = 0;
+    std::vector<double> samples_; // ns per operation, one per repetition
+    double min_ = 0.0;
+    double median_ = 0.0;
+    double p99_ = 0.0;            // of the chunks of all repetitions
+    double max_ = 0.0;
+    double mean_ = 0.0;
+};
+
+class BenchmarkRunner
+{
+public:
+    struct Options
+    {
+        unsigned int warmup_ = 3;
+        unsigned int repetitions_ = 20;
+        int cpu_ = -1;             // pin main thread (helper threads on cpu_+1), -1 => no pinning
+        size_t depth_ = 1'000;     // book depth (levels per side)
+        size_t nbOps_ = 10'000;    // operations per repetition
+        size_t nbChunks_ = 100;    // timed chunks per repetition (at most nbOps)
+        std::string filter_;       // only benchmarks whose name contains it
+        std::string json_;         // JSON output file
+    };
+    // Return false on unknown option (usage printed)
+    static bool parse(int argc, char** argv, Options& options);
+
+    explicit BenchmarkRunner(const Options& options) : options_(options) {}
+    BenchmarkRunner(const BenchmarkRunner&) = delete;
+    BenchmarkRunner& operator=(const BenchmarkRunner&) = delete;
+
+    const Options& options() const { return options_; }
+
+    void add(Benchmark&& benchmark);
+    // Return 0 on success
+    int run(std::ostream& os);
+
+    const std::vector<BenchmarkResult>& results() const { return results_; }
+
+    static bool pin(int cpu);
+
+    // Keep value (and its computation) from being optimized away
+    template <typename T>
+    static FORCE_INLINE void doNotOptimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+private:
+    bool writeJson() const;
+
+    const Options options_;
+    std::vector<Benchmark> benchmarks_;
+    std::vector<BenchmarkResult> results_;
+};
@@ -0,0 +1,246 @@
+#include "Benchmark.h"
+
+#include <FeedHandler.h>
+#include <Reporter.h>
+#include <utils/Parser.h>
+#include <utils/Decoder.h>
+#include <utils/StrStream.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>
+
+// Feed prefilled with depth levels per side (one order per level), events already consumed
+struct Book
+{
+    void reset(size_t depth)
+    {
+        feed_.reset();
+        queue_ = std::make_unique<WaitFreeQueue<FeedHandler::Data>>();
+        queue_->dontSpin();
+        feed_ = std::make_unique<FeedHandler>(*queue_);
+        base_ = depth + 10;
+        for (auto i = 0UL; i < depth; ++i)
+        {
+            process(message('A', 2*i+1, 'B', 100, static_cast<Price>(base_ - i)));
+            process(message('A', 2*i+2, 'S', 100, static_cast<Price>(base_ + 1 + i)));
+        }
+        drain();
+    }
+    void drain()
+    {
+        while (queue_->pop_front().action_);
+    }
+    void process(const std::string& msg)
+    {
+        feed_->processMessage(msg.c_str(), msg.length(), errors_);
+    }
+    static std::string message(char action, size_t orderId, char side, Quantity qty, Price price)
+    {
+        StrStream strstream;
+        strstream << action << ',' << orderId << ',' << side << ',' << qty << ',' << price;
+        return std::string(strstream.c_str(), strstream.length());
+    }
+
+    std::unique_ptr<WaitFreeQueue<FeedHandler::Data>> queue_;
+    std::unique_ptr<FeedHandler> feed_;
+    Errors errors_;
+    size_t base_ = 0;
+};
+
+int main(int argc, char **argv)
+{
+    BenchmarkRunner::Options options;
+    if (!BenchmarkRunner::parse(argc, argv, options)) return -1;
+    BenchmarkRunner runner(options);
+    const auto nbOps = options.nbOps_;
+    const auto depth = options.depth_;
+    const auto helperCpu = options.cpu_ < 0 ? -1 : options.cpu_ + 1;
+    const std::string depthName = "(depth " + std::to_string(depth) + ")";
+
+    // Parser and Decoder
+
+    auto addParser = [&](const char* name, const char* msg)
+    {
+        const auto len = strlen(msg);
+        runner.add({name, nbOps, nullptr, [=](size_t first, size_t last)
+        {
+            Errors errors;
+            for (auto i = first; i < last; ++i)
+            {
+                Parser p;
+                BenchmarkRunner::doNotOptimize(p.parse(msg, len, errors));
+                BenchmarkRunner::doNotOptimize(p.getPrice());
+            }
+        }});
+    };
+    addParser("Parser/add", "A,100000,S,1,1075");
+    addParser("Parser/cancel", "X,100004,B,10,950.125");
+    addParser("Parser/trade", "T,2,1025");
+    addParser("Parser/corrupted", "A,100000,S,1a,1075");
+
+    runner.add({"Decoder/retreive_unsigned_integer", nbOps, nullptr, [=](size_t first, size_t last)
+    {
+        static const char str[] = "123456789";
+        for (auto i = first; i < last; ++i)
+            BenchmarkRunner::doNotOptimize(Decoder::retreive_unsigned_integer<Quantity>(str, 9));
+    }});
+    runner.add({"Decoder/convert_unsigned_integer", nbOps, nullptr, [=](size_t first, size_t last)
+    {
+        char buf[32];
+        for (auto i = first; i < last; ++i)
+        {
+            BenchmarkRunner::doNotOptimize(Decoder::convert_unsigned_integer<Quantity>(static_cast<Quantity>(i), buf));
+            BenchmarkRunner::doNotOptimize(buf[0]);
+        }
+    }});
+    runner.add({"Decoder/retreive_unsigned_float", nbOps, nullptr, [=](size_t first, size_t last)
+    {
+        static const char str[] = "123456.789";
+        for (auto i = first; i < last; ++i)
+            BenchmarkRunner::doNotOptimize(Decoder::retreive_unsigned_float<Price>(str, 10));
+    }});
+    runner.add({"Decoder/convert_unsigned_float", nbOps, nullptr, [=](size_t first, size_t last)
+    {
+        char buf[64];
+        for (auto i = first; i < last; ++i)
+        {
+            BenchmarkRunner::doNotOptimize(Decoder::convert_unsigned_float<Price>(buf, 1234.5 + static_cast<Price>(i), 6));
+            BenchmarkRunner::doNotOptimize(buf[0]);
+        }
+    }});
+
+    // Book operations (one message parsed and applied per operation, events published but not consumed)
+
+    auto book = std::make_shared<Book>();
+    std::vector<std::string> messages;
+    // Add then cancel an order at the given distance from the best bid => depth unchanged
+    auto addBookAddCancel = [&](const char* name, size_t distance)
+    {
+        runner.add({std::string(name) + ' ' + depthName, nbOps, [=, &messages]()
+        {
+            book->reset(depth);
+            const auto price = static_cast<Price>(book->base_) - static_cast<Price>(distance) + 0.5;
+            messages.clear();
+            for (auto i = 0UL; i < nbOps; i += 2)
+            {
+                messages.emplace_back(Book::message('A', 10*depth + i, 'B', 10, price));
+                messages.emplace_back(Book::message('X', 10*depth + i, 'B', 10, price));
+            }
+        }, [=, &messages](size_t first, size_t last)
+        {
+            for (auto i = first; i < last; ++i) book->process(messages[i]);
+        }});
+    };
+    addBookAddCancel("Book/add+cancel best", 0);
+    addBookAddCancel("Book/add+cancel middle", depth/2);
+    addBookAddCancel("Book/add+cancel worst", depth);
+    runner.add({"Book/modify best " + depthName, nbOps, [=, &messages]()
+    {
+        book->reset(depth);
+        messages.clear();
+        for (auto i = 0UL; i < nbOps; ++i)
+            messages.emplace_back(Book::message('M', 1, 'B', (i & 1) ? 100 : 50, static_cast<Price>(book->base_)));
+    }, [=, &messages](size_t first, size_t last)
+    {
+        for (auto i = first; i < last; ++i) book->process(messages[i]);
+    }});
+    runner.add({"Book/trade " + depthName, nbOps, [=, &messages]()
+    {
+        book->reset(depth);
+        messages.assign(1, "T,10,1025");
+    }, [=, &messages](size_t first, size_t last)
+    {
+        for (auto i = first; i < last; ++i) book->process(messages[0]);
+    }});
+
+    // Queue handoff between feed and reporter threads
+
+    auto queue = std::make_shared<std::unique_ptr<WaitFreeQueue<FeedHandler::Data>>>();
+    runner.add({"Queue/WaitFreeQueue push+pop", nbOps, [=]()
+    {
+        *queue = std::make_unique<WaitFreeQueue<FeedHandler::Data>>();
+    }, [=](size_t first, size_t last)
+    {
+        for (auto i = first; i < last; ++i)
+        {
+            (*queue)->push_back(FeedHandler::Data('A', 'B', 0));
+            BenchmarkRunner::doNotOptimize((*queue)->pop_front().action_);
+        }
+    }});
+    auto conflatedQueue = std::make_shared<std::unique_ptr<FeedHandler::ConflatedQueue>>();
+    auto consumer = std::make_shared<std::thread>();
+    runner.add({"Queue/WaitFreeQueue handoff", nbOps, [=]()
+    {
+        *queue = std::make_unique<WaitFreeQueue<FeedHandler::Data>>();
+        *consumer = std::thread([=]()
+        {
+            BenchmarkRunner::pin(helperCpu);
+            while ((*queue)->pop_front().action_);
+        });
+    }, [=](size_t first, size_t last)
+    {
+        for (auto i = first; i < last; ++i) (*queue)->push_back(FeedHandler::Data('A', 'B', 0));
+        // Drained by the consumer within the last chunk
+        if (last < nbOps) return;
+        (*queue)->dontSpin();
+        consumer->join();
+    }});
+    runner.add({"Queue/ConflatingQueue handoff (64 keys)", nbOps, [=]()
+    {
+        *conflatedQueue = std::make_unique<FeedHandler::ConflatedQueue>();
+        *consumer = std::thread([=]()
+        {
+            BenchmarkRunner::pin(helperCpu);
+            while ((*conflatedQueue)->pop_front().action_);
+        });
+    }, [=](size_t first, size_t last)
+    {
+        for (auto i = first; i < last; ++i) (*conflatedQueue)->push_back(i & 63, FeedHandler::Data('M', 'B', 0));
+        if (last < nbOps) return;
+        (*conflatedQueue)->dontSpin();
+        consumer->join();
+    }});
+
+    // Printing (to /dev/null)
+
+    auto null = std::make_shared<std::ofstream>("/dev/null");
+    auto reporter = std::make_shared<std::unique_ptr<Reporter>>();
+    auto addPrintMidQuotes = [&](const char* name, size_t flushSize)
+    {
+        runner.add({name, nbOps, [=]()
+        {
+            reporter->reset(); // before its book
+            book->reset(1);
+            *reporter = std::make_unique<Reporter>(*book->feed_);
+            (*reporter)->setPacing(Reporter::Pacing{Reporter::Pacing::Mode::EVERY_EVENT, 1ULL, flushSize, 0ULL});
+        }, [=](size_t first, size_t last)
+        {
+            Errors errors;
+            for (auto i = first; i < last; ++i)
+            {
+                FeedHandler::Data data('M', 'B', 0);
+                data.bookVersion_ = i+1;
+                data.bestBid_ = Limit{100, 1000.0 + static_cast<Price>(i & 7)};
+                data.bestAsk_ = Limit{100, 1010.0};
+                (*reporter)->processData(std::move(data));
+                (*reporter)->printMidQuotesAndTrades(*null, errors);
+            }
+            if (last == nbOps) (*reporter)->flush();
+        }});
+    };
+    addPrintMidQuotes("Print/mid-quotes", 0UL);
+    addPrintMidQuotes("Print/mid-quotes buffered 16k", 16'384UL);
+    const auto nbPrints = std::max<size_t>(1UL, nbOps / std::max<size_t>(1UL, depth));
+    runner.add({"Print/orderbook " + depthName, nbPrints, [=]()
+    {
+        reporter->reset();
+        book->reset(depth);
+        *reporter = std::make_unique<Reporter>(*book->feed_);
+    }, [=](size_t first, size_t last)
+    {
+        for (auto i = first; i < last; ++i) (*reporter)->printCurrentOrderBook(*null);
+    }});
+
+    return runner.run(std::cout);
+}
@@ -0,0 +1,51 @@
+#include "Workload.h"
+
+#include <cstring>
+#include <memory>
+
+// Native replacement of tools/genOrders.py (no Python nor OrderBook submodule)
+int main(int argc, char **argv)
+{
+    Workload::Profile profile;
+    std::string output;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--output") && i+1 < argc) output = argv[++i];
+        else if (!Workload::parse(i, argc, argv, profile))
+        {
+            std::cerr << "Usage:\t" << argv[0] << " [--output <file>] (default stdout) [workload options]\n"
+                << Workload::usage() << std::flush;
+            return -1;
+        }
+    }
+
+    std::unique_ptr<std::ofstream> file;
+    if (!output.empty())
+    {
+        file = std::make_unique<std::ofstream>(output, std::ios::binary);
+        if (!*file)
+        {
+            std::cerr << "Unable to write [" << output << "]" << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& os = file ? *file : std::cout;
+    std::cout.sync_with_stdio(false);
+
+    Workload workload(profile);
+    std::string chunk;
+    chunk.reserve(1 << 22);
+    while (!workload.done())
+    {
+        chunk.clear();
+        workload.generate(chunk, 65'536ULL);
+        os.rdbuf()->sputn(chunk.c_str(), static_cast<std::streamsize>(chunk.length()));
+    }
+    os.flush();
+
+    const auto& counts = workload.counts();
+    std::cerr << "Generated [" << workload.nbMessages() << "] messages: adds [" << counts.adds_
+        << "] modifies [" << counts.modifies_ << "] cancels [" << counts.cancels_ << "] trades [" << counts.trades_
+        << "], [" << workload.nbLiveOrders() << "] live orders at the end" << std::endl;
+    return os ? 0 : -1;
+}
@@ -0,0 +1,123 @@
+#include <Exchange.h>
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Order entry load against a running exchange simulator (build/main/exchange <address>):
+// one connection sends random adds (passive or crossing the mid), cancels and modifies of its resting
+// orders by batches while a second thread drains executions, book updates and rejects.
+// Reports the orders per second sustained by the exchange (until its last response is received).
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || !strcmp(argv[1], "-h"))
+    {
+        std::cerr << "Usage:\t" << argv[0] << " <address> [--orders <n>] (default 10000000) [--batch <orders>] (per write, default 256)\n"
+                  << "\t[--cross <ratio>] (of adds, default 0.1) [--cancel <ratio>] [--modify <ratio>] (of orders, default 0.3 and 0.1)\n"
+                  << "\t[--seed <n>] [--first-id <n>] (order ids from, default 1, distinct per concurrent client)" << std::endl;
+        return -1;
+    }
+    const std::string address(argv[1]);
+    auto nbOrders = 10'000'000UL;
+    auto batchSize = 256UL;
+    auto crossRatio = 0.1, cancelRatio = 0.3, modifyRatio = 0.1;
+    auto seed = 1UL;
+    OrderId nextId = 1;
+    for (auto i = 2; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--orders") && i+1 < argc) nbOrders = std::stoul(argv[++i]);
+        else if (!strcmp(argv[i], "--batch") && i+1 < argc) batchSize = std::max(1UL, std::stoul(argv[++i]));
+        else if (!strcmp(argv[i], "--cross") && i+1 < argc) crossRatio = std::stod(argv[++i]);
+        else if (!strcmp(argv[i], "--cancel") && i+1 < argc) cancelRatio = std::stod(argv[++i]);
+        else if (!strcmp(argv[i], "--modify") && i+1 < argc) modifyRatio = std::stod(argv[++i]);
+        else if (!strcmp(argv[i], "--seed") && i+1 < argc) seed = std::stoul(argv[++i]);
+        else if (!strcmp(argv[i], "--first-id") && i+1 < argc) nextId = static_cast<OrderId>(std::stoul(argv[++i]));
+    }
+
+    exchange::Client client;
+    if (!client.connect(address))
+    {
+        std::cerr << "Unable to connect to the exchange on [" << address << "]: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    unsigned long long nbFrames[256] = {};
+    std::thread receiver([&]()
+    {
+        std::vector<exchange::Frame> frames(4096);
+        for (auto nb = client.receive(frames.data(), frames.size()); nb; nb = client.receive(frames.data(), frames.size()))
+        {
+            for (auto i = 0UL; i < nb; ++i) ++nbFrames[static_cast<unsigned char>(frames[i].type())];
+        }
+    });
+
+    // Resting orders sent by this client (some are filled meanwhile: their cancels are rejected)
+    std::vector<exchange::OrderMsg> resting;
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> ratio(0.0, 1.0);
+    std::uniform_int_distribution<int> ticks(1, 20);
+    std::uniform_int_distribution<Quantity> quantities(1, 1'000);
+    const Price mid = 1'000.0;
+    std::vector<exchange::OrderMsg> batch;
+    batch.reserve(batchSize);
+
+    using std::chrono::high_resolution_clock;
+    const auto start = high_resolution_clock::now();
+    for (auto i = 0UL; i < nbOrders; ++i)
+    {
+        exchange::OrderMsg msg;
+        const auto draw = ratio(rng);
+        if (!resting.empty() && draw < cancelRatio + modifyRatio)
+        {
+            const auto index = static_cast<size_t>(rng() % resting.size());
+            msg = resting[index];
+            if (draw < cancelRatio)
+            {
+                msg.action_ = 'X';
+                resting[index] = resting.back();
+                resting.pop_back();
+            }
+            else
+            {
+                msg.action_ = 'M';
+                msg.qty_ = quantities(rng);
+                resting[index].qty_ = msg.qty_;
+            }
+        }
+        else
+        {
+            msg.action_ = 'A';
+            msg.side_ = (rng() & 1U) ? 'B' : 'S';
+            msg.orderId_ = nextId++;
+            msg.qty_ = quantities(rng);
+            const auto cross = ratio(rng) < crossRatio;
+            const auto offset = static_cast<Price>(ticks(rng));
+            msg.price_ = ('B' == msg.side_) == cross ? mid + offset : mid - offset;
+            if (!cross) resting.push_back(msg);
+        }
+        batch.push_back(msg);
+        if (batch.size() == batchSize || i + 1 == nbOrders)
+        {
+            if (!client.send(batch.data(), batch.size()))
+            {
+                std::cerr << "Exchange connection lost" << std::endl;
+                break;
+            }
+            batch.clear();
+        }
+    }
+    client.shutdown();
+    receiver.join();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+    std::cout << "Orders [" << nbOrders << "] in [" << elapsed << "] usec: ["
+        << static_cast<unsigned long long>(static_cast<double>(nbOrders) * 1e6 / static_cast<double>(std::max<long long>(elapsed, 1LL)))
+        << "] orders/s" << std::endl;
+    std::cout << "Received executions [" << nbFrames[static_cast<unsigned char>(exchange::ExecutionMsg::TYPE)]
+        << "] book updates [" << nbFrames[static_cast<unsigned char>(exchange::BookMsg::TYPE)]
+        << "] rejects [" << nbFrames[static_cast<unsigned char>(exchange::RejectMsg::TYPE)] << "]" << std::endl;
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include "Benchmark.h"
+#include "Workload.h"
+
+#include <FeedHandler.h>
+#include <Reporter.h>
+#include <utils/SimpleBuffer.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// End-to-end replay: FeedHandler thread over a message file (or a generated workload, in chunks
+// generated out of the measured time) and a Reporter thread consuming every update.
+// Reports throughput and latency percentiles (TSC, from message received to book applied and
+// to update consumed) to size hardware against expected volumes.
+
+namespace
+{
+    struct Totals
+    {
+        unsigned long long nbMessages_ = 0ULL;
+        unsigned long long nbBytes_ = 0ULL;
+        unsigned long long ticks_ = 0ULL;
+    };
+
+    template <typename Feed>
+    void replay(Feed& feed, const char* data, size_t size, Errors& errors, Totals& totals)
+    {
+        SimpleBuffer sbuffer(const_cast<char*>(data), size);
+        sbuffer.seekEnd(size);
+        const auto start = tsc::now();
+        while (sbuffer.available())
+        {
+            auto pos = sbuffer.getPosition('\n');
+            if (unlikely(pos < 0)) break;
+            feed.processMessage(static_cast<const char*>(&sbuffer[0]), pos, errors);
+            sbuffer.seek(pos+1);
+            ++totals.nbMessages_;
+        }
+        totals.ticks_ += tsc::now() - start;
+        totals.nbBytes_ += size;
+    }
+
+    void printAll(std::ostream& os, const char* stage, const Latency& latency)
+    {
+        Latency::Hist all;
+        for (auto action : { 'A', 'M', 'X', 'T' })
+            for (auto side : { 'B', 'S' }) all += latency.get(action, side);
+        auto ns = [](unsigned long long ticks) { return static_cast<unsigned long long>(tsc::toNs(ticks) + 0.5); };
+        os << "Latency (in ns) " << stage << ": count [" << all.count() << "] p50 [" << ns(all.percentile(50.0))
+            << "] p90 [" << ns(all.percentile(90.0)) << "] p99 [" << ns(all.percentile(99.0))
+            << "] p99.9 [" << ns(all.percentile(99.9)) << "] p99.99 [" << ns(all.percentile(99.99))
+            << "] max [" << ns(all.max()) << "]" << std::endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string filename;
+    Workload::Profile profile;
+    auto generate = false;
+    auto conflate = false;
+    auto print = false;
+    auto cpu = -1;
+    unsigned long long chunk = 1'000'000ULL;
+    auto waitMode = WaitStrategy::Mode::BUSY_SPIN;
+    auto batchSize = 1UL;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--generate")) generate = true;
+        else if (!strcmp(argv[i], "--conflate")) conflate = true;
+        else if (!strcmp(argv[i], "--print")) print = true;
+        else if (!strcmp(argv[i], "--cpu") && i+1 < argc) cpu = std::stoi(argv[++i]);
+        else if (!strcmp(argv[i], "--chunk") && i+1 < argc) chunk = std::max(1ULL, std::stoull(argv[++i]));
+        else if (!strcmp(argv[i], "--batch") && i+1 < argc) batchSize = std::max(1UL, std::stoul(argv[++i]));
+        else if (!strcmp(argv[i], "--wait") && i+1 < argc && WaitStrategy::parse(argv[i+1], waitMode)) ++i;
+        else if (Workload::parse(i, argc, argv, profile)) generate = true;
+        else if ('-' != argv[i][0] && filename.empty()) filename = argv[i];
+        else
+        {
+            std::cerr << "Usage:\t" << argv[0] << " <file> | --generate [workload options]\n"
+                << "\t[--cpu <cpu>] (feed thread, reporter on cpu+1) [--conflate] [--print] (mid-quotes to /dev/null)\n"
+                << "\t[--chunk <messages>] (generated per chunk, default 1000000) [--wait spin|yield|park] (reporter, default spin)\n"
+                << "\t[--batch <max>] (updates drained per lock by the reporter, default 1)\n"
+                << Workload::usage() << std::flush;
+            return -1;
+        }
+    }
+    if (filename.empty() == !generate)
+    {
+        std::cerr << "Expected either a file or generated messages (see -h)" << std::endl;
+        return -1;
+    }
+
+    // Mapped before the consumer thread starts: nothing to join on error
+    int fd = -1;
+    size_t filesize = 0UL;
+    void* mmappedData = nullptr;
+    if (!generate)
+    {
+        fd = open(filename.c_str(), O_RDONLY, 0);
+        struct stat st;
+        if (-1 == fd || -1 == fstat(fd, &st))
+        {
+            std::cerr << "File [" << filename << "] not readable!" << std::endl;
+            return -1;
+        }
+        filesize = static_cast<size_t>(st.st_size);
+        mmappedData = mmap(0, filesize, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (unlikely(mmappedData == MAP_FAILED))
+        {
+            std::cerr << "Unable to mmap file [" << filename << "]!" << std::endl;
+            return -1;
+        }
+    }
+
+    tsc::nsPerTick(); // calibrate once out of the critical path
+    WaitFreeQueue<FeedHandler::Data> queue;
+    FeedHandler::ConflatedQueue conflatedQueue;
+    queue.setWaitStrategy(waitMode);
+    conflatedQueue.setWaitStrategy(waitMode);
+    auto feed = conflate ? std::make_unique<FeedHandler>(conflatedQueue) : std::make_unique<FeedHandler>(queue);
+    Latency feedLatency, reporterLatency;
+    feed->setLatency(&feedLatency);
+
+    Reporter reporter(*feed);
+    reporter.setLatency(&reporterLatency);
+    Errors errors, reporterErrors;
+    auto consumer = [&](auto& queue)
+    {
+        BenchmarkRunner::pin(cpu < 0 ? -1 : cpu + 1);
+        std::ofstream null("/dev/null");
+        if (batchSize > 1UL)
+        {
+            std::vector<FeedHandler::Data> batch(batchSize);
+            for (auto nb = queue.pop_front(batch.data(), batchSize); nb; nb = queue.pop_front(batch.data(), batchSize))
+            {
+                if (print)
+                {
+                    if (reporter.processBatch(batch.data(), nb, null, reporterErrors) < nb) break;
+                }
+                else for (auto i = 0UL; i < nb; ++i) reporter.processData(std::move(batch[i]));
+            }
+        }
+        else while (reporter.processData(queue.pop_front()))
+        {
+            if (print) reporter.printMidQuotesAndTrades(null, reporterErrors);
+        }
+        reporter.flush();
+    };
+    std::thread thr = conflate ? std::thread([&]() { consumer(conflatedQueue); })
+                               : std::thread([&]() { consumer(queue); });
+    if (!BenchmarkRunner::pin(cpu)) std::cerr << "Unable to pin on cpu [" << cpu << "]" << std::endl;
+
+    Totals totals;
+    auto generateTicks = 0ULL;
+    const auto start = tsc::now();
+    if (generate)
+    {
+        Workload workload(profile);
+        std::string messages;
+        while (!workload.done())
+        {
+            const auto startGenerate = tsc::now();
+            messages.clear();
+            workload.generate(messages, chunk);
+            generateTicks += tsc::now() - startGenerate;
+            replay(*feed, messages.c_str(), messages.length(), errors, totals);
+        }
+    }
+    else
+    {
+        replay(*feed, static_cast<const char*>(mmappedData), filesize, errors, totals);
+        munmap(mmappedData, filesize);
+        close(fd);
+    }
+    queue.dontSpin();
+    conflatedQueue.dontSpin();
+    thr.join();
+    const auto endToEndNs = tsc::toNs(tsc::now() - start - generateTicks);
+
+    const auto seconds = tsc::toNs(totals.ticks_) / 1e9;
+    std::cout << std::fixed << std::setprecision(3)
+        << "Replayed [" << totals.nbMessages_ << "] messages (" << static_cast<double>(totals.nbBytes_) / 1e6 << " MB) in "
+        << seconds << " sec: " << static_cast<double>(totals.nbMessages_) / seconds / 1e6 << " M msg/s, "
+        << static_cast<double>(totals.nbBytes_) / seconds / 1e6 << " MB/s (until consumed "
+        << endToEndNs / 1e9 << " sec)" << std::endl;
+    std::cout << "Errors [" << errors.nbErrors() + reporterErrors.nbErrors() << "]" << std::endl;
+    printAll(std::cout, "until book applied", feedLatency);
+    printAll(std::cout, "until consumed", reporterLatency);
+    feedLatency.print(std::cout, "until book applied");
+    reporterLatency.print(std::cout, "until consumed");
+    return 0;
+}
@@ -0,0 +1,345 @@
+#include "Workload.h"
+
+#include <utils/Decoder.h>
+
+#include <cstring>
+
+Workload::Rng::Rng(unsigned long long seed)
+{
+    for (auto& s : s_)
+    {
+        seed += 0x9e3779b97f4a7c15ULL;
+        auto z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        s = z ^ (z >> 31);
+    }
+}
+
+unsigned long long Workload::Rng::next()
+{
+    auto rotl = [](unsigned long long x, int k) { return (x << k) | (x >> (64 - k)); };
+    const auto result = rotl(s_[1] * 5, 7) * 9;
+    const auto t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+    return result;
+}
+
+bool Workload::preset(const std::string& name, Profile& profile)
+{
+    if ("default" == name) return true;
+    if ("calm" == name)
+    {
+        profile.cancelRatio_ = 0.45;
+        profile.modifyRatio_ = 0.05;
+        profile.tradeRatio_ = 0.005;
+        profile.drift_ = 0.002;
+        return true;
+    }
+    if ("volatile" == name)
+    {
+        profile.cancelRatio_ = 0.38;
+        profile.modifyRatio_ = 0.04;
+        profile.tradeRatio_ = 0.08;
+        profile.drift_ = 0.05;
+        return true;
+    }
+    if ("bursty" == name)
+    {
+        profile.burstiness_ = 0.01;
+        profile.burstLength_ = 64U;
+        return true;
+    }
+    return false;
+}
+
+bool Workload::parse(int& i, int argc, char** argv, Profile& profile)
+{
+    if (i+1 >= argc) return false;
+    const char* option = argv[i];
+    const char* value = argv[i+1];
+    if (!strcmp(option, "--profile")) { if (!preset(value, profile)) return false; }
+    else if (!strcmp(option, "--seed")) profile.seed_ = std::stoull(value);
+    else if (!strcmp(option, "--messages")) profile.nbMessages_ = std::stoull(value);
+    else if (!strcmp(option, "--depth")) profile.depth_ = static_cast<unsigned int>(std::max(1UL, std::stoul(value)));
+    else if (!strcmp(option, "--orders-per-level")) profile.ordersPerLevel_ = static_cast<unsigned int>(std::max(1UL, std::stoul(value)));
+    else if (!strcmp(option, "--cancel")) profile.cancelRatio_ = std::stod(value);
+    else if (!strcmp(option, "--modify")) profile.modifyRatio_ = std::stod(value);
+    else if (!strcmp(option, "--trade")) profile.tradeRatio_ = std::stod(value);
+    else if (!strcmp(option, "--drift")) profile.drift_ = std::stod(value);
+    else if (!strcmp(option, "--burstiness")) profile.burstiness_ = std::stod(value);
+    else if (!strcmp(option, "--burst-length")) profile.burstLength_ = static_cast<unsigned int>(std::max(1UL, std::stoul(value)));
+    else if (!strcmp(option, "--decimals")) profile.decimals_ = static_cast<unsigned int>(std::min(6UL, std::stoul(value)));
+    else return false;
+    ++i;
+    return true;
+}
+
+const char* Workload::usage()
+{
+    return "\t--profile <calm|default|volatile|bursty> (preset, later options override it)\n"
+           "\t--seed <n> --messages <n> --depth <levels per side> --orders-per-level <n>\n"
+           "\t--cancel <ratio> --modify <ratio> --trade <ratio> (of messages, remaining ones are adds)\n"
+           "\t--drift <probability of a one tick mid move per message>\n"
+           "\t--burstiness <probability of a flickering burst per message> --burst-length <mean messages>\n"
+           "\t--decimals <price decimals, 0 to 6>\n";
+}
+
+Workload::Workload(const Profile& profile)
+    : profile_(profile)
+    , rng_(profile.seed_)
+{
+    for (auto i = 0U; i < profile_.decimals_; ++i) pow10_ *= 10;
+    mid_ = std::max(static_cast<long long>(profile_.midTicks_), static_cast<long long>(profile_.depth_) + 2);
+    targetOrders_ = 2ULL * profile_.depth_ * profile_.ordersPerLevel_;
+    live_.reserve(2 * targetOrders_);
+    index_.reserve(2 * targetOrders_);
+}
+
+unsigned long long Workload::generate(std::string& out, unsigned long long nbMessages)
+{
+    const auto start = nbMessages_;
+    while (nbMessages_ - start < nbMessages && !done()) step(out);
+    return nbMessages_ - start;
+}
+
+void Workload::step(std::string& out)
+{
+    // Prefill: ordersPerLevel orders on each of the depth levels per side
+    if (unlikely(nbPrefilled_ < targetOrders_))
+    {
+        const auto level = static_cast<long long>(nbPrefilled_ / 2 / profile_.ordersPerLevel_);
+        if (0 == (nbPrefilled_ & 1)) add(out, 'B', mid_ - 1 - level, quantity());
+        else add(out, 'S', mid_ + 1 + level, quantity());
+        ++nbPrefilled_;
+        return;
+    }
+
+    if (rng_.chance(profile_.drift_))
+    {
+        mid_ += rng_.chance(0.5) ? 1 : -1;
+        mid_ = std::max(mid_, static_cast<long long>(profile_.depth_) + 2);
+    }
+
+    if (burstRemaining_ > 0ULL || (profile_.burstiness_ > 0.0 && rng_.chance(profile_.burstiness_)))
+    {
+        if (0ULL == burstRemaining_)
+        {
+            burstRemaining_ = 1ULL + rng_.below(2ULL * profile_.burstLength_);
+            burstSide_ = rng_.chance(0.5) ? 'B' : 'S';
+        }
+        burst(out);
+        return;
+    }
+
+    // Keep the book size around its target whatever the ratios
+    const auto nbLive = static_cast<unsigned long long>(live_.size());
+    auto u = rng_.uniform();
+    if (unlikely(0ULL == nbLive || nbLive < targetOrders_ / 4)) u = 1.0;
+    else if (unlikely(nbLive > 2 * targetOrders_)) u = 0.0;
+
+    if (u < profile_.cancelRatio_) cancel(out, static_cast<size_t>(rng_.below(nbLive)));
+    else if (u < profile_.cancelRatio_ + profile_.modifyRatio_) modify(out, static_cast<size_t>(rng_.below(nbLive)));
+    else
+    {
+        const auto side = rng_.chance(0.5) ? 'B' : 'S';
+        const auto qty = quantity();
+        if (u < profile_.cancelRatio_ + profile_.modifyRatio_ + profile_.tradeRatio_)
+        {
+            // Aggressive order up to 2 ticks through the opposite best
+            if ('B' == side && !asks_.empty())
+            {
+                aggress(out, side, asks_.begin()->first + static_cast<long long>(rng_.below(3)), qty);
+                return;
+            }
+            if ('S' == side && !bids_.empty())
+            {
+                aggress(out, side, bids_.begin()->first - static_cast<long long>(rng_.below(3)), qty);
+                return;
+            }
+        }
+        // Passive order (aggressive one if the mid drifted through the opposite side)
+        const auto tick = passiveTick(side);
+        if (('B' == side && !asks_.empty() && tick >= asks_.begin()->first) ||
+            ('S' == side && !bids_.empty() && tick <= bids_.begin()->first))
+            aggress(out, side, tick, qty);
+        else add(out, side, tick, qty);
+    }
+}
+
+void Workload::burst(std::string& out)
+{
+    --burstRemaining_;
+    auto itOrder = index_.find(burstOrder_);
+    if (0 != burstOrder_ && itOrder != index_.end())
+    {
+        cancel(out, itOrder->second);
+        burstOrder_ = 0;
+        return;
+    }
+    // Join the best level or improve it by one tick while the spread allows it
+    long long tick = 0;
+    if ('B' == burstSide_)
+    {
+        tick = bids_.empty() ? mid_ - 1 : bids_.begin()->first;
+        if (!asks_.empty()) tick = std::min(tick + 1, asks_.begin()->first - 1);
+    }
+    else
+    {
+        tick = asks_.empty() ? mid_ + 1 : asks_.begin()->first;
+        if (!bids_.empty()) tick = std::max(tick - 1, bids_.begin()->first + 1);
+    }
+    tick = std::max(tick, 1LL);
+    add(out, burstSide_, tick, quantity());
+    burstOrder_ = live_.back().id_;
+}
+
+void Workload::add(std::string& out, char side, long long tick, Quantity qty)
+{
+    const auto id = nextOrderId();
+    index_.emplace(id, live_.size());
+    live_.emplace_back(LiveOrder{id, side, qty, tick});
+    if ('B' == side) bids_[tick].push_back(id);
+    else asks_[tick].push_back(id);
+    line(out, 'A', id, side, qty, tick);
+    ++counts_.adds_;
+}
+
+void Workload::aggress(std::string& out, char side, long long limitTick, Quantity qty)
+{
+    limitTick = std::max(limitTick, 1LL);
+    if ('B' == side) match(out, asks_, limitTick, qty, true);
+    else match(out, bids_, limitTick, qty, false);
+    // Residual rests (every opposite level up to the limit is consumed => not crossed)
+    if (qty > 0U) add(out, side, limitTick, qty);
+}
+
+template <typename Levels>
+void Workload::match(std::string& out, Levels& levels, long long limitTick, Quantity& qty, bool buy)
+{
+    while (qty > 0U && !levels.empty())
+    {
+        const auto itLevel = levels.begin();
+        const auto tick = itLevel->first;
+        if (buy ? tick > limitTick : tick < limitTick) break;
+        const auto index = index_[itLevel->second.front()];
+        auto& resting = live_[index];
+        const auto fill = std::min(qty, resting.qty_);
+        trade(out, fill, tick);
+        qty -= fill;
+        if (fill == resting.qty_) cancel(out, index);
+        else
+        {
+            resting.qty_ -= fill;
+            line(out, 'M', resting.id_, resting.side_, resting.qty_, tick);
+            ++counts_.modifies_;
+        }
+    }
+}
+
+void Workload::cancel(std::string& out, size_t index)
+{
+    const auto& order = live_[index];
+    line(out, 'X', order.id_, order.side_, order.qty_, order.tick_);
+    ++counts_.cancels_;
+    remove(index);
+}
+
+void Workload::modify(std::string& out, size_t index)
+{
+    auto& order = live_[index];
+    order.qty_ = quantity();
+    line(out, 'M', order.id_, order.side_, order.qty_, order.tick_);
+    ++counts_.modifies_;
+}
+
+void Workload::remove(size_t index)
+{
+    const auto order = live_[index];
+    auto erase = [&order](auto& levels)
+    {
+        auto itLevel = levels.find(order.tick_);
+        auto& fifo = itLevel->second;
+        fifo.erase(std::find(fifo.begin(), fifo.end(), order.id_));
+        if (fifo.empty()) levels.erase(itLevel);
+    };
+    if ('B' == order.side_) erase(bids_);
+    else erase(asks_);
+    index_.erase(order.id_);
+    if (index + 1 != live_.size())
+    {
+        live_[index] = live_.back();
+        index_[live_[index].id_] = index;
+    }
+    live_.pop_back();
+}
+
+long long Workload::passiveTick(char side)
+{
+    // Concentrated near the mid (density decreasing with the distance)
+    const auto u = rng_.uniform();
+    const auto offset = static_cast<long long>(u * u * static_cast<double>(profile_.depth_));
+    return ('B' == side) ? mid_ - 1 - offset : mid_ + 1 + offset;
+}
+
+Quantity Workload::quantity()
+{
+    return 1U + static_cast<Quantity>(rng_.below(std::min<Quantity>(profile_.maxQty_, maxOrderQty)));
+}
+
+OrderId Workload::nextOrderId()
+{
+    // Wrap within the parser bounds (only live ids have to be unique)
+    do
+    {
+        lastOrderId_ = (lastOrderId_ >= static_cast<OrderId>(maxOrderId)) ? 1U : lastOrderId_ + 1U;
+    }
+    while (unlikely(index_.find(lastOrderId_) != index_.end()));
+    return lastOrderId_;
+}
+
+void Workload::line(std::string& out, char action, OrderId id, char side, Quantity qty, long long tick)
+{
+    char buffer[32];
+    out += action;
+    out += ',';
+    out.append(buffer, Decoder::convert_unsigned_integer<OrderId>(id, buffer));
+    out += ',';
+    out += side;
+    out += ',';
+    out.append(buffer, Decoder::convert_unsigned_integer<Quantity>(qty, buffer));
+    out += ',';
+    appendPrice(out, tick);
+    out += '\n';
+    ++nbMessages_;
+}
+
+void Workload::trade(std::string& out, AggregatedQty qty, long long tick)
+{
+    char buffer[32];
+    out += "T,";
+    out.append(buffer, Decoder::convert_unsigned_integer<AggregatedQty>(qty, buffer));
+    out += ',';
+    appendPrice(out, tick);
+    out += '\n';
+    ++nbMessages_;
+    ++counts_.trades_;
+}
+
+void Workload::appendPrice(std::string& out, long long tick)
+{
+    char buffer[32];
+    const auto ticks = static_cast<unsigned long long>(tick);
+    const auto pow10 = static_cast<unsigned long long>(pow10_);
+    out.append(buffer, Decoder::convert_unsigned_integer<unsigned long long>(ticks / pow10, buffer));
+    if (0U == profile_.decimals_) return;
+    out += '.';
+    const auto len = Decoder::convert_unsigned_integer<unsigned long long>(ticks % pow10, buffer);
+    out.append(profile_.decimals_ - len, '0');
+    out.append(buffer, len);
+}
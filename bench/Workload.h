@@ -0,0 +1,125 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace common;
+
+// Synthetic message stream (same format as tools/genOrders.py) without any external dependency:
+//   - passive orders placed within depth ticks of a mid price drifting as a random walk,
+//   - cancels and modifies of random live orders (always consistent with the book),
+//   - aggressive orders matched in FIFO against the best levels: T message then X/M of
+//     the resting orders and A of the residual (the book is never crossed),
+//   - bursts of add/cancel at the best level (quote flickering).
+// Deterministic by seed (own RNG and formatting => same stream on any platform).
+
+class Workload
+{
+public:
+    struct Profile
+    {
+        unsigned long long seed_ = 1ULL;
+        unsigned long long nbMessages_ = 1'000'000ULL;
+        unsigned int depth_ = 100U;          // price levels per side around the mid
+        unsigned int ordersPerLevel_ = 4U;   // at prefill (and target book size)
+        double cancelRatio_ = 0.42;          // of messages
+        double modifyRatio_ = 0.06;
+        double tradeRatio_ = 0.02;           // aggressive orders
+        double drift_ = 0.01;                // probability of a one tick mid move per message
+        double burstiness_ = 0.0;            // probability of starting a flickering burst per message
+        unsigned int burstLength_ = 32U;     // mean messages per burst
+        unsigned int decimals_ = 2U;         // tick = 10^-decimals
+        unsigned long long midTicks_ = 100'000ULL;
+        Quantity maxQty_ = 1'000U;
+    };
+    // Presets: calm, default, volatile, bursty (false if unknown)
+    static bool preset(const std::string& name, Profile& profile);
+    // Consume the workload option at argv[i] (and its value), false if not one
+    static bool parse(int& i, int argc, char** argv, Profile& profile);
+    static const char* usage();
+
+    explicit Workload(const Profile& profile);
+    Workload(const Workload&) = delete;
+    Workload& operator=(const Workload&) = delete;
+
+    // Append at least nbMessages lines (a trade sequence is never split), return the number appended
+    unsigned long long generate(std::string& out, unsigned long long nbMessages);
+    unsigned long long nbMessages() const { return nbMessages_; }
+    bool done() const { return nbMessages_ >= profile_.nbMessages_; }
+
+    // Messages per action (A, M, X, T)
+    struct Counts
+    {
+        unsigned long long adds_ = 0ULL;
+        unsigned long long modifies_ = 0ULL;
+        unsigned long long cancels_ = 0ULL;
+        unsigned long long trades_ = 0ULL;
+    };
+    const Counts& counts() const { return counts_; }
+    size_t nbLiveOrders() const { return live_.size(); }
+
+private:
+    // xoshiro256** seeded by splitmix64
+    class Rng
+    {
+    public:
+        explicit Rng(unsigned long long seed);
+        unsigned long long next();
+        double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+        unsigned long long below(unsigned long long n) { return static_cast<unsigned long long>(uniform() * static_cast<double>(n)); }
+        bool chance(double p) { return uniform() < p; }
+    private:
+        unsigned long long s_[4];
+    };
+
+    struct LiveOrder
+    {
+        OrderId id_;
+        char side_;
+        Quantity qty_;
+        long long tick_;
+    };
+    using BidLevels = std::map<long long, std::deque<OrderId>, std::greater<long long>>;
+    using AskLevels = std::map<long long, std::deque<OrderId>>;
+
+    void step(std::string& out);
+    void burst(std::string& out);
+    void add(std::string& out, char side, long long tick, Quantity qty);
+    void aggress(std::string& out, char side, long long limitTick, Quantity qty);
+    template <typename Levels>
+    void match(std::string& out, Levels& levels, long long limitTick, Quantity& qty, bool buy);
+    void cancel(std::string& out, size_t index);
+    void modify(std::string& out, size_t index);
+    void remove(size_t index);
+    long long passiveTick(char side);
+    Quantity quantity();
+    OrderId nextOrderId();
+
+    void line(std::string& out, char action, OrderId id, char side, Quantity qty, long long tick);
+    void trade(std::string& out, AggregatedQty qty, long long tick);
+    void appendPrice(std::string& out, long long tick);
+
+    const Profile profile_;
+    Rng rng_;
+    long long pow10_ = 1;
+    long long mid_ = 0;
+    OrderId lastOrderId_ = 0;
+    unsigned long long nbMessages_ = 0ULL;
+    unsigned long long nbPrefilled_ = 0ULL;
+    unsigned long long burstRemaining_ = 0ULL;
+    char burstSide_ = 'B';
+    OrderId burstOrder_ = 0;
+    unsigned long long targetOrders_ = 0ULL; // both sides
+
+    std::vector<LiveOrder> live_;
+    std::unordered_map<OrderId, size_t> index_; // order id => position in live_
+    BidLevels bids_;
+    AskLevels asks_;
+    Counts counts_;
+};
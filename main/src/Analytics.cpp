@@ -0,0 +1,20 @@
+#include "Analytics.h"
+
+constexpr size_t Analytics::MAX_DEPTH;
+
+Analytics::Analytics(size_t depth, size_t nbTrades)
+    : depth_(std::min(std::max<size_t>(depth, 1), MAX_DEPTH))
+    , trades_(std::max<size_t>(nbTrades, 1), Trade{0, 0.0})
+{
+}
+
+void Analytics::resum()
+{
+    tradedQty_ = 0;
+    notional_ = 0.0;
+    for (auto& trade : trades_)
+    {
+        tradedQty_ += getQty(trade);
+        notional_ += static_cast<double>(getQty(trade)) * getPrice(trade);
+    }
+}
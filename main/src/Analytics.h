@@ -0,0 +1,125 @@
+#pragma once
+
+#include "utils/Common.h"
+#include "utils/VersionedLevels.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+using namespace common;
+
+// Order-flow signals maintained by the feed thread as each update is published, in O(depth) at
+// most (top levels quantities mirrored, shifted on add/cancel) and O(1) for VWAP (ring of trades):
+//   - spread: best ask - best bid,
+//   - microprice: best prices weighted by the opposite best quantity,
+//   - imbalance: (bids - asks) / (bids + asks) over the quantities of the <depth> best levels per side,
+//   - VWAP over the last <nbTrades> trades.
+// Undefined values (empty side, no trade yet) are NaN.
+
+class Analytics
+{
+public:
+    static constexpr size_t MAX_DEPTH = 64;
+    using Levels = VersionedLevels<Limit>;
+
+    struct Signals
+    {
+        Price spread_ = std::numeric_limits<Price>::quiet_NaN();
+        Price microprice_ = std::numeric_limits<Price>::quiet_NaN();
+        double imbalance_ = std::numeric_limits<double>::quiet_NaN();
+        Price vwap_ = std::numeric_limits<Price>::quiet_NaN();
+    };
+
+    // <depth> clamped to [1, MAX_DEPTH], <nbTrades> to at least 1
+    explicit Analytics(size_t depth = 5, size_t nbTrades = 100);
+    Analytics(const Analytics&) = delete;
+    Analytics& operator=(const Analytics&) = delete;
+
+    // Level <pos> of a side once updated ('A', 'M' or 'X'): <levels> is that side of the book after it
+    FORCE_INLINE void onLevel(char action, bool bid, unsigned int pos, AggregatedQty qty, const Levels& levels)
+    {
+        if (pos >= depth_) return;
+        auto& side = bid ? bids_ : asks_;
+        switch(action)
+        {
+        case 'M':
+            side.sum_ += qty - side.qty_[pos];
+            side.qty_[pos] = qty;
+            break;
+        case 'A':
+            if (side.size_ == depth_) side.sum_ -= side.qty_[depth_-1];
+            else ++side.size_;
+            std::move_backward(side.qty_.begin() + pos, side.qty_.begin() + side.size_ - 1, side.qty_.begin() + side.size_);
+            side.qty_[pos] = qty;
+            side.sum_ += qty;
+            break;
+        case 'X':
+            side.sum_ -= side.qty_[pos];
+            std::move(side.qty_.begin() + pos + 1, side.qty_.begin() + side.size_, side.qty_.begin() + pos);
+            --side.size_;
+            if (levels.size() >= depth_) // level entering the top from below
+            {
+                side.qty_[depth_-1] = getQty(levels[depth_-1]);
+                side.sum_ += side.qty_[depth_-1];
+                ++side.size_;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    FORCE_INLINE void onTrade(const Trade& trade)
+    {
+        auto& oldest = trades_[nextTrade_];
+        tradedQty_ += getQty(trade) - getQty(oldest);
+        notional_ += static_cast<double>(getQty(trade)) * getPrice(trade) - static_cast<double>(getQty(oldest)) * getPrice(oldest);
+        oldest = trade;
+        if (++nextTrade_ == trades_.size())
+        {
+            nextTrade_ = 0;
+            resum(); // no drift of the running notional
+        }
+    }
+
+    FORCE_INLINE Signals signals(const Limit& bestBid, const Limit& bestAsk) const
+    {
+        Signals signals;
+        if (likely(getQty(bestBid) && getQty(bestAsk)))
+        {
+            signals.spread_ = getPrice(bestAsk) - getPrice(bestBid);
+            const auto bidQty = static_cast<double>(getQty(bestBid));
+            const auto askQty = static_cast<double>(getQty(bestAsk));
+            signals.microprice_ = (getPrice(bestBid) * askQty + getPrice(bestAsk) * bidQty) / (bidQty + askQty);
+        }
+        if (likely(bids_.sum_ + asks_.sum_))
+        {
+            signals.imbalance_ = (static_cast<double>(bids_.sum_) - static_cast<double>(asks_.sum_)) /
+                                 static_cast<double>(bids_.sum_ + asks_.sum_);
+        }
+        if (likely(tradedQty_)) signals.vwap_ = notional_ / static_cast<double>(tradedQty_);
+        return signals;
+    }
+
+    size_t depth() const { return depth_; }
+    AggregatedQty bidDepthQty() const { return bids_.sum_; }
+    AggregatedQty askDepthQty() const { return asks_.sum_; }
+
+private:
+    void resum();
+
+    struct Side
+    {
+        std::array<AggregatedQty, MAX_DEPTH> qty_{}; // best levels first
+        size_t size_ = 0;
+        AggregatedQty sum_ = 0;
+    };
+    const size_t depth_;
+    Side bids_, asks_;
+    std::vector<Trade> trades_; // ring of the last trades (zero quantity until filled)
+    size_t nextTrade_ = 0;
+    AggregatedQty tradedQty_ = 0;
+    double notional_ = 0.0;
+};
@@ -0,0 +1,108 @@
+#include "Bars.h"
+
+#include <cstring>
+
+constexpr size_t Bars::BARS_PER_BLOCK;
+
+namespace
+{
+    constexpr char MAGIC[8] = {'F', 'H', 'B', 'A', 'R', 'S', '1', '\n'};
+
+    template <typename T>
+    void writeValue(std::ofstream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    // One column of the block: <member> of each bar
+    template <typename T>
+    void writeColumn(std::ofstream& file, const std::vector<Bars::Bar>& bars, T Bars::Bar::* member)
+    {
+        std::vector<T> column;
+        column.reserve(bars.size());
+        for (auto& bar : bars) column.push_back(bar.*member);
+        file.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof(T)));
+    }
+    template <typename T>
+    bool readColumn(std::ifstream& file, std::vector<Bars::Bar>::iterator bar, size_t nb, T Bars::Bar::* member)
+    {
+        std::vector<T> column(nb);
+        if (!file.read(reinterpret_cast<char*>(column.data()), static_cast<std::streamsize>(nb * sizeof(T)))) return false;
+        for (auto& value : column) (*bar++).*member = value;
+        return true;
+    }
+}
+
+bool Bars::open(const std::string& path)
+{
+    close();
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) return false;
+    block_.reserve(BARS_PER_BLOCK);
+    file_.write(MAGIC, sizeof(MAGIC));
+    writeValue(file_, static_cast<unsigned long long>(mode_));
+    writeValue(file_, size_);
+    return static_cast<bool>(file_);
+}
+
+void Bars::close()
+{
+    if (!file_.is_open()) return;
+    if (current_.nbTrades_) closeBar();
+    writeBlock();
+    file_.close();
+}
+
+void Bars::closeBar()
+{
+    block_.push_back(current_);
+    current_ = Bar();
+    ++nbBars_;
+    if (block_.size() == BARS_PER_BLOCK) writeBlock();
+}
+
+void Bars::writeBlock()
+{
+    if (block_.empty()) return;
+    if (file_.is_open())
+    {
+        writeValue(file_, static_cast<unsigned long long>(block_.size()));
+        writeColumn(file_, block_, &Bar::time_);
+        writeColumn(file_, block_, &Bar::open_);
+        writeColumn(file_, block_, &Bar::high_);
+        writeColumn(file_, block_, &Bar::low_);
+        writeColumn(file_, block_, &Bar::close_);
+        writeColumn(file_, block_, &Bar::volume_);
+        writeColumn(file_, block_, &Bar::nbTrades_);
+        writeColumn(file_, block_, &Bar::notional_);
+    }
+    block_.clear();
+}
+
+bool Bars::read(const std::string& path, std::vector<Bar>& bars, Mode* mode, unsigned long long* size)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    unsigned long long fileMode = 0, fileSize = 0;
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) ||
+        !readValue(file, fileMode) || !readValue(file, fileSize)) return false;
+    if (mode != nullptr) *mode = static_cast<Mode>(fileMode);
+    if (size != nullptr) *size = fileSize;
+    bars.clear();
+    for (unsigned long long nb = 0; readValue(file, nb);)
+    {
+        const auto first = bars.size();
+        bars.resize(first + nb);
+        const auto bar = bars.begin() + static_cast<long>(first);
+        if (!readColumn(file, bar, nb, &Bar::time_) || !readColumn(file, bar, nb, &Bar::open_) ||
+            !readColumn(file, bar, nb, &Bar::high_) || !readColumn(file, bar, nb, &Bar::low_) ||
+            !readColumn(file, bar, nb, &Bar::close_) || !readColumn(file, bar, nb, &Bar::volume_) ||
+            !readColumn(file, bar, nb, &Bar::nbTrades_) || !readColumn(file, bar, nb, &Bar::notional_)) return false;
+    }
+    return true;
+}
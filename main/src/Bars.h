@@ -0,0 +1,106 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace common;
+
+// OHLCV bars built from the trade stream (reporter thread), one bar per time bucket or per
+// bucket of messages, written to a columnar file by blocks of BARS_PER_BLOCK bars:
+//   header : "FHBARS1\n", mode (u64, 0 => time, 1 => messages), bucket size (u64, ns or messages)
+//   block  : nb bars (u64) then each column of the block contiguous:
+//            time (u64 ns, bucket start or first trade, 0 => none), open, high, low, close (f64),
+//            volume (u64), trades (u64), notional (f64)
+// Native (little endian) byte order. Buckets without trade have no bar. Time buckets only hold
+// trades with an exchange timestamp (extended format), the others are counted, not timed locally.
+
+class Bars
+{
+public:
+    enum class Mode : char
+    {
+        TIME,     // bar per bucket of <size> ns (exchange time of the trades)
+        MESSAGES  // bar per bucket of <size> messages (book updates and trades)
+    };
+    struct Bar
+    {
+        unsigned long long time_ = 0;
+        Price open_ = 0.0, high_ = 0.0, low_ = 0.0, close_ = 0.0;
+        AggregatedQty volume_ = 0;
+        unsigned long long nbTrades_ = 0;
+        double notional_ = 0.0;
+    };
+    static constexpr size_t BARS_PER_BLOCK = 4096;
+
+    Bars(Mode mode, unsigned long long size) : mode_(mode), size_(size ? size : 1ULL) {}
+    ~Bars() { close(); }
+    Bars(const Bars&) = delete;
+    Bars& operator=(const Bars&) = delete;
+
+    // Truncated, false if it can't be written
+    bool open(const std::string& path);
+    // Last bar and pending block written, file closed
+    void close();
+
+    // Trade at <timeNs> (e.g. ns since epoch, 0 => none), before the onMessage() of its message
+    FORCE_INLINE void onTrade(const Trade& trade, unsigned long long timeNs)
+    {
+        if (Mode::TIME == mode_)
+        {
+            if (unlikely(0ULL == timeNs))
+            {
+                ++nbUntimedTrades_;
+                return;
+            }
+            const auto start = timeNs - timeNs % size_;
+            if (current_.nbTrades_ && start != current_.time_) closeBar();
+            if (0ULL == current_.nbTrades_) current_.time_ = start;
+        }
+        else if (0ULL == current_.nbTrades_) current_.time_ = timeNs;
+        const auto price = getPrice(trade);
+        if (0ULL == current_.nbTrades_)
+        {
+            current_.open_ = current_.high_ = current_.low_ = price;
+        }
+        else
+        {
+            if (price > current_.high_) current_.high_ = price;
+            if (price < current_.low_) current_.low_ = price;
+        }
+        current_.close_ = price;
+        current_.volume_ += getQty(trade);
+        current_.notional_ += static_cast<double>(getQty(trade)) * price;
+        ++current_.nbTrades_;
+    }
+    FORCE_INLINE void onMessage()
+    {
+        if (Mode::MESSAGES == mode_ && ++nbMessages_ == size_)
+        {
+            nbMessages_ = 0;
+            if (current_.nbTrades_) closeBar();
+        }
+    }
+
+    unsigned long long nbBars() const { return nbBars_; }
+    // Trades left out of time bars (no exchange timestamp)
+    unsigned long long nbUntimedTrades() const { return nbUntimedTrades_; }
+
+    // Whole file (e.g. research tools, tests), false if it is not a bars file
+    static bool read(const std::string& path, std::vector<Bar>& bars, Mode* mode = nullptr, unsigned long long* size = nullptr);
+
+private:
+    void closeBar();
+    void writeBlock();
+
+    const Mode mode_;
+    const unsigned long long size_;
+    unsigned long long nbMessages_ = 0;
+    unsigned long long nbBars_ = 0;
+    unsigned long long nbUntimedTrades_ = 0;
+    Bar current_;
+    std::vector<Bar> block_; // closed bars not written yet
+    std::ofstream file_;
+};
@@ -0,0 +1,69 @@
+#include "DepthIndex.h"
+
+constexpr size_t DepthIndex::DEFAULT_MAX_TICKS;
+constexpr size_t DepthIndex::MIN_TICKS;
+
+void DepthIndex::rebuild(const Levels& levels)
+{
+    auto nbTicks = std::max<size_t>(levelQty_.size(), MIN_TICKS);
+    if (!levels.empty())
+    {
+        // Levels sorted from the best: span of the on grid ones, window capped
+        long long best = 0, worst = 0, i;
+        auto found = false;
+        for (auto& level : levels)
+        {
+            if (!index(getPrice(level), i)) continue;
+            if (!found) best = i;
+            worst = i;
+            found = true;
+        }
+        if (found)
+        {
+            const auto span = static_cast<size_t>(std::llabs(worst - best)) + 1;
+            while (nbTicks / 4 * 3 < span && nbTicks < maxTicks_) nbTicks *= 2;
+            nbTicks = std::min(nbTicks, maxTicks_);
+            originTicks_ += direction_ * best - direction_ * static_cast<long long>(nbTicks / 4);
+        }
+    }
+    levelQty_.assign(nbTicks, 0ULL);
+    qty_.resize(nbTicks);
+    weighted_.resize(nbTicks);
+    beyond_ = false;
+    for (auto& level : levels)
+    {
+        long long i;
+        if (!index(getPrice(level), i) || i < 0) continue;
+        if (i >= static_cast<long long>(nbTicks))
+        {
+            beyond_ = true; // worse ones are beyond the window too
+            break;
+        }
+        const auto u = static_cast<size_t>(i);
+        levelQty_[u] = getQty(level);
+        qty_.add(u, getQty(level));
+        weighted_.add(u, getQty(level) * u);
+    }
+}
+
+AggregatedQty DepthIndex::within(unsigned long long ticks) const
+{
+    if (0ULL == qty_.total()) return 0ULL;
+    const auto best = qty_.lowerBound(1ULL);
+    return qty_.prefix(ticks < levelQty_.size() ? best + ticks : levelQty_.size());
+}
+
+DepthIndex::Sweep DepthIndex::sweep(AggregatedQty qty) const
+{
+    Sweep sweep;
+    sweep.qty_ = std::min(qty, qty_.total());
+    if (0ULL == sweep.qty_) return sweep;
+    // Last level reached, levels before it fully swept
+    const auto last = qty_.lowerBound(sweep.qty_);
+    const auto before = last ? qty_.prefix(last-1) : 0ULL;
+    const auto weighted = (last ? weighted_.prefix(last-1) : 0ULL) + (sweep.qty_ - before) * last;
+    sweep.worstPrice_ = price(last);
+    sweep.averagePrice_ = (static_cast<double>(originTicks_) +
+        static_cast<double>(direction_) * static_cast<double>(weighted) / static_cast<double>(sweep.qty_)) * tick_;
+    return sweep;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "utils/Common.h"
+#include "utils/FenwickTree.h"
+#include "utils/VersionedLevels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace common;
+
+// Prefix sums over the price ticks of one book side, from its better prices to its worse ones, so
+// depth queries don't walk the levels:
+//   - quantity within N ticks of the best and price to fill a quantity (sweep) in O(log n),
+//   - each level change is O(log n), the index is rebuilt from the levels (O(n log n)) only when
+//     the best level leaves the first half of its window (best then at a quarter of it) or a level
+//     is beyond a window not yet at its maximum (window then doubled) or holding nothing.
+// The window is at most <maxTicks> ticks from a quarter before the best: levels beyond it are not
+// indexed, within() and sweep() only cover the window (e.g. a far stale order never inflates it).
+// Prices off the tick grid are not indexed either (counted in nbOffGrid()).
+// Memory is 24 bytes per tick of the window (at most 24 * <maxTicks> bytes).
+
+class DepthIndex
+{
+public:
+    using Levels = VersionedLevels<Limit>;
+
+    // Levels an order would sweep: quantity available (lower than asked when the side is too thin),
+    // price of the last level reached and average fill price (NaN when nothing is available)
+    struct Sweep
+    {
+        AggregatedQty qty_ = 0;
+        Price worstPrice_ = std::numeric_limits<Price>::quiet_NaN();
+        Price averagePrice_ = std::numeric_limits<Price>::quiet_NaN();
+    };
+
+    static constexpr size_t DEFAULT_MAX_TICKS = 1 << 16; // 1.5 MB
+    static constexpr size_t MIN_TICKS = 64;
+
+    // <bids>: better prices are the higher ones
+    DepthIndex(bool bids, Price tickSize, size_t maxTicks = DEFAULT_MAX_TICKS)
+        : direction_(bids ? -1LL : 1LL), tick_(tickSize), maxTicks_(std::max(maxTicks, MIN_TICKS)) {}
+    DepthIndex(const DepthIndex&) = delete;
+    DepthIndex& operator=(const DepthIndex&) = delete;
+
+    // Level at <price> now holds <qty> (0 => removed), <levels> being the side once updated
+    FORCE_INLINE void set(Price price, AggregatedQty qty, const Levels& levels)
+    {
+        long long i;
+        if (unlikely(!index(price, i)))
+        {
+            ++nbOffGrid_;
+            return;
+        }
+        // Better than the window, or beyond it while it can grow or holds nothing: window rebuilt
+        const auto size = static_cast<long long>(levelQty_.size());
+        if (unlikely(i < 0 || (i >= size && qty && (levelQty_.size() < maxTicks_ || 0ULL == qty_.total()))))
+        {
+            rebuild(levels);
+            return;
+        }
+        if (unlikely(i >= size))
+        {
+            if (qty) beyond_ = true;
+            return;
+        }
+        const auto u = static_cast<size_t>(i);
+        const auto delta = qty - levelQty_[u]; // unsigned wrap when decreasing, sums stay exact
+        levelQty_[u] = qty;
+        qty_.add(u, delta);
+        weighted_.add(u, delta * u);
+        // Level removed, the best indexed one now deep into the window (or none left but some beyond): recentred
+        if (unlikely(0ULL == qty) && (0ULL == qty_.total() ? beyond_ : qty_.lowerBound(1ULL) >= levelQty_.size() / 2))
+            rebuild(levels);
+    }
+    // Whole index from <levels> (e.g. first use)
+    void rebuild(const Levels& levels);
+
+    // Quantity of the levels at most <ticks> away from the best one (0 => best level only), in the window
+    AggregatedQty within(unsigned long long ticks) const;
+    // Levels of the window only
+    Sweep sweep(AggregatedQty qty) const;
+    AggregatedQty total() const { return qty_.total(); }
+    Price tickSize() const { return tick_; }
+    size_t nbTicks() const { return levelQty_.size(); }
+    size_t maxTicks() const { return maxTicks_; }
+    // Level changes at prices off the tick grid (not indexed)
+    unsigned long long nbOffGrid() const { return nbOffGrid_; }
+
+private:
+    // False when <price> is off the tick grid
+    FORCE_INLINE bool index(Price price, long long& i) const
+    {
+        const auto ticks = std::llround(price / tick_);
+        if (unlikely(std::fabs(price - static_cast<Price>(ticks) * tick_) > 1e-6 * tick_)) return false;
+        i = direction_ * (ticks - originTicks_);
+        return true;
+    }
+    Price price(size_t i) const { return static_cast<Price>(originTicks_ + direction_ * static_cast<long long>(i)) * tick_; }
+
+    const long long direction_;
+    const Price tick_;
+    const size_t maxTicks_;
+    long long originTicks_ = 0; // price of index 0 in ticks
+    unsigned long long nbOffGrid_ = 0ULL;
+    bool beyond_ = false;       // on grid levels may be beyond the window (not indexed)
+    std::vector<AggregatedQty> levelQty_;
+    FenwickTree<AggregatedQty> qty_;
+    FenwickTree<AggregatedQty> weighted_; // quantity * index => fill notional without walking
+};
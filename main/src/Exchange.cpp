@@ -0,0 +1,386 @@
+#include "Exchange.h"
+
+#include <cerrno>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace exchange
+{
+    static_assert(sizeof(ExecutionMsg) == Frame::SIZE, "Exchange frames are 32 bytes");
+    static_assert(sizeof(BookMsg) == Frame::SIZE, "Exchange frames are 32 bytes");
+    static_assert(sizeof(RejectMsg) == Frame::SIZE, "Exchange frames are 32 bytes");
+
+    namespace
+    {
+        constexpr unsigned long long LISTENER = 0ULL; // epoll data of the listening socket
+
+        // Unix domain socket when <address> holds a '/', TCP <host>:<port> otherwise (-1 on error)
+        int openSocket(const std::string& address, bool listening)
+        {
+            const int flags = SOCK_CLOEXEC | (listening ? SOCK_NONBLOCK : 0); // accepts until EAGAIN
+            int fd = -1;
+            if (address.find('/') != std::string::npos)
+            {
+                sockaddr_un addr{};
+                addr.sun_family = AF_UNIX;
+                if (address.size() >= sizeof(addr.sun_path)) return -1;
+                memcpy(addr.sun_path, address.c_str(), address.size() + 1);
+                fd = socket(AF_UNIX, SOCK_STREAM | flags, 0);
+                if (fd < 0) return -1;
+                if (listening) unlink(address.c_str());
+                const auto* sa = reinterpret_cast<const sockaddr*>(&addr);
+                if ((listening ? bind(fd, sa, sizeof(addr)) : connect(fd, sa, sizeof(addr))) < 0)
+                {
+                    ::close(fd);
+                    return -1;
+                }
+                return fd;
+            }
+            const auto colon = address.rfind(':');
+            if (colon == std::string::npos) return -1;
+            const std::string host = address.substr(0, colon);
+            const std::string port = address.substr(colon + 1);
+            addrinfo hints{};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = listening ? AI_PASSIVE : 0;
+            addrinfo* infos = nullptr;
+            if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &infos) != 0) return -1;
+            fd = socket(infos->ai_family, infos->ai_socktype | flags, infos->ai_protocol);
+            if (fd >= 0)
+            {
+                const int one = 1;
+                if (listening) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+                else setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                if ((listening ? bind(fd, infos->ai_addr, infos->ai_addrlen) : connect(fd, infos->ai_addr, infos->ai_addrlen)) < 0)
+                {
+                    ::close(fd);
+                    fd = -1;
+                }
+            }
+            freeaddrinfo(infos);
+            return fd;
+        }
+    }
+
+    Server::Server(Arena* arena)
+        : feed_(updates_, arena)
+    {
+        updates_.reserve(256);
+        feed_.setMatching(true);
+        feed_.setFillHandler([this](const FeedHandler::Fill& fill) { onFill(fill); });
+    }
+
+    Server::~Server()
+    {
+        for (auto& session : sessions_) ::close(session.second->fd_);
+        if (listenFd_ >= 0) ::close(listenFd_);
+        if (epollFd_ >= 0) ::close(epollFd_);
+        if (!unixPath_.empty()) unlink(unixPath_.c_str());
+    }
+
+    bool Server::listen(const std::string& address)
+    {
+        listenFd_ = openSocket(address, true);
+        if (listenFd_ < 0 || ::listen(listenFd_, 128) < 0)
+        {
+            std::cerr << "Exchange can't listen on [" << address << "]: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (address.find('/') != std::string::npos) unixPath_ = address;
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = LISTENER;
+        if (epollFd_ < 0 || epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &event) < 0)
+        {
+            std::cerr << "Exchange epoll failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void Server::run(const int verbose)
+    {
+        running_.store(true, std::memory_order_relaxed);
+        epoll_event events[64];
+        std::vector<Session*> closed;
+        while (likely(running_.load(std::memory_order_relaxed)))
+        {
+            const auto nb = epoll_wait(epollFd_, events, 64, 100); // bounded: stop() is seen
+            for (auto i = 0; i < nb; ++i)
+            {
+                if (unlikely(LISTENER == events[i].data.u64))
+                {
+                    accept(verbose);
+                    continue;
+                }
+                auto itSession = sessions_.find(events[i].data.u64);
+                if (unlikely(itSession == sessions_.end())) continue;
+                auto& session = *itSession->second;
+                if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !session.readClosed_ && !read(session))
+                {
+                    close(session, verbose);
+                }
+            }
+            // Responses written once per loop: one write per client for all its pending frames
+            for (auto& session : sessions_)
+            {
+                if (session.second->out_.size() > session.second->outSent_ || session.second->readClosed_)
+                {
+                    if (!flush(*session.second)) closed.push_back(session.second.get());
+                }
+            }
+            for (auto* session : closed) close(*session, verbose);
+            closed.clear();
+        }
+    }
+
+    void Server::accept(const int verbose)
+    {
+        for (;;)
+        {
+            const int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            const int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // fails on Unix sockets, harmless
+            auto session = std::make_unique<Session>();
+            session->fd_ = fd;
+            session->id_ = nextSessionId_++;
+            session->in_.resize(READ_BYTES + sizeof(OrderMsg));
+            session->events_ = EPOLLIN;
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = session->id_;
+            if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0)
+            {
+                ::close(fd);
+                continue;
+            }
+            ++counters_.nbClients_;
+            if (verbose > 0) std::cerr << "Client [" << session->id_ << "] connected" << std::endl;
+            sessions_.emplace(session->id_, std::move(session));
+        }
+    }
+
+    // One read per event (fairness between clients), false once the connection is broken
+    bool Server::read(Session& session)
+    {
+        const auto n = ::read(session.fd_, session.in_.data() + session.inLen_, session.in_.size() - session.inLen_);
+        if (n < 0) return (EAGAIN == errno || EINTR == errno);
+        if (0 == n)
+        {
+            // Half closed by the client: pending responses are still written before closing
+            session.readClosed_ = true;
+            return true;
+        }
+        session.inLen_ += static_cast<size_t>(n);
+        const auto nbMsgs = session.inLen_ / sizeof(OrderMsg);
+        OrderMsg msg;
+        for (auto i = 0UL; i < nbMsgs; ++i)
+        {
+            memcpy(&msg, session.in_.data() + i * sizeof(OrderMsg), sizeof(OrderMsg));
+            apply(session, msg);
+        }
+        const auto consumed = nbMsgs * sizeof(OrderMsg);
+        session.inLen_ -= consumed;
+        if (session.inLen_ > 0) memmove(session.in_.data(), session.in_.data() + consumed, session.inLen_);
+        publishBookUpdates();
+        return true;
+    }
+
+    void Server::apply(Session& session, const OrderMsg& msg)
+    {
+        ++counters_.nbOrders_;
+        // Only the owner of a resting order can cancel or modify it
+        auto itOwner = owners_.find(msg.orderId_);
+        const bool owned = (itOwner != owners_.end() && itOwner->second.sessionId_ == session.id_);
+        const bool valid = msg.orderId_ != 0 && msg.price_ > 0.0 &&
+            ((static_cast<char>(Parser::Action::ADD) == msg.action_ && msg.qty_ != 0) ||
+             (static_cast<char>(Parser::Action::CANCEL) == msg.action_ && owned) ||
+             (static_cast<char>(Parser::Action::MODIFY) == msg.action_ && owned));
+        const auto version = feed_.bookVersion();
+        if (likely(valid))
+        {
+            aggressor_ = &session;
+            aggressorFilled_ = 0;
+            feed_.apply(msg.action_, msg.side_, msg.orderId_, Order{msg.qty_, msg.price_}, errors_);
+            aggressor_ = nullptr;
+        }
+        else if (static_cast<char>(Parser::Action::CANCEL) == msg.action_ && !owned) ++errors_.cancelsWithUnknownOrderId;
+        else if (static_cast<char>(Parser::Action::MODIFY) == msg.action_ && !owned) ++errors_.modifiesWithUnknownOrderId;
+        else ++errors_.corruptedMessages;
+        if (unlikely(version == feed_.bookVersion())) // nothing published => rejected
+        {
+            ++counters_.nbRejects_;
+            RejectMsg reject;
+            reject.action_ = msg.action_;
+            reject.side_ = msg.side_;
+            reject.orderId_ = msg.orderId_;
+            send(session, reject);
+            return;
+        }
+        switch(msg.action_)
+        {
+        case static_cast<char>(Parser::Action::ADD):
+            if (msg.qty_ > aggressorFilled_) owners_[msg.orderId_] = Owner{session.id_, msg.qty_ - aggressorFilled_};
+            break;
+        case static_cast<char>(Parser::Action::CANCEL):
+            owners_.erase(itOwner);
+            break;
+        default:
+            itOwner->second.qty_ = msg.qty_;
+            break;
+        }
+    }
+
+    void Server::onFill(const FeedHandler::Fill& fill)
+    {
+        ++counters_.nbExecutions_;
+        aggressorFilled_ += fill.qty_;
+        ExecutionMsg execution;
+        execution.side_ = fill.side_;
+        execution.liquidity_ = 'A';
+        execution.orderId_ = fill.aggressorId_;
+        execution.counterpartyId_ = fill.restingId_;
+        execution.qty_ = fill.qty_;
+        execution.price_ = fill.price_;
+        if (likely(aggressor_ != nullptr)) send(*aggressor_, execution);
+
+        auto itOwner = owners_.find(fill.restingId_);
+        if (unlikely(itOwner == owners_.end())) return;
+        auto itSession = sessions_.find(itOwner->second.sessionId_);
+        if (likely(itSession != sessions_.end())) // orders of a gone client still rest
+        {
+            execution.side_ = (static_cast<char>(Parser::Side::BUY) == fill.side_) ?
+                static_cast<char>(Parser::Side::SELL) : static_cast<char>(Parser::Side::BUY);
+            execution.liquidity_ = 'P';
+            execution.orderId_ = fill.restingId_;
+            execution.counterpartyId_ = fill.aggressorId_;
+            send(*itSession->second, execution);
+        }
+        itOwner->second.qty_ -= std::min(fill.qty_, itOwner->second.qty_);
+        if (0U == itOwner->second.qty_) owners_.erase(itOwner);
+    }
+
+    // Updates encoded once then appended to every client
+    void Server::publishBookUpdates()
+    {
+        if (updates_.empty()) return;
+        bookBytes_.clear();
+        for (const auto& data : updates_)
+        {
+            BookMsg update;
+            update.action_ = data.action_;
+            update.side_ = data.side_;
+            update.pos_ = data.pos_;
+            update.qty_ = getQty(data.limit_);
+            update.price_ = getPrice(data.limit_);
+            update.version_ = data.bookVersion_;
+            const auto* bytes = reinterpret_cast<const char*>(&update);
+            bookBytes_.insert(bookBytes_.end(), bytes, bytes + sizeof(update));
+        }
+        counters_.nbBookUpdates_ += updates_.size();
+        updates_.clear();
+        for (auto& session : sessions_)
+        {
+            auto& out = session.second->out_;
+            out.insert(out.end(), bookBytes_.begin(), bookBytes_.end());
+        }
+    }
+
+    // False once the connection is broken or the client is too slow
+    bool Server::flush(Session& session)
+    {
+        while (session.outSent_ < session.out_.size())
+        {
+            const auto n = ::send(session.fd_, session.out_.data() + session.outSent_, session.out_.size() - session.outSent_, MSG_NOSIGNAL);
+            if (n > 0) session.outSent_ += static_cast<size_t>(n);
+            else if (n < 0 && EINTR == errno) continue;
+            else if (n < 0 && EAGAIN == errno) break;
+            else return false;
+        }
+        const auto pending = session.out_.size() - session.outSent_;
+        if (0UL == pending)
+        {
+            session.out_.clear();
+            session.outSent_ = 0;
+            if (session.readClosed_) return false; // everything sent to a half closed client
+        }
+        const auto events = (session.readClosed_ ? 0U : static_cast<unsigned int>(EPOLLIN)) |
+                            (pending > 0 ? static_cast<unsigned int>(EPOLLOUT) : 0U);
+        if (events != session.events_)
+        {
+            session.events_ = events;
+            epoll_event event{};
+            event.events = events;
+            event.data.u64 = session.id_;
+            epoll_ctl(epollFd_, EPOLL_CTL_MOD, session.fd_, &event);
+        }
+        return pending <= MAX_PENDING_BYTES;
+    }
+
+    void Server::close(Session& session, const int verbose)
+    {
+        if (verbose > 0) std::cerr << "Client [" << session.id_ << "] disconnected" << std::endl;
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, session.fd_, nullptr);
+        ::close(session.fd_);
+        sessions_.erase(session.id_);
+    }
+
+    Client::~Client()
+    {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool Client::connect(const std::string& address)
+    {
+        fd_ = openSocket(address, false);
+        return fd_ >= 0;
+    }
+
+    bool Client::send(const OrderMsg* msgs, size_t nb)
+    {
+        const auto* bytes = reinterpret_cast<const char*>(msgs);
+        auto len = nb * sizeof(OrderMsg);
+        while (len > 0)
+        {
+            const auto n = ::send(fd_, bytes, len, MSG_NOSIGNAL);
+            if (n < 0 && EINTR == errno) continue;
+            if (n <= 0) return false;
+            bytes += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    size_t Client::receive(Frame* frames, size_t max)
+    {
+        auto* bytes = reinterpret_cast<char*>(frames);
+        auto len = partial_;
+        memcpy(bytes, pending_.data_, partial_);
+        while (len < Frame::SIZE)
+        {
+            const auto n = ::recv(fd_, bytes + len, max * Frame::SIZE - len, 0);
+            if (n < 0 && EINTR == errno) continue;
+            if (n <= 0) return 0UL;
+            len += static_cast<size_t>(n);
+        }
+        const auto nb = len / Frame::SIZE;
+        partial_ = len % Frame::SIZE;
+        memcpy(pending_.data_, bytes + nb * Frame::SIZE, partial_);
+        return nb;
+    }
+
+    void Client::shutdown()
+    {
+        ::shutdown(fd_, SHUT_WR);
+    }
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "FeedHandler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Exchange simulator: clients enter orders over a Unix domain or (loopback) TCP socket, a FeedHandler
+// in matching mode matches them, executions go back to both parties and book updates to every client.
+// Single thread: one epoll loop reads every client, applies its orders, then writes responses by batch.
+// Binary protocol in host byte order (same host only), fixed size frames:
+//   client -> exchange: OrderMsg (24 bytes), actions 'A', 'X' and 'M' with the fields of the text feed
+//   exchange -> client: ExecutionMsg, BookMsg or RejectMsg (32 bytes), told apart by their first byte
+// Order ids are chosen by the clients and shared by all of them (duplicates are rejected).
+
+namespace exchange
+{
+    struct OrderMsg
+    {
+        char action_ = 0;           // 'A', 'X', 'M'
+        char side_ = 0;             // 'B', 'S'
+        uint16_t reserved_ = 0;
+        OrderId orderId_ = 0;
+        Quantity qty_ = 0;          // cancel: the resting quantity, modify: the new one
+        uint32_t reserved2_ = 0;
+        Price price_ = 0.0;
+    };
+    static_assert(sizeof(OrderMsg) == 24, "Order entry frames are 24 bytes");
+
+    struct ExecutionMsg
+    {
+        static constexpr char TYPE = 'E';
+        char type_ = TYPE;
+        char side_ = 0;             // of the executed order
+        char liquidity_ = 0;        // 'A' aggressor (incoming order), 'P' passive (resting order)
+        char reserved_ = 0;
+        OrderId orderId_ = 0;
+        OrderId counterpartyId_ = 0;
+        Quantity qty_ = 0;
+        Price price_ = 0.0;         // of the resting order
+        uint64_t reserved2_ = 0;
+    };
+
+    struct BookMsg
+    {
+        static constexpr char TYPE = 'B';
+        char type_ = TYPE;
+        char action_ = 0;           // 'A', 'M', 'X' of level <pos_> on <side_>, 'T' trade
+        char side_ = 0;
+        char reserved_ = 0;
+        uint32_t pos_ = 0;
+        AggregatedQty qty_ = 0;
+        Price price_ = 0.0;
+        uint64_t version_ = 0;      // book version once applied
+    };
+
+    struct RejectMsg
+    {
+        static constexpr char TYPE = 'R';
+        char type_ = TYPE;
+        char action_ = 0;
+        char side_ = 0;
+        char reserved_ = 0;
+        OrderId orderId_ = 0;
+        uint64_t reserved2_[3] = {};
+    };
+
+    // Any exchange -> client message
+    struct Frame
+    {
+        static constexpr size_t SIZE = 32;
+        char type() const { return data_[0]; }
+        template <typename Msg>
+        Msg get() const
+        {
+            static_assert(sizeof(Msg) == SIZE, "Exchange frames are 32 bytes");
+            Msg msg;
+            memcpy(&msg, data_, SIZE);
+            return msg;
+        }
+        alignas(8) char data_[SIZE];
+    };
+
+    class Server
+    {
+    public:
+        static constexpr size_t READ_BYTES = 64 * 1024;
+        static constexpr size_t MAX_PENDING_BYTES = 64 * 1024 * 1024; // slower client disconnected
+
+        explicit Server(Arena* arena = nullptr);
+        ~Server();
+        Server(const Server&) = delete;
+        Server& operator=(const Server&) = delete;
+
+        // <address>: Unix domain socket path (containing a '/') or <host>:<port> on TCP
+        bool listen(const std::string& address);
+        // Event loop in the calling thread until stop()
+        void run(const int verbose = 0);
+        void stop() { running_.store(false, std::memory_order_relaxed); }
+
+        void reserve(size_t nbOrders) { feed_.reserve(nbOrders); owners_.reserve(nbOrders); }
+        const FeedHandler& feed() const { return feed_; }
+        const Errors& errors() const { return errors_; }
+
+        struct Counters
+        {
+            unsigned long long nbClients_ = 0;
+            unsigned long long nbOrders_ = 0;
+            unsigned long long nbRejects_ = 0;
+            unsigned long long nbExecutions_ = 0;  // fills (one execution per party)
+            unsigned long long nbBookUpdates_ = 0;  // published once, sent to every client
+        };
+        const Counters& counters() const { return counters_; }
+
+    private:
+        struct Session
+        {
+            int fd_ = -1;
+            unsigned long long id_ = 0;
+            std::vector<char> in_;
+            size_t inLen_ = 0;
+            std::vector<char> out_;
+            size_t outSent_ = 0;
+            bool readClosed_ = false;               // half closed: closed once its responses are sent
+            unsigned int events_ = 0;               // epoll registration
+        };
+        struct Owner
+        {
+            unsigned long long sessionId_;
+            Quantity qty_;                          // resting quantity
+        };
+
+        void accept(const int verbose);
+        bool read(Session& session);
+        void apply(Session& session, const OrderMsg& msg);
+        void onFill(const FeedHandler::Fill& fill);
+        void publishBookUpdates();
+        bool flush(Session& session);
+        void close(Session& session, const int verbose);
+        template <typename Msg>
+        void send(Session& session, const Msg& msg)
+        {
+            static_assert(sizeof(Msg) == Frame::SIZE, "Exchange frames are 32 bytes");
+            const auto* bytes = reinterpret_cast<const char*>(&msg);
+            session.out_.insert(session.out_.end(), bytes, bytes + sizeof(Msg));
+        }
+
+        std::vector<FeedHandler::Data> updates_;    // book updates, drained by the same thread
+        FeedHandler feed_;
+        Errors errors_;
+        Counters counters_;
+        std::atomic<bool> running_{false};
+        int listenFd_ = -1;
+        int epollFd_ = -1;
+        std::string unixPath_;
+        unsigned long long nextSessionId_ = 1;
+        std::unordered_map<unsigned long long, std::unique_ptr<Session>> sessions_;
+        std::unordered_map<OrderId, Owner> owners_; // resting orders
+        Session* aggressor_ = nullptr;              // session of the order being applied
+        Quantity aggressorFilled_ = 0;
+        std::vector<char> bookBytes_;               // encoded once for every client
+    };
+
+    // Blocking client (tests, load generators)
+    class Client
+    {
+    public:
+        Client() = default;
+        ~Client();
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        bool connect(const std::string& address);
+        bool send(const OrderMsg* msgs, size_t nb);
+        // Up to <max> frames (at least one unless the exchange closed the connection)
+        size_t receive(Frame* frames, size_t max);
+        // No more orders (the exchange still sends pending responses)
+        void shutdown();
+        int fd() const { return fd_; }
+
+    private:
+        int fd_ = -1;
+        size_t partial_ = 0;    // bytes of an incomplete frame already received
+        Frame pending_;
+    };
+}
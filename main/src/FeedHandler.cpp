@@ -3,176 +3,173 @@
 #include <utils/Parser.h>
 #include <utils/StrStream.h>
 
-void FeedHandler::processMessage(const char* data, size_t dataLen, Errors& errors, const int verbose)
+#include <chrono>
+#include <functional>
+
+// Bids are sorted from the highest price, asks from the lowest one
+template <>
+struct FeedHandler::BookSide<Parser::Side::BUY>
 {
-    Parser p;
-    if (likely(p.parse(data, dataLen, errors, verbose)))
+    using Better = std::greater<Price>;
+    static constexpr Parser::Side Opposite = Parser::Side::SELL;
+    static const char* name() { return "buy"; }
+    static const char* limitName() { return "bid"; }
+    static Levels& levels(FeedHandler& feedHandler) { return feedHandler.bids_; }
+    static Orders& orders(FeedHandler& feedHandler) { return feedHandler.buyOrders_; }
+    static Priorities& priorities(FeedHandler& feedHandler) { return feedHandler.buyPriorities_; }
+    static std::unique_ptr<DepthIndex>& depth(FeedHandler& feedHandler) { return feedHandler.bidsDepth_; }
+};
+
+template <>
+struct FeedHandler::BookSide<Parser::Side::SELL>
+{
+    using Better = std::less<Price>;
+    static constexpr Parser::Side Opposite = Parser::Side::BUY;
+    static const char* name() { return "sell"; }
+    static const char* limitName() { return "ask"; }
+    static Levels& levels(FeedHandler& feedHandler) { return feedHandler.asks_; }
+    static Orders& orders(FeedHandler& feedHandler) { return feedHandler.sellOrders_; }
+    static Priorities& priorities(FeedHandler& feedHandler) { return feedHandler.sellPriorities_; }
+    static std::unique_ptr<DepthIndex>& depth(FeedHandler& feedHandler) { return feedHandler.asksDepth_; }
+};
+
+template <Parser::Side S>
+FORCE_INLINE bool FeedHandler::processOrder(char action, OrderId orderId, Order&& order, Errors& errors, const int verbose)
+{
+    switch(action)
     {
-        switch(p.getAction())
-        {
-        case static_cast<char>(Parser::Action::ADD):
-            switch(p.getSide())
-            {
-            case static_cast<char>(Parser::Side::BUY):
-                newBuyOrder(p.getOrderId(), Order{p.getQty(), p.getPrice()}, errors, verbose);
-                break;
-            case static_cast<char>(Parser::Side::SELL):
-                newSellOrder(p.getOrderId(), Order{p.getQty(), p.getPrice()}, errors, verbose);
-                break;
-            default:
-                ++errors.wrongSides;
-                break;
-            }
-            break;
-        case static_cast<char>(Parser::Action::CANCEL):
-            switch(p.getSide())
-            {
-            case static_cast<char>(Parser::Side::BUY):
-                cancelBuyOrder(p.getOrderId(), Order{p.getQty(), p.getPrice()}, errors, verbose);
-                break;
-            case static_cast<char>(Parser::Side::SELL):
-                cancelSellOrder(p.getOrderId(), Order{p.getQty(), p.getPrice()}, errors, verbose);
-                break;
-            default:
-                ++errors.wrongSides;
-                break;
-            }
-            break;
-        case static_cast<char>(Parser::Action::MODIFY):
-            switch(p.getSide())
-            {
-            case static_cast<char>(Parser::Side::BUY):
-                modifyBuyOrder(p.getOrderId(), Order{p.getQty(), p.getPrice()}, errors, verbose);
-                break;
-            case static_cast<char>(Parser::Side::SELL):
-                modifySellOrder(p.getOrderId(), Order{p.getQty(), p.getPrice()}, errors, verbose);
-                break;
-            default:
-                ++errors.wrongSides;
-                break;
-            }
-            break;
-        case static_cast<char>(Parser::Action::TRADE):
-            queue_.push_back(Data('T', 0, 0, Trade{p.getQty(), p.getPrice()}));
-            break;
-        default: 
-            ++errors.wrongActions;
-            break;
-        }
+    case static_cast<char>(Parser::Action::ADD):
+        newOrder<S>(orderId, std::forward<Order>(order), errors, verbose);
+        return true;
+    case static_cast<char>(Parser::Action::CANCEL):
+        cancelOrder<S>(orderId, std::forward<Order>(order), errors, verbose);
+        return true;
+    case static_cast<char>(Parser::Action::MODIFY):
+        modifyOrder<S>(orderId, std::forward<Order>(order), errors, verbose);
+        return true;
+    default:
+        ++errors.wrongActions;
+        return false;
     }
 }
 
-void FeedHandler::newBuyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+template <Parser::Side S>
+FORCE_INLINE FeedHandler::Levels::const_iterator FeedHandler::findLimit(Price price)
 {
-    if (unlikely(buyOrders_.find(orderId) != buyOrders_.end() || 
-                 sellOrders_.find(orderId) != sellOrders_.end()))
-    {
-        if (verbose > 0) std::cerr << "Duplicate buy orderId [" << orderId << "], new order rejected" << std::endl;
-        ++errors.duplicateOrderIds;
-        return;
-    }
-    auto itBids = std::lower_bound(bids_.begin(), bids_.end(), getPrice(order), 
-        [](Limit& l, Price p) -> bool
+    auto& levels = BookSide<S>::levels(*this);
+    return std::lower_bound(levels.begin(), levels.end(), price, 
+        [](const Limit& l, Price p) -> bool
         {
-            return (getPrice(l) > p);
+            return typename BookSide<S>::Better()(getPrice(l), p);
         });
-    if (itBids == bids_.end() || getPrice(*itBids) != getPrice(order))
-    {
-        queue_.push_back(
-            Data(static_cast<char>(Parser::Action::ADD), static_cast<char>(Parser::Side::BUY), 
-                 static_cast<unsigned int>(itBids-bids_.begin()), order)
-        );
-        bids_.insert(itBids, order);
-    }
-    else
-    {
-        getQty(*itBids) += getQty(order);
-        queue_.push_back(
-            Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(Parser::Side::BUY), 
-                 static_cast<unsigned int>(itBids-bids_.begin()), *itBids)
-        );
-    }
-    buyOrders_.emplace(orderId, std::forward<Order>(order));
 }
 
-void FeedHandler::newSellOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+template <Parser::Side S>
+FORCE_INLINE void FeedHandler::insertLevel(Levels::const_iterator itLevels, const Limit& limit)
+{
+    auto& levels = BookSide<S>::levels(*this);
+    levels.insert(itLevels, limit);
+    auto& depth = BookSide<S>::depth(*this);
+    if (unlikely(depth != nullptr)) depth->set(getPrice(limit), getQty(limit), levels);
+}
+
+template <Parser::Side S>
+FORCE_INLINE void FeedHandler::eraseLevel(Levels::const_iterator itLevels)
+{
+    auto& levels = BookSide<S>::levels(*this);
+    const auto price = getPrice(*itLevels);
+    levels.erase(itLevels);
+    auto& depth = BookSide<S>::depth(*this);
+    if (unlikely(depth != nullptr)) depth->set(price, 0ULL, levels);
+}
+
+template <Parser::Side S>
+FORCE_INLINE void FeedHandler::setLevel(Levels::const_iterator itLevels, const Limit& limit)
+{
+    auto& levels = BookSide<S>::levels(*this);
+    levels.set(itLevels, limit);
+    auto& depth = BookSide<S>::depth(*this);
+    if (unlikely(depth != nullptr)) depth->set(getPrice(limit), getQty(limit), levels);
+}
+
+template <Parser::Side S>
+FORCE_INLINE void FeedHandler::newOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
 {
     if (unlikely(buyOrders_.find(orderId) != buyOrders_.end() || 
                  sellOrders_.find(orderId) != sellOrders_.end()))
     {
-        if (verbose > 0) std::cerr << "Duplicate sell orderId [" << orderId << "], new order rejected" << std::endl;
+        if (verbose > 0) std::cerr << "Duplicate " << BookSide<S>::name() << " orderId [" << orderId << "], new order rejected" << std::endl;
         ++errors.duplicateOrderIds;
         return;
     }
-    auto itAsks = std::lower_bound(asks_.begin(), asks_.end(), getPrice(order), 
-        [](Limit& l, Price p) -> bool
-        {
-            return (getPrice(l) < p);
-        });
-    if (itAsks == asks_.end() || getPrice(*itAsks) != getPrice(order))
+    if (unlikely(matching_) && !matchOrder<S>(orderId, order)) return;
+    auto& levels = BookSide<S>::levels(*this);
+    auto itLevels = findLimit<S>(getPrice(order));
+    if (itLevels == levels.end() || getPrice(*itLevels) != getPrice(order))
     {
-        queue_.push_back(
-            Data(static_cast<char>(Parser::Action::ADD), static_cast<char>(Parser::Side::SELL), 
-                 static_cast<unsigned int>(itAsks-asks_.begin()), order)
-        );
-        asks_.insert(itAsks, order);
+        const auto pos = static_cast<unsigned int>(itLevels-levels.begin());
+        insertLevel<S>(itLevels, order);
+        publish(Data(static_cast<char>(Parser::Action::ADD), static_cast<char>(S), pos, order));
     }
-    else    
+    else
     {
-        getQty(*itAsks) += getQty(order);
-        queue_.push_back(
-            Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(Parser::Side::SELL), 
-                 static_cast<unsigned int>(itAsks-asks_.begin()), *itAsks)
+        Limit limit = *itLevels;
+        getQty(limit) += getQty(order);
+        setLevel<S>(itLevels, limit);
+        publish(
+            Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(S), 
+                 static_cast<unsigned int>(itLevels-levels.begin()), limit)
         );
     }
-    sellOrders_.emplace(orderId, std::forward<Order>(order));
+    if (unlikely(matching_))
+    {
+        auto& queue = BookSide<S>::priorities(*this)[getPrice(order)];
+        priorityPositions_[orderId] = queue.insert(queue.end(), orderId);
+    }
+    BookSide<S>::orders(*this).emplace(orderId, std::forward<Order>(order));
 }
 
-void FeedHandler::cancelBuyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+template <Parser::Side S>
+FORCE_INLINE void FeedHandler::cancelOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
 {
-    auto itOrder = buyOrders_.find(orderId);
-    if (unlikely(itOrder == buyOrders_.end()))
+    auto& orders = BookSide<S>::orders(*this);
+    auto itOrder = orders.find(orderId);
+    if (unlikely(itOrder == orders.end()))
     {
-        if (verbose > 0) std::cerr << "Unknown buy orderId [" << orderId << "], cancel order impossible" << std::endl;
+        if (verbose > 0) std::cerr << "Unknown " << BookSide<S>::name() << " orderId [" << orderId << "], cancel order impossible" << std::endl;
         ++errors.cancelsWithUnknownOrderId;
         return;
     }
     if (unlikely(getQty(itOrder->second) != getQty(order) || getPrice(itOrder->second) != getPrice(order)))
     {
-        if (verbose > 0) std::cerr << "Found buy orderId [" << orderId << "] but order info differs, cancel order rejected" << std::endl;
+        if (verbose > 0) std::cerr << "Found " << BookSide<S>::name() << " orderId [" << orderId << "] but order info differs, cancel order rejected" << std::endl;
         ++errors.cancelsNotMatchedQtyOrPrice;
         return;
     }
     
-    auto itBids = std::lower_bound(bids_.begin(), bids_.end(), getPrice(order), 
-        [](Limit& l, Price p) -> bool
-        {
-            return (getPrice(l) > p);
-        });
-    if (likely(itBids != bids_.end() && getPrice(*itBids) == getPrice(order)))
+    auto& levels = BookSide<S>::levels(*this);
+    auto itLevels = findLimit<S>(getPrice(order));
+    if (likely(itLevels != levels.end() && getPrice(*itLevels) == getPrice(order)))
     {
-        if (unlikely(getQty(*itBids) < getQty(order)))
+        if (unlikely(getQty(*itLevels) < getQty(order)))
         {
-            if (verbose > 0) std::cerr << "Unexpected issue with buy orderId [" << orderId 
-                << "] but order qty upper than bid qty, cancel order aborted" << std::endl;
+            if (verbose > 0) std::cerr << "Unexpected issue with " << BookSide<S>::name() << " orderId [" << orderId 
+                << "] but order qty upper than " << BookSide<S>::limitName() << " qty, cancel order aborted" << std::endl;
             ++errors.cancelsLimitQtyTooLow;
             return;
         }
-        getQty(*itBids) -= getQty(order);
-        if (getQty(*itBids) == 0)
+        Limit limit = *itLevels;
+        getQty(limit) -= getQty(order);
+        const auto pos = static_cast<unsigned int>(itLevels-levels.begin());
+        if (getQty(limit) == 0)
         {
-            queue_.push_back(
-                Data(static_cast<char>(Parser::Action::CANCEL), static_cast<char>(Parser::Side::BUY), 
-                     static_cast<unsigned int>(itBids-bids_.begin()))
-            );
-            bids_.erase(itBids);
+            eraseLevel<S>(itLevels);
+            publish(Data(static_cast<char>(Parser::Action::CANCEL), static_cast<char>(S), pos));
         }
         else
         {
-            queue_.push_back(
-                Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(Parser::Side::BUY), 
-                     static_cast<unsigned int>(itBids-bids_.begin()), *itBids)
-            );
+            setLevel<S>(itLevels, limit);
+            publish(Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(S), pos, limit));
         }
     }
     else
@@ -182,179 +179,334 @@ void FeedHandler::cancelBuyOrder(OrderId orderId, Order&& order, Errors& errors,
         return;
     }
     
-    buyOrders_.erase(itOrder);
+    if (unlikely(matching_)) dequeueOrder<S>(orderId, getPrice(order));
+    orders.erase(itOrder);
 }
 
-void FeedHandler::cancelSellOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+template <Parser::Side S>
+FORCE_INLINE void FeedHandler::modifyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
 {
-    auto itOrder = sellOrders_.find(orderId);
-    if (unlikely(itOrder == sellOrders_.end()))
+    auto& orders = BookSide<S>::orders(*this);
+    auto itOrder = orders.find(orderId);
+    if (unlikely(itOrder == orders.end()))
     {
-        if (verbose > 0) std::cerr << "Unknown sell orderId [" << orderId << "], cancel order impossible" << std::endl;
-        ++errors.cancelsWithUnknownOrderId;
+        if (verbose > 0) std::cerr << "Unknown " << BookSide<S>::name() << " orderId [" << orderId << "], modify order impossible" << std::endl;
+        ++errors.modifiesWithUnknownOrderId;
         return;
     }
-    if (unlikely(getQty(itOrder->second) != getQty(order) || getPrice(itOrder->second) != getPrice(order)))
+    if (unlikely(getPrice(itOrder->second) != getPrice(order)))
     {
-        if (verbose > 0) std::cerr << "Found sell orderId [" << orderId << "] but order info differs, cancel order rejected" << std::endl;
-        ++errors.cancelsNotMatchedQtyOrPrice;
+        if (verbose > 0) std::cerr << "Found " << BookSide<S>::name() << " orderId [" << orderId << "] but price differs, modify order rejected" << std::endl;
+        ++errors.modifiesNotMatchedPrice;
         return;
     }
-    
-    auto itAsks = std::lower_bound(asks_.begin(), asks_.end(), getPrice(order), 
-        [](Limit& l, Price p) -> bool
-        {
-            return (getPrice(l) < p);
-        });
-    if (likely(itAsks != asks_.end() && getPrice(*itAsks) == getPrice(order)))
+
+    auto& levels = BookSide<S>::levels(*this);
+    auto itLevels = findLimit<S>(getPrice(order));
+    if (likely(itLevels != levels.end() && getPrice(*itLevels) == getPrice(order)))
     {
-        if (unlikely(getQty(*itAsks) < getQty(order)))
+        if (unlikely(getQty(*itLevels) < getQty(itOrder->second)))
         {
-            if (verbose > 0) std::cerr << "Unexpected issue with sell orderId [" << orderId 
-                << "] but order qty upper than ask qty, cancel order aborted" << std::endl;
-            ++errors.cancelsLimitQtyTooLow;
+            if (verbose > 0) std::cerr << "Unexpected issue with " << BookSide<S>::name() << " orderId [" << orderId 
+                << "] but order qty upper than " << BookSide<S>::limitName() << " qty, modify order aborted" << std::endl;
+            ++errors.modifiesLimitQtyTooLow;
             return;
         }
-        getQty(*itAsks) -= getQty(order);
-        if (getQty(*itAsks) == 0)
+        Limit limit = *itLevels;
+        getQty(limit) -= getQty(itOrder->second);
+        getQty(limit) += getQty(order);
+        const auto pos = static_cast<unsigned int>(itLevels-levels.begin());
+        if (unlikely(getQty(limit) == 0))
         {
-            queue_.push_back(
-                Data(static_cast<char>(Parser::Action::CANCEL), static_cast<char>(Parser::Side::SELL), 
-                     static_cast<unsigned int>(itAsks-asks_.begin()))
-            );
-            asks_.erase(itAsks);
+            eraseLevel<S>(itLevels);
+            publish(Data(static_cast<char>(Parser::Action::CANCEL), static_cast<char>(S), pos));
         }
         else
         {
-            queue_.push_back(
-                Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(Parser::Side::SELL), 
-                     static_cast<unsigned int>(itAsks-asks_.begin()), *itAsks)
-            );
+            setLevel<S>(itLevels, limit);
+            publish(Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(S), pos, limit));
         }
     }
     else
     {
-        if (verbose > 0) std::cerr << "Limit not found for orderId [" << orderId << "], cancel order failed" << std::endl;
-        ++errors.cancelsLimitNotFound;
+        if (verbose > 0) std::cerr << "Limit not found for orderId [" << orderId << "], modify order failed" << std::endl;
+        ++errors.modifiesLimitNotFound;
         return;
     }
-    
-    sellOrders_.erase(itOrder);
+
+    if (unlikely(matching_) && getQty(order) > getQty(itOrder->second)) requeueOrder<S>(orderId, getPrice(order));
+    itOrder->second = std::forward<Order>(order);
 }
 
-void FeedHandler::modifyBuyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+// Matches <order> against the opposite side while it crosses, returns true if a residual remains
+template <Parser::Side S>
+bool FeedHandler::matchOrder(OrderId orderId, Order& order)
 {
-    auto itOrder = buyOrders_.find(orderId);
-    if (unlikely(itOrder == buyOrders_.end()))
+    constexpr auto O = BookSide<S>::Opposite;
+    auto& levels = BookSide<O>::levels(*this);
+    auto& orders = BookSide<O>::orders(*this);
+    auto& priorities = BookSide<O>::priorities(*this);
+    while (getQty(order) > 0 && !levels.empty() && 
+           !typename BookSide<S>::Better()(getPrice(levels.front()), getPrice(order)))
     {
-        if (verbose > 0) std::cerr << "Unknown buy orderId [" << orderId << "], modify order impossible" << std::endl;
-        ++errors.modifiesWithUnknownOrderId;
-        return;
-    }
-    if (unlikely(getPrice(itOrder->second) != getPrice(order)))
-    {
-        if (verbose > 0) std::cerr << "Found buy orderId [" << orderId << "] but price differs, modify order rejected" << std::endl;
-        ++errors.modifiesNotMatchedPrice;
-        return;
-    }
-
-    auto itBids = std::lower_bound(bids_.begin(), bids_.end(), getPrice(order), 
-        [](Limit& l, Price p) -> bool
-        {
-            return (getPrice(l) > p);
-        });
-    if (likely(itBids != bids_.end() && getPrice(*itBids) == getPrice(order)))
-    {
-        if (unlikely(getQty(*itBids) < getQty(itOrder->second)))
+        Limit limit = levels.front();
+        auto itPriority = priorities.find(getPrice(limit));
+        if (unlikely(itPriority == priorities.end())) break; // rested before matching mode
+        auto& queue = itPriority->second;
+        while (getQty(order) > 0 && !queue.empty())
         {
-            if (verbose > 0) std::cerr << "Unexpected issue with buy orderId [" << orderId 
-                << "] but order qty upper than bid qty, modify order aborted" << std::endl;
-            ++errors.modifiesLimitQtyTooLow;
-            return;
+            const auto restingId = queue.front();
+            auto itOrder = orders.find(restingId);
+            const auto fill = (itOrder != orders.end()) ? std::min(getQty(order), getQty(itOrder->second)) : 0U;
+            if (likely(fill > 0))
+            {
+                getQty(order) -= fill;
+                getQty(itOrder->second) -= fill;
+                getQty(limit) -= std::min<AggregatedQty>(fill, getQty(limit));
+                publish(Data(static_cast<char>(Parser::Action::TRADE), 0, 0, Trade{fill, getPrice(limit)}));
+                ++nbFills_;
+                if (fillHandler_) fillHandler_(Fill{orderId, restingId, static_cast<char>(S), fill, getPrice(limit)});
+            }
+            if (itOrder == orders.end() || 0U == getQty(itOrder->second))
+            {
+                if (itOrder != orders.end()) orders.erase(itOrder);
+                priorityPositions_.erase(restingId);
+                queue.pop_front();
+            }
         }
-        getQty(*itBids) -= getQty(itOrder->second);
-        getQty(*itBids) += getQty(order);
-        if (unlikely(getQty(*itBids) == 0))
+        if (queue.empty()) priorities.erase(itPriority);
+        if (0U == getQty(limit) || queue.empty())
         {
-            queue_.push_back(
-                Data(static_cast<char>(Parser::Action::CANCEL), static_cast<char>(Parser::Side::BUY), 
-                     static_cast<unsigned int>(itBids-bids_.begin()))
-            );
-            bids_.erase(itBids);
+            eraseLevel<O>(levels.begin());
+            publish(Data(static_cast<char>(Parser::Action::CANCEL), static_cast<char>(O), 0));
         }
         else
         {
-            queue_.push_back(
-                Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(Parser::Side::BUY), 
-                     static_cast<unsigned int>(itBids-bids_.begin()), *itBids)
-            );
+            setLevel<O>(levels.begin(), limit);
+            publish(Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(O), 0, limit));
         }
     }
-    else
+    return getQty(order) > 0;
+}
+
+template <Parser::Side S>
+void FeedHandler::dequeueOrder(OrderId orderId, Price price)
+{
+    auto itPosition = priorityPositions_.find(orderId);
+    if (unlikely(itPosition == priorityPositions_.end())) return;
+    auto& priorities = BookSide<S>::priorities(*this);
+    auto itPriority = priorities.find(price);
+    if (likely(itPriority != priorities.end()))
     {
-        if (verbose > 0) std::cerr << "Limit not found for orderId [" << orderId << "], modify order failed" << std::endl;
-        ++errors.modifiesLimitNotFound;
-        return;
+        itPriority->second.erase(itPosition->second);
+        if (itPriority->second.empty()) priorities.erase(itPriority);
     }
+    priorityPositions_.erase(itPosition);
+}
 
-    itOrder->second = std::forward<Order>(order);
+// Moves <orderId> to the back of its price FIFO (qty increase loses the time priority)
+template <Parser::Side S>
+void FeedHandler::requeueOrder(OrderId orderId, Price price)
+{
+    auto itPosition = priorityPositions_.find(orderId);
+    if (unlikely(itPosition == priorityPositions_.end())) return;
+    auto& priorities = BookSide<S>::priorities(*this);
+    auto itPriority = priorities.find(price);
+    if (likely(itPriority != priorities.end()))
+    {
+        auto& queue = itPriority->second;
+        queue.splice(queue.end(), queue, itPosition->second);
+    }
 }
 
-void FeedHandler::modifySellOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+void FeedHandler::enableDepthQueries(Price tickSize, size_t maxTicks)
+{
+    bidsDepth_ = std::make_unique<DepthIndex>(true, tickSize, maxTicks);
+    asksDepth_ = std::make_unique<DepthIndex>(false, tickSize, maxTicks);
+    bidsDepth_->rebuild(bids_);
+    asksDepth_->rebuild(asks_);
+}
+
+bool FeedHandler::apply(char action, char side, OrderId orderId, Order&& order, Errors& errors, const int verbose)
 {
-    auto itOrder = sellOrders_.find(orderId);
-    if (unlikely(itOrder == sellOrders_.end()))
+    if (unlikely(static_cast<char>(Parser::Action::TRADE) == action))
     {
-        if (verbose > 0) std::cerr << "Unknown sell orderId [" << orderId << "], modify order impossible" << std::endl;
-        ++errors.modifiesWithUnknownOrderId;
-        return;
+        publish(Data('T', 0, 0, Trade{getQty(order), getPrice(order)}));
+        return true;
     }
-    if (unlikely(getPrice(itOrder->second) != getPrice(order)))
+    // Book changed under an odd sequence (both sides)
+    const auto sequence = bookSequence_.load(std::memory_order_relaxed);
+    bookSequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    const auto applied = applyOrder(action, side, orderId, std::forward<Order>(order), errors, verbose);
+    bookSequence_.store(sequence + 2, std::memory_order_release);
+    return applied;
+}
+
+bool FeedHandler::applyOrder(char action, char side, OrderId orderId, Order&& order, Errors& errors, const int verbose)
+{
+    // Side dispatched once, each action then runs fully specialized for its side
+    switch(side)
     {
-        if (verbose > 0) std::cerr << "Found sell orderId [" << orderId << "] but price differs, modify order rejected" << std::endl;
-        ++errors.modifiesNotMatchedPrice;
-        return;
+    case static_cast<char>(Parser::Side::BUY):
+        return processOrder<Parser::Side::BUY>(action, orderId, std::forward<Order>(order), errors, verbose);
+    case static_cast<char>(Parser::Side::SELL):
+        return processOrder<Parser::Side::SELL>(action, orderId, std::forward<Order>(order), errors, verbose);
+    default:
+        ++errors.wrongSides;
+        return false;
     }
-    
-    auto itAsks = std::lower_bound(asks_.begin(), asks_.end(), getPrice(order), 
-        [](Limit& l, Price p) -> bool
-        {
-            return (getPrice(l) < p);
-        });
-    if (likely(itAsks != asks_.end() && getPrice(*itAsks) == getPrice(order)))
+}
+
+void FeedHandler::processMessage(const char* data, size_t dataLen, Errors& errors, const int verbose)
+{
+    if (unlikely(latency_ != nullptr)) messageTsc_ = tsc::now();
+    Parser p;
+    bool parsed;
     {
-        if (unlikely(getQty(*itAsks) < getQty(itOrder->second)))
-        {
-            if (verbose > 0) std::cerr << "Unexpected issue with sell orderId [" << orderId 
-                << "] but order qty upper than ask qty, modify order aborted" << std::endl;
-            ++errors.modifiesLimitQtyTooLow;
-            return;
-        }
-        getQty(*itAsks) -= getQty(itOrder->second);
-        getQty(*itAsks) += getQty(order);
-        if (unlikely(getQty(*itAsks) == 0))
+        PERF_REGION(perf_, PerfRegions::PARSE);
+        parsed = p.parse(data, dataLen, errors, verbose);
+    }
+    if (likely(parsed))
+    {
+        auto timestamp = p.getTimestamp();
+        if (unlikely(replay_ != nullptr))
         {
-            queue_.push_back(
-                Data(static_cast<char>(Parser::Action::CANCEL), static_cast<char>(Parser::Side::SELL), 
-                     static_cast<unsigned int>(itAsks-asks_.begin()))
-            );
-            asks_.erase(itAsks);
+            timestamp = replay_->release(timestamp);
+            if (unlikely(latency_ != nullptr)) messageTsc_ = tsc::now(); // received once released
         }
-        else
+        if (p.getSequence() && !sequence(p.getSequence(), data, dataLen, errors, verbose)) return;
+        applyParsed(p, timestamp, errors, verbose);
+        if (unlikely(!bufferedMessages_.empty())) applyBuffered(errors, verbose);
+    }
+}
+
+void FeedHandler::applyParsed(Parser& p, unsigned long long timestamp, Errors& errors, const int verbose)
+{
+    PERF_REGION(perf_, PerfRegions::region(p.getAction(), p.getSide()));
+    messageTimestamp_ = timestamp;
+    if (unlikely(!apply(p.getAction(), p.getSide(), p.getOrderId(), Order{p.getQty(), p.getPrice()}, errors, verbose))) return;
+    if (unlikely(latency_ != nullptr)) latency_->record(p.getAction(), p.getSide(), tsc::now() - messageTsc_);
+    if (unlikely(exchangeLatency_ != nullptr && messageTimestamp_))
+    {
+        const auto now = static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        exchangeLatency_->recordNs(p.getAction(), p.getSide(), now > messageTimestamp_ ? now - messageTimestamp_ : 0ULL);
+    }
+    if (unlikely(stats_ != nullptr))
+    {
+        stats_->messages_[stats::FeedStats::message(p.getAction())].inc();
+        stats_->published_.set(bookVersion_);
+        stats_->bidLevels_.set(bids_.size());
+        stats_->askLevels_.set(asks_.size());
+    }
+}
+
+bool FeedHandler::sequence(unsigned long long sequence, const char* data, size_t dataLen, Errors& errors, const int verbose)
+{
+    if (unlikely(0ULL == nextSequence_)) nextSequence_ = highestSequence_ = sequence;
+    if (unlikely(sequence < nextSequence_ || bufferedMessages_.count(sequence)))
+    {
+        if (verbose > 0) std::cerr << "Duplicate sequence [" << sequence << "] in [" << std::string(data, dataLen) << "]" << std::endl;
+        ++errors.duplicateSequences;
+        return false;
+    }
+    // Behind the highest one received => it fills a gap
+    if (unlikely(sequence < highestSequence_)) ++errors.outOfOrderSequences;
+    if (likely(sequence == nextSequence_))
+    {
+        ++nextSequence_;
+        if (sequence > highestSequence_) highestSequence_ = sequence;
+        return true;
+    }
+    
+    bufferedMessages_.emplace(sequence, std::string(data, dataLen));
+    auto from = 0ULL, to = 0ULL;
+    if (sequence > highestSequence_ + 1)
+    {
+        // New gap (after the highest one received, nothing is missing before the first buffered one)
+        from = bufferedMessages_.size() > 1 ? highestSequence_ + 1 : nextSequence_;
+        to = sequence - 1;
+        if (verbose > 0) std::cerr << "Sequence gap [" << from << ", " << to << "]" << std::endl;
+        ++errors.sequenceGaps;
+    }
+    if (sequence > highestSequence_) highestSequence_ = sequence;
+    if (unlikely(bufferedMessages_.size() > maxBufferedMessages_))
+    {
+        const auto first = bufferedMessages_.begin()->first;
+        if (verbose > 0) std::cerr << "Sequence gap [" << nextSequence_ << ", " << first - 1 << "] abandoned" << std::endl;
+        errors.lostSequences += first - nextSequence_;
+        nextSequence_ = first;
+        applyBuffered(errors, verbose);
+    }
+    // Last: the handler may process messages itself
+    if (from && to >= nextSequence_ && recoveryHandler_) recoveryHandler_(from, to);
+    return false;
+}
+
+void FeedHandler::applyBuffered(Errors& errors, const int verbose)
+{
+    for (auto it = bufferedMessages_.begin(); it != bufferedMessages_.end() && it->first <= nextSequence_; )
+    {
+        if (it->first == nextSequence_)
         {
-            queue_.push_back(
-                Data(static_cast<char>(Parser::Action::MODIFY), static_cast<char>(Parser::Side::SELL), 
-                     static_cast<unsigned int>(itAsks-asks_.begin()), *itAsks)
-            );
+            Parser p;
+            p.parse(it->second.data(), it->second.size(), errors, verbose);
+            ++nextSequence_;
+            applyParsed(p, replay_ != nullptr ? replay_->rebase(p.getTimestamp()) : p.getTimestamp(), errors, verbose);
         }
+        it = bufferedMessages_.erase(it);
     }
-    else
+}
+
+void FeedHandler::resetSequence(unsigned long long sequence, Errors& errors, const int verbose)
+{
+    nextSequence_ = sequence + 1;
+    if (sequence > highestSequence_) highestSequence_ = sequence;
+    // Already in the book
+    bufferedMessages_.erase(bufferedMessages_.begin(), bufferedMessages_.upper_bound(sequence));
+    applyBuffered(errors, verbose);
+}
+
+void FeedHandler::publishConflated(Data&& data)
+{
+    // Each update carries the top of book and the depth is shared with the reporter => a pending level
+    // change of the same side is overwritten whatever its level, only trades are queued
+    if (unlikely(static_cast<char>(Parser::Action::TRADE) == data.action_))
     {
-        if (verbose > 0) std::cerr << "Limit not found for orderId [" << orderId << "], modify order failed" << std::endl;
-        ++errors.modifiesLimitNotFound;
+        conflatedQueue_->push_back(std::forward<Data>(data));
         return;
     }
+    const size_t sideKey = (static_cast<char>(Parser::Side::BUY) == data.side_) ? 0U : 1U;
+    conflatedQueue_->push_back(sideKey, std::forward<Data>(data));
+}
 
-    itOrder->second = std::forward<Order>(order);
+void FeedHandler::newBuyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+{
+    newOrder<Parser::Side::BUY>(orderId, std::forward<Order>(order), errors, verbose);
+}
+
+void FeedHandler::newSellOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+{
+    newOrder<Parser::Side::SELL>(orderId, std::forward<Order>(order), errors, verbose);
+}
+
+void FeedHandler::cancelBuyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+{
+    cancelOrder<Parser::Side::BUY>(orderId, std::forward<Order>(order), errors, verbose);
 }
 
+void FeedHandler::cancelSellOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+{
+    cancelOrder<Parser::Side::SELL>(orderId, std::forward<Order>(order), errors, verbose);
+}
+
+void FeedHandler::modifyBuyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+{
+    modifyOrder<Parser::Side::BUY>(orderId, std::forward<Order>(order), errors, verbose);
+}
+
+void FeedHandler::modifySellOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose)
+{
+    modifyOrder<Parser::Side::SELL>(orderId, std::forward<Order>(order), errors, verbose);
+}
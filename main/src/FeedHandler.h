@@ -1,10 +1,26 @@
 #pragma once
 
 #include "utils/Common.h"
+#include "utils/Arena.h"
 #include "utils/WaitFreeQueue.h"
+#include "utils/ConflatingQueue.h"
+#include "utils/VersionedLevels.h"
+#include "utils/Parser.h"
+#include "Latency.h"
+#include "PerfRegions.h"
+#include "Stats.h"
+#include "Analytics.h"
+#include "DepthIndex.h"
+#include "Replay.h"
 
+#include <atomic>
 #include <unordered_map>
-#include <deque>
+#include <map>
+#include <list>
+#include <string>
+#include <functional>
+#include <memory>
+#include <vector>
 
 using namespace common;
 
@@ -28,17 +44,148 @@ public:
         char side_ = 0;
         unsigned int pos_ = 0;
         Limit limit_{0, 0.0};
+        // Top of book once this update applied (empty side => zero quantity)
+        unsigned long long bookVersion_ = 0;
+        Limit bestBid_{0, 0.0};
+        Limit bestAsk_{0, 0.0};
+        // TSC when the message was received (0 => not measured)
+        unsigned long long tsc_ = 0;
+        // Exchange timestamp of the message in ns since epoch (0 => none, see Parser)
+        unsigned long long timestamp_ = 0;
+        // Order-flow signals once this update applied (only with setAnalytics(), NaN otherwise)
+        Analytics::Signals signals_;
         char pad2_[cacheLinesSze] = "";
     };
     
-    FeedHandler(WaitFreeQueue<Data>& queue) : queue_(queue) {}
+    // Execution generated by the matching mode (aggressor side, resting order price)
+    struct Fill
+    {
+        OrderId aggressorId_ = 0;
+        OrderId restingId_ = 0;
+        char side_ = 0;
+        Quantity qty_ = 0;
+        Price price_ = 0.0;
+    };
+    using FillHandler = std::function<void(const Fill&)>;
+    // Sequences [from, to] missing (see setRecoveryHandler)
+    using RecoveryHandler = std::function<void(unsigned long long from, unsigned long long to)>;
+    
+    // Book shared with the Reporter (read only through snapshots)
+    using Levels = VersionedLevels<Limit>;
+    
+    // Conflated channel: one key per side (see publishConflated), trades queued
+    using ConflatedQueue = ConflatingQueue<Data, 64>;
+    
+    // Order tables nodes from <arena> (feed thread only), from the heap without
+    FeedHandler(WaitFreeQueue<Data>& queue, Arena* arena = nullptr)
+        : buyOrders_(0, std::hash<OrderId>(), std::equal_to<OrderId>(), OrdersAllocator(arena))
+        , sellOrders_(0, std::hash<OrderId>(), std::equal_to<OrderId>(), OrdersAllocator(arena))
+        , queue_(&queue)
+    {
+    }
+    FeedHandler(ConflatedQueue& queue, Arena* arena = nullptr)
+        : buyOrders_(0, std::hash<OrderId>(), std::equal_to<OrderId>(), OrdersAllocator(arena))
+        , sellOrders_(0, std::hash<OrderId>(), std::equal_to<OrderId>(), OrdersAllocator(arena))
+        , conflatedQueue_(&queue)
+    {
+    }
+    // Single threaded consumer: updates appended to <updates>, drained (cleared) by the caller
+    FeedHandler(std::vector<Data>& updates, Arena* arena = nullptr)
+        : buyOrders_(0, std::hash<OrderId>(), std::equal_to<OrderId>(), OrdersAllocator(arena))
+        , sellOrders_(0, std::hash<OrderId>(), std::equal_to<OrderId>(), OrdersAllocator(arena))
+        , updates_(&updates)
+    {
+    }
     ~FeedHandler() = default;
     FeedHandler(const FeedHandler&) = delete;
     FeedHandler& operator=(const FeedHandler&) = delete;
 
     void processMessage(const char* data, size_t dataLen, Errors& errors, const int verbose = 0);
+    // Already decoded message (e.g. binary order entry), false when its action or side is unknown
+    bool apply(char action, char side, OrderId orderId, Order&& order, Errors& errors, const int verbose = 0);
+    
+    // Order tables sized for <nbOrders> live orders per side (no rehash while running), after setMatching()
+    void reserve(size_t nbOrders)
+    {
+        buyOrders_.reserve(nbOrders);
+        sellOrders_.reserve(nbOrders);
+        if (matching_) priorityPositions_.reserve(2 * nbOrders);
+    }
+    // Arena size for <nbOrders> live orders per side: nodes and bucket arrays (power of two classes)
+    static size_t arenaBytes(size_t nbOrders)
+    {
+        const auto node = (sizeof(void*) + sizeof(Orders::value_type) + Arena::ALIGNMENT - 1) / Arena::ALIGNMENT * Arena::ALIGNMENT;
+        const auto buckets = 6 * sizeof(void*) * (nbOrders + 1); // reserve() then one rehash when exceeded
+        return 2 * (nbOrders * node + buckets);
+    }
+    
+    // Incremented by each published update (unchanged => message rejected)
+    unsigned long long bookVersion() const { return bookVersion_; }
+    // Seqlock over both sides: odd while a message changes the book, so readers pair their snapshots
+    // of the bids and asks on one book state (see Reporter::printCurrentOrderBook)
+    const std::atomic<unsigned long long>& bookSequence() const { return bookSequence_; }
+    const Levels& getBids() const { return bids_; }
+    const Levels& getAsks() const { return asks_; }
+    
+    // Record from message received to book applied (and published)
+    void setLatency(Latency* latency) { latency_ = latency; }
+    // Record from exchange timestamp (extended format) to book applied, on the realtime clock
+    // (meaningful when the exchange and this host clocks are synchronized, e.g. PTP)
+    void setExchangeLatency(Latency* latency) { exchangeLatency_ = latency; }
+    // Messages released at the pace of their exchange timestamps, rebased (see Replay)
+    void setReplay(Replay* replay) { replay_ = replay; }
+    // Hardware counters around parsing and each operation (only with -DPERF_COUNTERS=ON)
+    void setPerfRegions(PerfRegions* perf) { perf_ = perf; }
+    // Applied messages per action and published updates (shared memory, see fhstat)
+    void setStats(stats::FeedStats* stats) { stats_ = stats; }
+    // Signals updated by each published update and carried by it (feed thread)
+    void setAnalytics(Analytics* analytics) { analytics_ = analytics; }
+    
+    // Matching mode (set before the first message): an add crossing the opposite best is matched
+    // price-time against resting orders (trades published, resting orders filled), the rest is rested.
+    // A modify decreasing the qty keeps the time priority of the order, an increase moves it behind
+    // the orders resting at its price.
+    void setMatching(bool matching) { matching_ = matching; }
+    bool matching() const { return matching_; }
+    // Called for each fill in matching mode (feed thread)
+    void setFillHandler(FillHandler&& fillHandler) { fillHandler_ = std::move(fillHandler); }
+    unsigned long long nbFills() const { return nbFills_; }
+    
+    // Sequencing of the messages having a sequence number (extended format): the first one sets the
+    // expected sequence, duplicates are dropped and messages ahead of a gap are buffered (application
+    // paused) until the missing ones arrive, e.g. retransmitted, or a snapshot is applied. Each new gap
+    // is reported to the handler (feed thread), which may call processMessage() or resetSequence()
+    // itself. Messages without sequence (e.g. a snapshot) are applied whatever the gap.
+    void setRecoveryHandler(RecoveryHandler&& recoveryHandler) { recoveryHandler_ = std::move(recoveryHandler); }
+    // More than <nbMessages> buffered => the gap is abandoned (lost sequences counted) and the
+    // buffered messages are applied from the first one
+    void setMaxBufferedMessages(size_t nbMessages) { maxBufferedMessages_ = nbMessages; }
+    // Book applied up to <sequence> included (e.g. snapshot): buffered messages after it are applied
+    void resetSequence(unsigned long long sequence, Errors& errors, const int verbose = 0);
+    // Next sequence to apply (0 => no sequenced message yet) and messages waiting for the gap to fill
+    unsigned long long nextSequence() const { return nextSequence_; }
+    size_t nbBufferedMessages() const { return bufferedMessages_.size(); }
+    
+    // Depth queries on the live book (feed thread, e.g. risk checks of an order before it is applied),
+    // answered in O(log n) by an index over the price ticks of each side updated with its levels.
+    // Enabling it indexes the current book, prices are expected on the <tickSize> grid and only the
+    // levels within <maxTicks> of the best are covered (see DepthIndex).
+    void enableDepthQueries(Price tickSize, size_t maxTicks = DepthIndex::DEFAULT_MAX_TICKS);
+    // Quantity of the levels of <side> at most <ticks> ticks away from its best (0 if not enabled)
+    AggregatedQty depthWithin(char side, unsigned long long ticks) const
+    {
+        const auto& depth = (static_cast<char>(Parser::Side::BUY) == side) ? bidsDepth_ : asksDepth_;
+        return depth ? depth->within(ticks) : 0ULL;
+    }
+    // Levels of <side> swept by an opposite order of <qty> (nothing available if not enabled)
+    DepthIndex::Sweep sweep(char side, AggregatedQty qty) const
+    {
+        const auto& depth = (static_cast<char>(Parser::Side::BUY) == side) ? bidsDepth_ : asksDepth_;
+        return depth ? depth->sweep(qty) : DepthIndex::Sweep();
+    }
         
 protected:
+    // Side specific wrappers of the book side engine below
     void newBuyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose = 0);
     void newSellOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose = 0);
     
@@ -48,9 +195,86 @@ protected:
     void modifyBuyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose = 0);
     void modifySellOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose = 0);
     
-    std::deque<Limit> bids_, asks_;
-    std::unordered_map<OrderId, Order> buyOrders_, sellOrders_;
+    // Parsed message applied with its latency and statistics (<timestamp> once rebased by the replay)
+    void applyParsed(Parser& p, unsigned long long timestamp, Errors& errors, const int verbose);
+    // False when the message is not applied now (duplicate or buffered behind a gap)
+    bool sequence(unsigned long long sequence, const char* data, size_t dataLen, Errors& errors, const int verbose);
+    // Buffered messages following the applied ones
+    void applyBuffered(Errors& errors, const int verbose);
+    
+    // Book side engine: one instantiation per side, levels kept best first by BookSide<S>::Better
+    template <Parser::Side S> struct BookSide;
+    // Order of <side> applied under the book seqlock
+    bool applyOrder(char action, char side, OrderId orderId, Order&& order, Errors& errors, const int verbose);
+    template <Parser::Side S> bool processOrder(char action, OrderId orderId, Order&& order, Errors& errors, const int verbose);
+    template <Parser::Side S> Levels::const_iterator findLimit(Price price);
+    template <Parser::Side S> void newOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose);
+    template <Parser::Side S> void cancelOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose);
+    template <Parser::Side S> void modifyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose);
+    template <Parser::Side S> bool matchOrder(OrderId orderId, Order& order);
+    template <Parser::Side S> void dequeueOrder(OrderId orderId, Price price);
+    template <Parser::Side S> void requeueOrder(OrderId orderId, Price price);
+    // Levels changes, depth index kept in sync
+    template <Parser::Side S> void insertLevel(Levels::const_iterator itLevels, const Limit& limit);
+    template <Parser::Side S> void eraseLevel(Levels::const_iterator itLevels);
+    template <Parser::Side S> void setLevel(Levels::const_iterator itLevels, const Limit& limit);
+    
+    FORCE_INLINE void publish(Data&& data)
+    {
+        data.bookVersion_ = ++bookVersion_;
+        data.tsc_ = messageTsc_;
+        data.timestamp_ = messageTimestamp_;
+        if (likely(!bids_.empty())) data.bestBid_ = bids_.front();
+        if (likely(!asks_.empty())) data.bestAsk_ = asks_.front();
+        if (unlikely(analytics_ != nullptr)) analyze(data);
+        if (likely(queue_ != nullptr)) queue_->push_back(std::forward<Data>(data));
+        else if (updates_ != nullptr) updates_->emplace_back(std::forward<Data>(data));
+        else publishConflated(std::forward<Data>(data));
+    }
+    void publishConflated(Data&& data);
+    FORCE_INLINE void analyze(Data& data)
+    {
+        if (static_cast<char>(Parser::Action::TRADE) == data.action_) analytics_->onTrade(data.limit_);
+        else
+        {
+            const auto bid = static_cast<char>(Parser::Side::BUY) == data.side_;
+            analytics_->onLevel(data.action_, bid, data.pos_, getQty(data.limit_), bid ? bids_ : asks_);
+        }
+        data.signals_ = analytics_->signals(data.bestBid_, data.bestAsk_);
+    }
+    
+    Levels bids_, asks_;
+    using OrdersAllocator = ArenaAllocator<std::pair<const OrderId, Order>>;
+    using Orders = std::unordered_map<OrderId, Order, std::hash<OrderId>, std::equal_to<OrderId>, OrdersAllocator>;
+    Orders buyOrders_, sellOrders_;
+    // Matching mode: resting order ids per price in time priority (and their position for O(1) cancels)
+    using Priorities = std::unordered_map<Price, std::list<OrderId>>;
+    Priorities buyPriorities_, sellPriorities_;
+    std::unordered_map<OrderId, std::list<OrderId>::iterator> priorityPositions_;
+    bool matching_ = false;
+    FillHandler fillHandler_;
+    unsigned long long nbFills_ = 0;
+    std::unique_ptr<DepthIndex> bidsDepth_, asksDepth_;
+    // Sequencing: messages received ahead of the next sequence, by sequence
+    unsigned long long nextSequence_ = 0;
+    unsigned long long highestSequence_ = 0;
+    std::map<unsigned long long, std::string> bufferedMessages_;
+    size_t maxBufferedMessages_ = 1024;
+    RecoveryHandler recoveryHandler_;
+    unsigned long long bookVersion_ = 0;
+    std::atomic<unsigned long long> bookSequence_{0ULL};
+    
+    Latency* latency_ = nullptr;
+    unsigned long long messageTsc_ = 0;
+    Latency* exchangeLatency_ = nullptr;
+    unsigned long long messageTimestamp_ = 0;
+    Replay* replay_ = nullptr;
+    PerfRegions* perf_ = nullptr;
+    stats::FeedStats* stats_ = nullptr;
+    Analytics* analytics_ = nullptr;
     
-    WaitFreeQueue<Data>& queue_;
+    WaitFreeQueue<Data>* queue_ = nullptr;
+    ConflatedQueue* conflatedQueue_ = nullptr;
+    std::vector<Data>* updates_ = nullptr;
 };
 
@@ -0,0 +1,44 @@
+#include "Latency.h"
+
+#include <utils/StrStream.h>
+
+std::atomic<unsigned int> Latency::printRequests_{0U};
+
+void Latency::print(std::ostream& os, const char* stage) const
+{
+    StrStream strstream;
+    format(strstream, stage);
+    os.rdbuf()->sputn(strstream.c_str(), strstream.length());
+    os.flush();
+}
+
+void Latency::format(StrStream& strstream, const char* stage) const
+{
+    static constexpr char actions[] = { 'A', 'M', 'X', 'T' };
+    static constexpr char sides[] = { 'B', 'S' };
+    auto ns = [](unsigned long long ticks) { return static_cast<unsigned long long>(tsc::toNs(ticks) + 0.5); };
+    strstream << "Latencies (in ns) " << stage << ":\n";
+    for (auto a = 0UL; a < hists_.size(); ++a)
+    {
+        for (auto s = 0UL; s < hists_[a].size(); ++s)
+        {
+            const auto& hist = hists_[a][s];
+            if (0ULL == hist.count()) continue;
+            strstream << actions[a];
+            if ('T' != actions[a]) strstream << ' ' << sides[s];
+            strstream << " count [" << hist.count() << "] min [" << ns(hist.min())
+                << "] mean [" << static_cast<unsigned long long>(hist.mean() * tsc::nsPerTick() + 0.5)
+                << "] p50 [" << ns(hist.percentile(50.0))
+                << "] p90 [" << ns(hist.percentile(90.0))
+                << "] p99 [" << ns(hist.percentile(99.0))
+                << "] p99.9 [" << ns(hist.percentile(99.9))
+                << "] max [" << ns(hist.max()) << "]\n";
+        }
+    }
+}
+
+void Latency::reset()
+{
+    for (auto& hists : hists_)
+        for (auto& hist : hists) hist.reset();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "utils/Common.h"
+#include "utils/Histogram.h"
+#include "utils/Tsc.h"
+#include "utils/StrStream.h"
+
+#include <array>
+#include <atomic>
+
+using namespace common;
+
+// Latencies in TSC ticks per action (A/M/X/T) and side (B/S, trades have none).
+// One instance per thread: only its thread records and prints (or formats) it.
+class Latency
+{
+public:
+    using Hist = Histogram<>;
+
+    FORCE_INLINE void record(char action, char side, unsigned long long ticks)
+    {
+        hists_[actionIndex(action)]['S' == side ? 1 : 0].record(ticks);
+    }
+    // Duration measured in ns (e.g. from a timestamp of another host), kept in ticks like the others
+    FORCE_INLINE void recordNs(char action, char side, unsigned long long ns)
+    {
+        record(action, side, static_cast<unsigned long long>(static_cast<double>(ns) / tsc::nsPerTick()));
+    }
+
+    // Count, min, mean, p50, p90, p99, p99.9 and max in ns per action/side
+    void print(std::ostream& os, const char* stage) const;
+    // Same lines appended to <strstream> (e.g. written at once by the thread recording them)
+    void format(StrStream& strstream, const char* stage) const;
+    void reset();
+
+    // Async-signal-safe: each instance sees it once through printRequested()
+    static void requestPrint() { printRequests_.fetch_add(1U, std::memory_order_relaxed); }
+    FORCE_INLINE bool printRequested()
+    {
+        const auto requests = printRequests_.load(std::memory_order_relaxed);
+        if (likely(requests == printed_)) return false;
+        printed_ = requests;
+        return true;
+    }
+
+    const Hist& get(char action, char side) const { return hists_[actionIndex(action)]['S' == side ? 1 : 0]; }
+    // Recorded latencies of all actions and sides
+    unsigned long long count() const
+    {
+        auto count = 0ULL;
+        for (auto& hists : hists_)
+            for (auto& hist : hists) count += hist.count();
+        return count;
+    }
+
+private:
+    static FORCE_INLINE size_t actionIndex(char action)
+    {
+        switch(action)
+        {
+        case 'A': return 0;
+        case 'M': return 1;
+        case 'X': return 2;
+        default: return 3;
+        }
+    }
+
+    std::array<std::array<Hist, 2>, 4> hists_;
+    unsigned int printed_ = 0U;
+    static std::atomic<unsigned int> printRequests_;
+};
@@ -0,0 +1,139 @@
+#include "Multicast.h"
+
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace multicast
+{
+    constexpr int Receiver::RECEIVE_BUFFER_BYTES;
+    constexpr int Receiver::BUSY_POLL_US;
+
+    bool parseAddress(const std::string& address, sockaddr_in& addr)
+    {
+        const auto colon = address.rfind(':');
+        if (colon == std::string::npos) return false;
+        addr = sockaddr_in{};
+        addr.sin_family = AF_INET;
+        const auto port = strtoul(address.c_str() + colon + 1, nullptr, 10);
+        if (0UL == port || port > 65535UL) return false;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        return 1 == inet_pton(AF_INET, address.substr(0, colon).c_str(), &addr.sin_addr) && IN_MULTICAST(ntohl(addr.sin_addr.s_addr));
+    }
+
+    bool parseInterface(const std::string& interfaceAddress, in_addr& addr)
+    {
+        return 1 == inet_pton(AF_INET, interfaceAddress.c_str(), &addr);
+    }
+
+    Receiver::Receiver()
+        : buffers_(BATCH * DATAGRAM_BYTES)
+        , iovecs_(BATCH)
+        , msgs_(BATCH)
+    {
+        for (auto i = 0UL; i < BATCH; ++i)
+        {
+            iovecs_[i].iov_base = &buffers_[i * DATAGRAM_BYTES];
+            iovecs_[i].iov_len = DATAGRAM_BYTES;
+            msgs_[i] = mmsghdr{};
+            msgs_[i].msg_hdr.msg_iov = &iovecs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    Receiver::~Receiver()
+    {
+        close();
+    }
+
+    bool Receiver::open(const std::string& address, const std::string& interfaceAddress)
+    {
+        sockaddr_in group;
+        ip_mreq membership{};
+        if (!parseAddress(address, group) || !parseInterface(interfaceAddress, membership.imr_interface))
+        {
+            std::cerr << "Expected a multicast <group>:<port> and an interface address in [" << address << "] [" << interfaceAddress << "]" << std::endl;
+            return false;
+        }
+        membership.imr_multiaddr = group.sin_addr;
+        fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        const int one = 1;
+        const timeval timeout{0, TIMEOUT_MS * 1000};
+        // Bound to the group: only its datagrams, several receivers on the same host
+        if (fd_ < 0
+            || setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0
+            || bind(fd_, reinterpret_cast<const sockaddr*>(&group), sizeof(group)) < 0
+            || setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0
+            || setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0)
+        {
+            std::cerr << "Unable to join [" << address << "] on [" << interfaceAddress << "]: " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+        // Best effort: bounded by the system limits
+        setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &RECEIVE_BUFFER_BYTES, sizeof(RECEIVE_BUFFER_BYTES));
+#ifdef SO_BUSY_POLL
+        busyPoll_ = 0 == setsockopt(fd_, SOL_SOCKET, SO_BUSY_POLL, &BUSY_POLL_US, sizeof(BUSY_POLL_US));
+#endif
+        return true;
+    }
+
+    void Receiver::close()
+    {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    Sender::~Sender()
+    {
+        close();
+    }
+
+    bool Sender::open(const std::string& address, const std::string& interfaceAddress, int ttl)
+    {
+        in_addr interface;
+        if (!parseAddress(address, group_) || !parseInterface(interfaceAddress, interface))
+        {
+            std::cerr << "Expected a multicast <group>:<port> and an interface address in [" << address << "] [" << interfaceAddress << "]" << std::endl;
+            return false;
+        }
+        fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        const unsigned char loop = 1, hops = static_cast<unsigned char>(ttl);
+        if (fd_ < 0
+            || setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface)) < 0
+            || setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0
+            || setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_TTL, &hops, sizeof(hops)) < 0)
+        {
+            std::cerr << "Unable to send to [" << address << "] from [" << interfaceAddress << "]: " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void Sender::close()
+    {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    bool Sender::send(const char* data, size_t len)
+    {
+        const auto* addr = reinterpret_cast<const sockaddr*>(&group_);
+        // Full socket buffer => retried (loopback)
+        for (;;)
+        {
+            if (likely(sendto(fd_, data, len, 0, addr, sizeof(group_)) == static_cast<ssize_t>(len))) return true;
+            if (ENOBUFS != errno && EAGAIN != errno && EINTR != errno) return false;
+        }
+    }
+
+    bool Sender::end(unsigned int nb)
+    {
+        auto sent = false;
+        for (auto i = 0U; i < nb; ++i) sent = send(nullptr, 0) || sent;
+        return sent;
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+using namespace common;
+
+// UDP multicast feed (same host on loopback, or LAN): each datagram carries one or more messages of
+// the text feed separated by '\n' (the last one may lack it), an empty datagram ends the feed.
+// Receiver: joins the group on one interface, reads up to BATCH datagrams per system call (recvmmsg)
+// and busy polls the device queue when blocked (SO_BUSY_POLL, needs CAP_NET_ADMIN above
+// net.core.busy_read). Lost datagrams are not detected here: see the sequence numbers of the
+// extended format (FeedHandler::setRecoveryHandler).
+// Sender: one datagram per send (whole messages), multicast looped back to the local host.
+
+namespace multicast
+{
+    // <group>:<port> (e.g. 239.255.0.1:30001), false unless an IPv4 multicast group
+    bool parseAddress(const std::string& address, sockaddr_in& addr);
+    // Interface of <interfaceAddress> (e.g. 127.0.0.1 for the loopback)
+    bool parseInterface(const std::string& interfaceAddress, in_addr& addr);
+
+    class Receiver
+    {
+    public:
+        static constexpr size_t BATCH = 64;                      // datagrams per recvmmsg
+        static constexpr size_t DATAGRAM_BYTES = 9216;           // jumbo frame, longer ones truncated (dropped)
+        static constexpr int RECEIVE_BUFFER_BYTES = 4 * 1024 * 1024; // bounded by net.core.rmem_max
+        static constexpr int BUSY_POLL_US = 50;
+        static constexpr int TIMEOUT_MS = 100;                   // receive() returns, e.g. to check a stop flag
+
+        Receiver();
+        ~Receiver();
+        Receiver(const Receiver&) = delete;
+        Receiver& operator=(const Receiver&) = delete;
+
+        // Joins <address> on the interface of <interfaceAddress>
+        bool open(const std::string& address, const std::string& interfaceAddress = "127.0.0.1");
+        void close();
+
+        // Datagrams received (at least one unless TIMEOUT_MS elapsed) split in messages passed to
+        // <onMessage(const char* data, size_t len)>, false once the feed ended or on error
+        template <typename OnMessage>
+        bool receive(OnMessage&& onMessage)
+        {
+            const auto nb = recvmmsg(fd_, msgs_.data(), BATCH, MSG_WAITFORONE, nullptr);
+            if (unlikely(nb < 0)) return EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno;
+            ++nbBatches_;
+            for (auto i = 0; i < nb; ++i)
+            {
+                const auto len = static_cast<size_t>(msgs_[i].msg_len);
+                if (unlikely(0UL == len))
+                {
+                    ended_ = true;
+                    return false;
+                }
+                ++nbDatagrams_;
+                if (unlikely(msgs_[i].msg_hdr.msg_flags & MSG_TRUNC))
+                {
+                    ++nbTruncated_;
+                    continue;
+                }
+                const char* data = &buffers_[i * DATAGRAM_BYTES];
+                for (auto start = 0UL; start < len; )
+                {
+                    const auto* end = static_cast<const char*>(memchr(data + start, '\n', len - start));
+                    const auto msgLen = (end != nullptr) ? static_cast<size_t>(end - (data + start)) : len - start;
+                    onMessage(data + start, msgLen);
+                    start += msgLen + 1;
+                }
+            }
+            return true;
+        }
+
+        bool ended() const { return ended_; }
+        bool busyPoll() const { return busyPoll_; }
+        unsigned long long nbDatagrams() const { return nbDatagrams_; }
+        unsigned long long nbBatches() const { return nbBatches_; }
+        unsigned long long nbTruncated() const { return nbTruncated_; }
+
+    private:
+        int fd_ = -1;
+        bool busyPoll_ = false;
+        bool ended_ = false;
+        std::vector<char> buffers_;
+        std::vector<iovec> iovecs_;
+        std::vector<mmsghdr> msgs_;
+        unsigned long long nbDatagrams_ = 0;
+        unsigned long long nbBatches_ = 0;
+        unsigned long long nbTruncated_ = 0;
+    };
+
+    class Sender
+    {
+    public:
+        static constexpr size_t DATAGRAM_BYTES = 1472; // Ethernet MTU without IPv4 and UDP headers
+
+        Sender() = default;
+        ~Sender();
+        Sender(const Sender&) = delete;
+        Sender& operator=(const Sender&) = delete;
+
+        // Sends to <address> from the interface of <interfaceAddress>, <ttl> 0 => this host only
+        bool open(const std::string& address, const std::string& interfaceAddress = "127.0.0.1", int ttl = 0);
+        void close();
+
+        bool send(const char* data, size_t len);
+        // Empty datagrams ending the feed (sent <nb> times: datagrams may be lost)
+        bool end(unsigned int nb = 3);
+
+    private:
+        int fd_ = -1;
+        sockaddr_in group_{};
+    };
+}
@@ -0,0 +1,32 @@
+#include "PerfRegions.h"
+
+#include <utils/StrStream.h>
+
+void PerfRegions::print(std::ostream& os, const char* thread) const
+{
+    static constexpr const char* names[] = { "parse", "A B", "A S", "M B", "M S", "X B", "X S", "T", "process" };
+    static_assert(sizeof(names)/sizeof(names[0]) == NB_REGIONS, "One name per region");
+    StrStream strstream;
+    strstream << "Hardware counters (mean per call) " << thread << ":\n";
+    for (auto r = 0U; r < NB_REGIONS; ++r)
+    {
+        const auto& stats = stats_[r];
+        if (0ULL == stats.count_) continue;
+        const auto count = static_cast<double>(stats.count_);
+        strstream << names[r] << " count [" << stats.count_ << "]";
+        for (auto e = 0U; e < PerfCounters::NB_EVENTS; ++e)
+        {
+            const auto event = static_cast<PerfCounters::Event>(e);
+            strstream << ' ' << PerfCounters::name(event) << " [";
+            if (counters_.isSupported(event)) strstream << static_cast<double>(stats.sums_[e]) / count;
+            else strstream << "n/a";
+            strstream << ']';
+        }
+        if (stats.sums_[PerfCounters::CYCLES])
+            strstream << " IPC [" << static_cast<double>(stats.sums_[PerfCounters::INSTRUCTIONS])
+                / static_cast<double>(stats.sums_[PerfCounters::CYCLES]) << ']';
+        strstream << '\n';
+    }
+    os.rdbuf()->sputn(strstream.c_str(), strstream.length());
+    os.flush();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "utils/Common.h"
+#include "utils/PerfCounters.h"
+
+#include <array>
+
+using namespace common;
+
+// Hardware counters aggregated per hot-path region (parse, each FeedHandler operation per
+// action/side, Reporter::processData). One instance per thread: opened, recorded and printed
+// by its thread. Regions are only instrumented when built with -DPERF_COUNTERS=ON
+// (PERF_REGION expands to nothing otherwise).
+
+class PerfRegions
+{
+public:
+    enum Region : unsigned int
+    {
+        PARSE,
+        ADD_BUY, ADD_SELL,
+        MODIFY_BUY, MODIFY_SELL,
+        CANCEL_BUY, CANCEL_SELL,
+        TRADE,
+        REPORTER_PROCESS,
+        NB_REGIONS
+    };
+    static FORCE_INLINE Region region(char action, char side)
+    {
+        const auto sell = ('S' == side) ? 1U : 0U;
+        switch(action)
+        {
+        case 'A': return static_cast<Region>(ADD_BUY + sell);
+        case 'M': return static_cast<Region>(MODIFY_BUY + sell);
+        case 'X': return static_cast<Region>(CANCEL_BUY + sell);
+        default: return TRADE;
+        }
+    }
+
+    // From the thread to measure
+    bool open() { return counters_.open(); }
+    const PerfCounters& counters() const { return counters_; }
+
+    FORCE_INLINE void record(Region region, const PerfCounters::Sample& start)
+    {
+        PerfCounters::Sample end;
+        counters_.read(end);
+        auto& stats = stats_[region];
+        ++stats.count_;
+        for (auto i = 0U; i < PerfCounters::NB_EVENTS; ++i) stats.sums_[i] += end[i] - start[i];
+    }
+
+    // Per region: count then mean per call of each event and instructions per cycle
+    void print(std::ostream& os, const char* thread) const;
+    void reset() { stats_ = {}; }
+
+private:
+    struct Stats
+    {
+        unsigned long long count_ = 0ULL;
+        PerfCounters::Sample sums_{};
+    };
+    PerfCounters counters_;
+    std::array<Stats, NB_REGIONS> stats_{};
+};
+
+class PerfScope
+{
+public:
+    FORCE_INLINE PerfScope(PerfRegions* regions, PerfRegions::Region region)
+        : regions_(regions), region_(region)
+    {
+        if (unlikely(regions_ != nullptr)) regions_->counters().read(start_);
+    }
+    FORCE_INLINE ~PerfScope()
+    {
+        if (unlikely(regions_ != nullptr)) regions_->record(region_, start_);
+    }
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfRegions* regions_;
+    PerfRegions::Region region_;
+    PerfCounters::Sample start_;
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+#ifdef PERF_COUNTERS
+# define PERF_REGION(regions, region) PerfScope PERF_CONCAT(perfScope, __LINE__)(regions, region)
+#else
+# define PERF_REGION(regions, region) do {} while (0)
+#endif
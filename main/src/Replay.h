@@ -0,0 +1,72 @@
+#pragma once
+
+#include "utils/Common.h"
+#include "utils/Tsc.h"
+#include "utils/WaitStrategy.h"
+
+#include <chrono>
+
+using namespace common;
+
+// Paced replay of a capture (feed thread): a message with an exchange timestamp is released once
+// the time since the first one, divided by the speed, has elapsed since the first release.
+// Waits are a `pause` loop on the TSC (no sleep: bursts of the capture are replayed as bursts,
+// late messages are released at once). Released timestamps are rebased on the realtime clock at
+// the first release, so the exchange latency (FeedHandler::setExchangeLatency) is measured from
+// the scheduled release. Messages without timestamp are released at once (and keep none).
+
+class Replay
+{
+public:
+    // <speed> multiple of the original speed (1 => original, 0 => as fast as possible)
+    explicit Replay(double speed)
+        : speed_(speed > 0.0 ? speed : 0.0)
+        , nsPerTick_(tsc::nsPerTick()) // calibrated out of the critical path
+    {
+    }
+    ~Replay() = default;
+    Replay(const Replay&) = delete;
+    Replay& operator=(const Replay&) = delete;
+
+    // Waits until the release of a message stamped <timestamp> (ns since epoch), returns it rebased
+    FORCE_INLINE unsigned long long release(unsigned long long timestamp)
+    {
+        if (unlikely(0ULL == timestamp)) return 0ULL;
+        if (unlikely(0ULL == firstTimestamp_)) start(timestamp);
+        if (unlikely(0.0 == speed_)) return rebase(timestamp);
+        const auto elapsedNs = this->elapsedNs(timestamp);
+        const auto releaseTsc = startTsc_ + static_cast<unsigned long long>(elapsedNs / nsPerTick_);
+        while (tsc::now() < releaseTsc) cpuRelax();
+        return startNs_ + static_cast<unsigned long long>(elapsedNs);
+    }
+    // Rebased <timestamp> without waiting (e.g. message released before and buffered)
+    FORCE_INLINE unsigned long long rebase(unsigned long long timestamp) const
+    {
+        if (unlikely(0ULL == timestamp || 0ULL == firstTimestamp_)) return timestamp;
+        // As fast as possible => released now
+        if (unlikely(0.0 == speed_)) return startNs_ + static_cast<unsigned long long>(static_cast<double>(tsc::now() - startTsc_) * nsPerTick_);
+        return startNs_ + static_cast<unsigned long long>(elapsedNs(timestamp));
+    }
+
+    double speed() const { return speed_; }
+
+private:
+    void start(unsigned long long timestamp)
+    {
+        firstTimestamp_ = timestamp;
+        startTsc_ = tsc::now();
+        startNs_ = static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+    // Replay time of <timestamp> since the first release (timestamps going backward => released at once)
+    FORCE_INLINE double elapsedNs(unsigned long long timestamp) const
+    {
+        return timestamp > firstTimestamp_ ? static_cast<double>(timestamp - firstTimestamp_) / speed_ : 0.0;
+    }
+
+    const double speed_;
+    const double nsPerTick_;
+    unsigned long long firstTimestamp_ = 0;
+    unsigned long long startTsc_ = 0;
+    unsigned long long startNs_ = 0;
+};
@@ -3,96 +3,220 @@
 #include <utils/Parser.h>
 #include <utils/StrStream.h>
 
+#include <atomic>
+#include <cmath>
+
 bool Reporter::processData(FeedHandler::Data&& data)
 {
+    PERF_REGION(perf_, PerfRegions::REPORTER_PROCESS);
+    if (unlikely(latency_ != nullptr && data.tsc_)) latency_->record(data.action_, data.side_, tsc::now() - data.tsc_);
     switch(data.action_)
     {
     case static_cast<char>(Parser::Action::ADD):
-        switch(data.side_)
-        {
-        case static_cast<char>(Parser::Side::BUY):
-            bids_.insert(bids_.begin()+data.pos_, std::move(data.limit_));
-            break;
-        case static_cast<char>(Parser::Side::SELL):
-            asks_.insert(asks_.begin()+data.pos_, std::move(data.limit_));
-            break;
-        default:
-            break;
-        }
-        break;
     case static_cast<char>(Parser::Action::CANCEL):
-        switch(data.side_)
-        {
-        case static_cast<char>(Parser::Side::BUY):
-            bids_.erase(bids_.begin()+data.pos_);
-            break;
-        case static_cast<char>(Parser::Side::SELL):
-            asks_.erase(asks_.begin()+data.pos_);
-            break;
-        default:
-            break;
-        }
-        break;
     case static_cast<char>(Parser::Action::MODIFY):
-        switch(data.side_)
-        {
-        case static_cast<char>(Parser::Side::BUY):
-            bids_[data.pos_] = std::move(data.limit_);
-            break;
-        case static_cast<char>(Parser::Side::SELL):
-            asks_[data.pos_] = std::move(data.limit_);
-            break;
-        default:
-            break;
-        }
         break;
     case static_cast<char>(Parser::Action::TRADE):
+        if (unlikely(bars_ != nullptr)) bars_->onTrade(data.limit_, data.timestamp_);
         treatTrade(std::move(data.limit_));
         break;
     default: // would behave as a false end reached
     case 0: // only when no more data and dontSpin is true => stop at the end
         return false;
     }
+    // Conflated updates may be received out of order => keep only the most recent top of book
+    if (likely(data.bookVersion_ > bookVersion_))
+    {
+        bookVersion_ = data.bookVersion_;
+        bestBid_ = std::move(data.bestBid_);
+        bestAsk_ = std::move(data.bestAsk_);
+        signals_ = data.signals_;
+    }
+    if (unlikely(bars_ != nullptr)) bars_->onMessage();
+    return true;
+}
+
+void Reporter::setPacing(const Pacing& pacing)
+{
+    flush();
+    pacing_ = pacing;
+    if (unlikely(0ULL == pacing_.every_)) pacing_.every_ = 1ULL;
+    // Stay in StrStream overflow buffer
+    if (unlikely(pacing_.flushSize_ > StrStream::CAPACITY_MAX - 128)) pacing_.flushSize_ = StrStream::CAPACITY_MAX - 128;
+}
+
+bool Reporter::sampleMidQuote(Price midQuote)
+{
+    switch(pacing_.mode_)
+    {
+    case Pacing::Mode::EVERY_EVENT:
+        return true;
+    case Pacing::Mode::EVERY_N:
+        return 0ULL == nbEvents_ % pacing_.every_;
+    case Pacing::Mode::EVERY_US:
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastMidQuoteTime_ < std::chrono::microseconds(pacing_.every_)) return false;
+        lastMidQuoteTime_ = now;
+        return true;
+    }
+    case Pacing::Mode::ON_CHANGE:
+        if (midQuote == lastMidQuote_) return false;
+        lastMidQuote_ = midQuote;
+        return true;
+    }
     return true;
 }
 
 void Reporter::printMidQuotesAndTrades(std::ostream& os, Errors& errors)
 {
-    StrStream strstream;
-    if (unlikely(bids_.begin() == bids_.end() || asks_.begin() == asks_.end()))
+    if (unlikely(&os != pendingOs_))
     {
-        strstream << "NAN" << '\n';
+        flush();
+        pendingOs_ = &os;
+    }
+    const auto nbPending = pending_.length();
+    formatMidQuoteOrTrade(errors);
+    if (pending_.length() == nbPending) return;
+    flushIfDue(nbPending);
+}
+
+size_t Reporter::processBatch(FeedHandler::Data* datas, size_t nb, std::ostream& os, Errors& errors)
+{
+    if (unlikely(&os != pendingOs_))
+    {
+        flush();
+        pendingOs_ = &os;
+    }
+    auto nbPending = pending_.length();
+    for (auto i = 0UL; i < nb; ++i)
+    {
+        if (unlikely(!processData(std::move(datas[i]))))
+        {
+            nb = i;
+            break;
+        }
+        // Stay in StrStream overflow buffer
+        if (unlikely(pending_.length() > StrStream::CAPACITY_MAX - 128))
+        {
+            flush();
+            nbPending = 0UL;
+        }
+        formatMidQuoteOrTrade(errors);
+    }
+    if (pending_.length() > nbPending) flushIfDue(nbPending);
+    return nb;
+}
+
+void Reporter::formatMidQuoteOrTrade(Errors& errors)
+{
+    ++nbEvents_;
+    if (unlikely(0ULL == getQty(bestBid_) || 0ULL == getQty(bestAsk_)))
+    {
+        if (sampleMidQuote(-1.0)) pending_ << "NAN" << '\n';
     }
     else if (receivedNewTrade_)
     {
-        strstream << getQty(currentTrade_) << '@' << getPrice(currentTrade_) << '\n';
+        pending_ << getQty(currentTrade_) << '@' << getPrice(currentTrade_) << '\n';
         receivedNewTrade_ = false;
         detectCross_ = false;
     }
-    else if (unlikely(getPrice(*bids_.begin()) >= getPrice(*asks_.begin())))
+    else if (unlikely(getPrice(bestBid_) >= getPrice(bestAsk_)))
     {
         if (likely(!detectCross_)) detectCross_ = true;
         else
         {
-            strstream << "Cross BID (" << getPrice(*bids_.begin()) <<  ")/ASK(" << getPrice(*asks_.begin()) << ')' << '\n';
+            pending_ << "Cross BID (" << getPrice(bestBid_) <<  ")/ASK(" << getPrice(bestAsk_) << ')' << '\n';
             ++errors.bestBidEqualOrUpperThanBestAsk;
         }
     }
     else
     {
-        Price midQuote = (getPrice(*bids_.begin())+getPrice(*asks_.begin()))/2;
-        strstream << midQuote << '\n';
+        Price midQuote = (getPrice(bestBid_)+getPrice(bestAsk_))/2;
+        if (sampleMidQuote(midQuote))
+        {
+            pending_ << midQuote;
+            if (unlikely(printSignals_))
+            {
+                formatSignal(signals_.microprice_);
+                formatSignal(signals_.imbalance_);
+                formatSignal(signals_.spread_);
+                formatSignal(signals_.vwap_);
+            }
+            pending_ << '\n';
+        }
     }
-    os.rdbuf()->sputn(strstream.c_str(), strstream.length());
-    os.flush();
 }
 
-void Reporter::printCurrentOrderBook(std::ostream& os) const
+// StrStream formats unsigned floats only
+void Reporter::formatSignal(double value)
+{
+    pending_ << ' ';
+    if (unlikely(std::isnan(value))) pending_ << "NAN";
+    else if (value < 0.0) pending_ << '-' << -value;
+    else pending_ << value;
+}
+
+// New lines were added to <nbPending> bytes
+void Reporter::flushIfDue(size_t nbPending)
 {
+    if (pending_.length() >= pacing_.flushSize_)
+    {
+        flush();
+    }
+    else if (pacing_.flushUs_)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (0UL == nbPending) firstPendingTime_ = now;
+        else if (now - firstPendingTime_ >= std::chrono::microseconds(pacing_.flushUs_)) flush();
+    }
+}
+
+bool Reporter::flushIfLate()
+{
+    if (0UL == pending_.length() || 0ULL == pacing_.flushUs_) return false;
+    if (std::chrono::steady_clock::now() - firstPendingTime_ < std::chrono::microseconds(pacing_.flushUs_)) return true;
+    flush();
+    return false;
+}
+
+void Reporter::flush()
+{
+    if (pending_.length() && pendingOs_)
+    {
+        pendingOs_->rdbuf()->sputn(pending_.c_str(), pending_.length());
+        pendingOs_->flush();
+    }
+    pending_.clear();
+}
+
+bool Reporter::snapshotBook()
+{
+    for (auto round = 0U; round < MAX_SNAPSHOT_ROUNDS; ++round)
+    {
+        const auto sequence = bookSequence_.load(std::memory_order_acquire);
+        if (likely(!(sequence & 1ULL)) && bids_.snapshot(bidsSnapshot_) && asks_.snapshot(asksSnapshot_))
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (likely(bookSequence_.load(std::memory_order_relaxed) == sequence)) return true;
+        }
+        cpuRelax();
+    }
+    return false;
+}
+
+void Reporter::printCurrentOrderBook(std::ostream& os)
+{
+    flush();
+    if (unlikely(!snapshotBook()))
+    {
+        ++nbSkippedBooks_;
+        return;
+    }
     StrStream strstream;
     auto cap = strstream.capacity() - 128;
-    const auto nbBids = bids_.size();
-    const auto nbAsks = asks_.size();
+    const auto nbBids = bidsSnapshot_.size();
+    const auto nbAsks = asksSnapshot_.size();
     os << "Full Bids/Asks:\n";
     auto i = 0U;
     while (1)
@@ -100,14 +224,14 @@ void Reporter::printCurrentOrderBook(std::ostream& os) const
         StrStream strstream_tmp;
         if (i < nbBids)
         {
-            Limit bid = bids_[i];
+            Limit bid = bidsSnapshot_[i];
             strstream_tmp << i; 
             strstream_tmp.append(6, ' ');
             strstream_tmp << ": " << getQty(bid) << " @ " << getPrice(bid);
             strstream_tmp.append(40, ' ');
             if (i < nbAsks)
             {
-                Limit ask = asks_[i];
+                Limit ask = asksSnapshot_[i];
                 strstream_tmp << getQty(ask) << " @ " << getPrice(ask) << '\n';
             }
             else
@@ -123,7 +247,7 @@ void Reporter::printCurrentOrderBook(std::ostream& os) const
             strstream_tmp.append(40, ' ');
             if (i < nbAsks)
             {
-                Limit ask = asks_[i];
+                Limit ask = asksSnapshot_[i];
                 strstream_tmp << getQty(ask) << " @ " << getPrice(ask) << '\n';
             }
             else
@@ -148,6 +272,7 @@ void Reporter::printCurrentOrderBook(std::ostream& os) const
 
 void Reporter::printErrors(std::ostream& os, Errors& errors, const int verbose)
 {
+    flush();
     StrStream strstream;    
     strstream << "Summary:";
     
@@ -265,6 +390,24 @@ void Reporter::printErrors(std::ostream& os, Errors& errors, const int verbose)
         {
             strstream << "\n [" << errors.bestBidEqualOrUpperThanBestAsk << "] best bid equal or upper than best ask";
         }
+        
+        // Sequencing
+        if (unlikely(errors.sequenceGaps))
+        {
+            strstream << "\n [" << errors.sequenceGaps << "] sequence gaps";
+        }
+        if (unlikely(errors.duplicateSequences))
+        {
+            strstream << "\n [" << errors.duplicateSequences << "] duplicate sequences";
+        }
+        if (unlikely(errors.outOfOrderSequences))
+        {
+            strstream << "\n [" << errors.outOfOrderSequences << "] out of order sequences";
+        }
+        if (unlikely(errors.lostSequences))
+        {
+            strstream << "\n [" << errors.lostSequences << "] lost sequences (gap abandoned)";
+        }
     }        
     else
     {
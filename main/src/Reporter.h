@@ -1,27 +1,102 @@
 #pragma once
 
 #include "FeedHandler.h"
+#include "Bars.h"
+#include <utils/StrStream.h>
+
+#include <chrono>
+#include <limits>
 
 class Reporter
 {    
 public:
-    Reporter() = default;
+    Reporter(const FeedHandler& feed) : bids_(feed.getBids()), asks_(feed.getAsks()), bookSequence_(feed.bookSequence()) {}
     ~Reporter() = default;
     Reporter(const Reporter&) = delete;
     Reporter& operator=(const Reporter&) = delete;
     
+    // Mid-quotes output pacing (trades and crosses are never skipped)
+    struct Pacing
+    {
+        enum class Mode : char
+        {
+            EVERY_EVENT,
+            EVERY_N,    // one mid-quote every every_ events
+            EVERY_US,   // at most one mid-quote every every_ microseconds
+            ON_CHANGE   // only when mid-quote changed
+        };
+        Mode mode_ = Mode::EVERY_EVENT;
+        unsigned long long every_ = 1ULL;
+        size_t flushSize_ = 0UL;            // buffered bytes before writing them (0 => written each line)
+        unsigned long long flushUs_ = 0ULL; // max microseconds a line stays buffered, see flushIfLate() (0 => only size)
+    };
+    void setPacing(const Pacing& pacing);
+    
+    // Record from message received to its update consumed
+    void setLatency(Latency* latency) { latency_ = latency; }
+    // Hardware counters around processData (only with -DPERF_COUNTERS=ON)
+    void setPerfRegions(PerfRegions* perf) { perf_ = perf; }
+    // Mid-quote lines followed by the signals of their update: microprice, imbalance, spread and VWAP
+    // (see FeedHandler::setAnalytics)
+    void setPrintSignals(bool printSignals) { printSignals_ = printSignals; }
+    // OHLCV bars fed with each trade (and its exchange timestamp) and each message
+    void setBars(Bars* bars) { bars_ = bars; }
+    
     bool processData(FeedHandler::Data&& data);
+    // Updates drained at once: each one applied and its line formatted, then pending lines
+    // written once (pacing applied to the whole batch). Returns the number of updates processed
+    // (fewer than <nb> => end reached)
+    size_t processBatch(FeedHandler::Data* datas, size_t nb, std::ostream& os, Errors& errors);
 
-    void printCurrentOrderBook(std::ostream& os) const;
+    // All print functions first write buffered mid-quotes to keep output ordered
+    // The book is printed once both sides are snapshotted on the same book state, otherwise (still
+    // changing after MAX_SNAPSHOT_ROUNDS) it is skipped and counted
+    void printCurrentOrderBook(std::ostream& os);
+    unsigned long long nbSkippedBooks() const { return nbSkippedBooks_; }
     void printMidQuotesAndTrades(std::ostream& os, Errors& errors);
     void printErrors(std::ostream& os, Errors& errors, const int verbose = 0);
+    void flush();
+    // Lines buffered longer than flushUs_ written, to be called while waiting for updates (an idle
+    // feed formats no line to check it). Returns true while lines are still pending until then
+    bool flushIfLate();
   
 protected:
+    static constexpr unsigned int MAX_SNAPSHOT_ROUNDS = 1024;
+    // Bids and asks snapshots of one book state (see FeedHandler::bookSequence)
+    bool snapshotBook();
     bool treatTrade(Trade&& newTrade);
+    bool sampleMidQuote(Price midQuote);
+    void formatMidQuoteOrTrade(Errors& errors);
+    void flushIfDue(size_t nbPending);
+    void formatSignal(double value);
 
-    std::deque<Limit> bids_, asks_;
+    // Book owned by the FeedHandler thread: full depth only read through snapshots
+    const FeedHandler::Levels& bids_;
+    const FeedHandler::Levels& asks_;
+    const std::atomic<unsigned long long>& bookSequence_;
+    FeedHandler::Levels::Snapshot bidsSnapshot_, asksSnapshot_;
+    unsigned long long nbSkippedBooks_ = 0ULL;
+    
+    // Top of book carried by the most recent update
+    unsigned long long bookVersion_ = 0;
+    Limit bestBid_{0ULL, 0.0};
+    Limit bestAsk_{0ULL, 0.0};
+    Analytics::Signals signals_;
+    bool printSignals_ = false;
+    
     Trade currentTrade_{0ULL, 0.0};
     bool receivedNewTrade_ = false;
     bool detectCross_ = false;
+    
+    Pacing pacing_;
+    unsigned long long nbEvents_ = 0ULL;
+    Price lastMidQuote_ = std::numeric_limits<Price>::quiet_NaN(); // never equal => first one printed (NAN line is -1.0)
+    std::chrono::steady_clock::time_point lastMidQuoteTime_, firstPendingTime_;
+    StrStream pending_;
+    std::ostream* pendingOs_ = nullptr;
+    
+    Latency* latency_ = nullptr;
+    PerfRegions* perf_ = nullptr;
+    Bars* bars_ = nullptr;
 };
 
@@ -0,0 +1,128 @@
+#include "Stats.h"
+
+#include <cstddef>
+#include <ctime>
+#include <new>
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace stats
+{
+    const std::array<ErrorField, NB_ERRORS> errorFields{{
+        {"commented lines", &Errors::commentedLines},
+        {"blank lines", &Errors::blankLines},
+        {"corrupted messages", &Errors::corruptedMessages},
+        {"incomplete messages", &Errors::IncompleteMessages},
+        {"wrong actions", &Errors::wrongActions},
+        {"wrong sides", &Errors::wrongSides},
+        {"negative orderIds", &Errors::negativeOrderIds},
+        {"negative quantities", &Errors::negativeQuantities},
+        {"negative prices", &Errors::negativePrices},
+        {"missing actions", &Errors::missingActions},
+        {"missing orderIds", &Errors::missingOrderIds},
+        {"missing sides", &Errors::missingSides},
+        {"missing quantities", &Errors::missingQuantities},
+        {"missing prices", &Errors::missingPrices},
+        {"zero orderIds", &Errors::zeroOrderIds},
+        {"zero quantities", &Errors::zeroQuantities},
+        {"zero prices", &Errors::zeroPrices},
+        {"out of bounds orderIds", &Errors::outOfBoundsOrderIds},
+        {"out of bounds quantities", &Errors::outOfBoundsQuantities},
+        {"out of bounds prices", &Errors::outOfBoundsPrices},
+        {"duplicate orderIds", &Errors::duplicateOrderIds},
+        {"modifies with unknown orderId", &Errors::modifiesWithUnknownOrderId},
+        {"modifies not matched price", &Errors::modifiesNotMatchedPrice},
+        {"cancels with unknown orderId", &Errors::cancelsWithUnknownOrderId},
+        {"cancels not matched qty or price", &Errors::cancelsNotMatchedQtyOrPrice},
+        {"best bid equal or upper than best ask", &Errors::bestBidEqualOrUpperThanBestAsk},
+        {"sequence gaps", &Errors::sequenceGaps},
+        {"duplicate sequences", &Errors::duplicateSequences},
+        {"out of order sequences", &Errors::outOfOrderSequences},
+        {"lost sequences", &Errors::lostSequences},
+        {"modifies limit qty too low (critical)", &Errors::modifiesLimitQtyTooLow},
+        {"modifies limit not found (critical)", &Errors::modifiesLimitNotFound},
+        {"cancels limit qty too low (critical)", &Errors::cancelsLimitQtyTooLow},
+        {"cancels limit not found (critical)", &Errors::cancelsLimitNotFound}
+    }};
+    // Errors is padded to whole cache lines: check the last counter too
+    static_assert(offsetof(Errors, cancelsLimitNotFound) == (NB_ERRORS - 1) * sizeof(unsigned long long)
+        && sizeof(Errors) == (NB_ERRORS * sizeof(unsigned long long) + cacheLinesSze - 1) / cacheLinesSze * cacheLinesSze,
+        "New Errors counter => add it to errorFields");
+
+    unsigned long long realtimeNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return static_cast<unsigned long long>(ts.tv_sec) * 1'000'000'000ULL + static_cast<unsigned long long>(ts.tv_nsec);
+    }
+
+    Publisher::~Publisher()
+    {
+        if (block_ != nullptr)
+        {
+            munmap(block_, sizeof(Block));
+            shm_unlink(name_.c_str());
+        }
+    }
+
+    bool Publisher::open(const std::string& name)
+    {
+        name_ = ('/' == name[0]) ? name : '/' + name;
+        const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0644);
+        if (-1 == fd) return false;
+        if (-1 == ftruncate(fd, sizeof(Block)))
+        {
+            close(fd);
+            return false;
+        }
+        void* memory = mmap(nullptr, sizeof(Block), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (MAP_FAILED == memory) return false;
+        block_ = new (memory) Block();
+        block_->pid_ = getpid();
+        block_->startNs_ = realtimeNs();
+        block_->nsPerTick_ = tsc::nsPerTick();
+        block_->magic_.store(Block::MAGIC, std::memory_order_release);
+        return true;
+    }
+
+    const Block* attach(const std::string& name)
+    {
+        const auto shmName = ('/' == name[0]) ? name : '/' + name;
+        const int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+        if (-1 == fd) return nullptr;
+        void* memory = mmap(nullptr, sizeof(Block), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (MAP_FAILED == memory) return nullptr;
+        const auto* block = static_cast<const Block*>(memory);
+        if (block->magic_.load(std::memory_order_acquire) != Block::MAGIC || block->version_ != Block::VERSION)
+        {
+            detach(block);
+            return nullptr;
+        }
+        return block;
+    }
+
+    void detach(const Block* block)
+    {
+        munmap(const_cast<Block*>(block), sizeof(Block));
+    }
+
+    LatencySummary summarize(const Latency& latency, double nsPerTick)
+    {
+        Latency::Hist all;
+        for (auto action : { 'A', 'M', 'X', 'T' })
+            for (auto side : { 'B', 'S' }) all += latency.get(action, side);
+        auto ns = [nsPerTick](unsigned long long ticks) { return static_cast<unsigned long long>(static_cast<double>(ticks) * nsPerTick + 0.5); };
+        LatencySummary summary;
+        summary.count_ = all.count();
+        summary.p50_ = ns(all.percentile(50.0));
+        summary.p90_ = ns(all.percentile(90.0));
+        summary.p99_ = ns(all.percentile(99.0));
+        summary.p999_ = ns(all.percentile(99.9));
+        summary.max_ = ns(all.max());
+        return summary;
+    }
+}
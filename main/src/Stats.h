@@ -0,0 +1,123 @@
+#pragma once
+
+#include "utils/Common.h"
+#include "Latency.h"
+
+#include <array>
+#include <atomic>
+#include <string>
+
+using namespace common;
+
+class Latency;
+
+// Runtime statistics in a shared memory segment, polled by fhstat while the process runs.
+// Each section has a single writer thread and starts on its own cache line.
+// Counters (one per action, the published version and the book depth of the feed, the consumed
+// updates of the reporter) are relaxed atomic loads/stores: no locked instruction, no fence.
+// Errors and latency histograms are NOT atomic: they are the plain fields each thread records into,
+// placed in the segment to avoid any copy. fhstat reads them best effort as raw memory, without
+// synchronization with their writer: values may be stale (or cached in a register by the writer for
+// a while) and a histogram may be a few records ahead or behind its count. Each field is an aligned
+// 8 bytes word, so a value read is one the writer stored. Only counters are exact when read.
+
+namespace stats
+{
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Counters shared between processes must be lock free");
+
+    struct Counter
+    {
+        // Single writer
+        FORCE_INLINE void inc() { value_.store(value_.load(std::memory_order_relaxed) + 1ULL, std::memory_order_relaxed); }
+        FORCE_INLINE void add(unsigned long long value) { value_.store(value_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+        FORCE_INLINE void set(unsigned long long value) { value_.store(value, std::memory_order_relaxed); }
+        unsigned long long get() const { return value_.load(std::memory_order_relaxed); }
+    private:
+        std::atomic<unsigned long long> value_{0ULL};
+    };
+
+    struct ErrorField
+    {
+        const char* name_;
+        unsigned long long Errors::* field_;
+    };
+    static constexpr size_t NB_ERRORS = 34;
+    extern const std::array<ErrorField, NB_ERRORS> errorFields; // every Errors counter
+
+    struct FeedStats
+    {
+        enum Message : unsigned int { ADD, MODIFY, CANCEL, TRADE, NB_MESSAGES };
+        static FORCE_INLINE Message message(char action)
+        {
+            switch(action)
+            {
+            case 'A': return ADD;
+            case 'M': return MODIFY;
+            case 'X': return CANCEL;
+            default: return TRADE;
+            }
+        }
+
+        std::array<Counter, NB_MESSAGES> messages_;    // applied, per action
+        Counter published_;                             // updates pushed to the reporter
+        Counter bidLevels_, askLevels_;
+        // Plain fields recorded in place by the feed thread (read best effort by fhstat)
+        Errors errors_;
+        Latency latency_;                               // until book applied (with -l)
+    };
+
+    struct ReporterStats
+    {
+        Counter consumed_;                              // updates, queue depth = published - consumed
+        // Plain fields recorded in place by the reporter thread (read best effort by fhstat)
+        Errors errors_;
+        Latency latency_;                               // until consumed (with -l)
+    };
+
+    struct Block
+    {
+        static constexpr unsigned int MAGIC = 0x46485354; // FHST
+        static constexpr unsigned int VERSION = 3U;
+
+        std::atomic<unsigned int> magic_{0U};           // set once initialized
+        unsigned int version_ = VERSION;
+        int pid_ = 0;
+        unsigned long long startNs_ = 0ULL;
+        double nsPerTick_ = 0.0;                        // latencies are in TSC ticks
+        alignas(cacheLinesSze) FeedStats feed_;
+        alignas(cacheLinesSze) ReporterStats reporter_;
+    };
+
+    // Segment owner (the FeedHandler process), unlinked when destroyed
+    class Publisher
+    {
+    public:
+        static constexpr const char* DEFAULT_NAME = "/FeedHandler";
+
+        Publisher() = default;
+        ~Publisher();
+        Publisher(const Publisher&) = delete;
+        Publisher& operator=(const Publisher&) = delete;
+
+        // Calibrates the TSC (out of the critical path)
+        bool open(const std::string& name);
+        Block* block() const { return block_; }
+
+    private:
+        std::string name_;
+        Block* block_ = nullptr;
+    };
+
+    // Read only mapping (fhstat)
+    const Block* attach(const std::string& name);
+    void detach(const Block* block);
+
+    // Reader side (fhstat): all actions and sides merged, in ns
+    struct LatencySummary
+    {
+        unsigned long long count_ = 0ULL, p50_ = 0ULL, p90_ = 0ULL, p99_ = 0ULL, p999_ = 0ULL, max_ = 0ULL;
+    };
+    LatencySummary summarize(const Latency& latency, double nsPerTick);
+
+    unsigned long long realtimeNs();
+}
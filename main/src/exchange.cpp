@@ -0,0 +1,78 @@
+#include "Exchange.h"
+#include "Reporter.h"
+
+#include <utils/Tuning.h>
+
+#include <csignal>
+#include <cstring>
+#include <chrono>
+
+static exchange::Server* server = nullptr;
+
+// Exchange simulator: order entry over a local socket, matched by a FeedHandler (see Exchange.h)
+int main(int argc, char **argv)
+{
+    if (argc < 2 || !strcmp(argv[1], "-h"))
+    {
+        std::cerr << "Usage:\t" << argv[0] << " <address> [-v <verbose>] [-a <cpu>] [-k] [-r <orders>] [-H]" << std::endl;
+        std::cerr << "\t<address> : Unix domain socket path (e.g. /tmp/exchange.sock) or <host>:<port> on TCP (e.g. 127.0.0.1:9000)" << std::endl;
+        std::cerr << "\t-a : pin the exchange thread on <cpu>" << std::endl;
+        std::cerr << "\t-k : lock memory (mlockall current and future pages)" << std::endl;
+        std::cerr << "\t-r : arena planned for <orders> resting orders per side, prefaulted" << std::endl;
+        std::cerr << "\t-H : arena on huge pages (explicit when reserved, transparent otherwise)" << std::endl;
+        return -1;
+    }
+    const std::string address(argv[1]);
+    auto verbose = 0;
+    auto cpu = -1;
+    auto lockMemory = false;
+    auto prefaultOrders = 0UL;
+    auto hugePages = false;
+    for (auto i = 2; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-v") && i+1 < argc) verbose = std::stoi(argv[++i]);
+        else if (!strcmp(argv[i], "-a") && i+1 < argc) cpu = std::stoi(argv[++i]);
+        else if (!strcmp(argv[i], "-k")) lockMemory = true;
+        else if (!strcmp(argv[i], "-r") && i+1 < argc) prefaultOrders = std::stoul(argv[++i]);
+        else if (!strcmp(argv[i], "-H")) hugePages = true;
+    }
+    if (cpu >= 0 && !tuning::pinThread(cpu)) std::cerr << "Unable to pin the exchange thread on cpu [" << cpu << "]" << std::endl;
+    if (lockMemory && !tuning::lockMemory()) std::cerr << "Unable to lock memory (see ulimit -l or CAP_IPC_LOCK)" << std::endl;
+
+    Arena arena;
+    if (prefaultOrders > 0 && !arena.reserve(FeedHandler::arenaBytes(prefaultOrders), hugePages))
+    {
+        std::cerr << "Unable to reserve the orders arena" << std::endl;
+    }
+    exchange::Server exchangeServer(prefaultOrders > 0 ? &arena : nullptr);
+    if (prefaultOrders > 0)
+    {
+        exchangeServer.reserve(prefaultOrders);
+        tuning::prefaultStack();
+    }
+    if (!exchangeServer.listen(address)) return -1;
+    server = &exchangeServer;
+    signal(SIGINT, [](int) { server->stop(); });
+    signal(SIGTERM, [](int) { server->stop(); });
+    std::cout << "Exchange listening on [" << address << "] (Ctrl-C to stop)" << std::endl;
+
+    using std::chrono::high_resolution_clock;
+    const auto start = high_resolution_clock::now();
+    exchangeServer.run(verbose);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+    const auto& counters = exchangeServer.counters();
+    std::cout << "Clients [" << counters.nbClients_ << "] orders [" << counters.nbOrders_ << "] rejects ["
+        << counters.nbRejects_ << "] fills [" << counters.nbExecutions_ << "] book updates ["
+        << counters.nbBookUpdates_ << "] in [" << elapsed / 1'000'000 << "] sec" << std::endl;
+    if (verbose > 0 && prefaultOrders > 0)
+    {
+        std::cout << "Arena orders: [" << arena.used() << "] of [" << arena.capacity() << "] bytes used"
+            << (arena.hugePages() ? " (huge pages)" : "") << ", [" << arena.nbFallbacks() << "] heap allocations" << std::endl;
+    }
+    Reporter reporter(exchangeServer.feed());
+    reporter.printCurrentOrderBook(std::cout);
+    Errors errors = exchangeServer.errors();
+    reporter.printErrors(std::cout, errors, verbose);
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "Multicast.h"
+
+#include <utils/Tsc.h>
+#include <utils/WaitStrategy.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+
+// Replay a capture (text feed) onto UDP multicast, read by FeedHandler.out udp:<group>:<port>
+int main(int argc, char **argv)
+{
+    if (argc < 3 || !strcmp(argv[1], "-h"))
+    {
+        std::cerr << "Usage:\t" << argv[0] << " <file> <group>:<port> [-r <rate>] [-n <messages>] [-b <bytes>] [-I <interface>] [-t <ttl>] [-v <verbose>]" << std::endl;
+        std::cerr << "\t<group>:<port> : IPv4 multicast group (e.g. 239.255.0.1:30001)" << std::endl;
+        std::cerr << "\t-r : <rate> messages per second, paced per datagram (default 0 => as fast as possible)" << std::endl;
+        std::cerr << "\t-n : up to <messages> per datagram (default 1)" << std::endl;
+        std::cerr << "\t-b : up to <bytes> per datagram (default " << multicast::Sender::DATAGRAM_BYTES << ", a longer message is sent alone)" << std::endl;
+        std::cerr << "\t-I : sent from the interface of this address (default 127.0.0.1, loopback)" << std::endl;
+        std::cerr << "\t-t : multicast <ttl> (default 0 => this host only)" << std::endl;
+        return -1;
+    }
+    const std::string filename(argv[1]);
+    const std::string address(argv[2]);
+    auto rate = 0.0;
+    auto messagesPerDatagram = 1UL;
+    auto datagramBytes = multicast::Sender::DATAGRAM_BYTES;
+    std::string interfaceAddress("127.0.0.1");
+    auto ttl = 0;
+    auto verbose = 0;
+    for (auto i = 3; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-r") && i+1 < argc) rate = std::max(0.0, std::stod(argv[++i]));
+        else if (!strcmp(argv[i], "-n") && i+1 < argc) messagesPerDatagram = std::max(1UL, std::stoul(argv[++i]));
+        else if (!strcmp(argv[i], "-b") && i+1 < argc) datagramBytes = std::max(1UL, std::stoul(argv[++i]));
+        else if (!strcmp(argv[i], "-I") && i+1 < argc) interfaceAddress = argv[++i];
+        else if (!strcmp(argv[i], "-t") && i+1 < argc) ttl = std::stoi(argv[++i]);
+        else if (!strcmp(argv[i], "-v") && i+1 < argc) verbose = std::stoi(argv[++i]);
+    }
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Expected a file (see usage) or [" << filename << "] not readable!" << std::endl;
+        return -1;
+    }
+    const std::string capture((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    multicast::Sender sender;
+    if (!sender.open(address, interfaceAddress, ttl)) return -1;
+
+    // Datagram <n> released once <messages before it> / rate elapsed (TSC busy wait)
+    const auto ticksPerMessage = rate > 0.0 ? 1e9 / rate / tsc::nsPerTick() : 0.0;
+    std::string datagram;
+    datagram.reserve(datagramBytes);
+    auto nbMessages = 0UL, nbInDatagram = 0UL, nbDatagrams = 0UL, nbErrors = 0UL;
+    const auto startTsc = tsc::now();
+    auto flush = [&]()
+    {
+        if (0UL == nbInDatagram) return;
+        if (rate > 0.0)
+        {
+            const auto releaseTsc = startTsc + static_cast<unsigned long long>(static_cast<double>(nbMessages - nbInDatagram) * ticksPerMessage);
+            while (tsc::now() < releaseTsc) cpuRelax();
+        }
+        if (unlikely(!sender.send(datagram.data(), datagram.size())))
+        {
+            if (verbose > 0) std::cerr << "Unable to send a datagram of [" << datagram.size() << "] bytes: " << strerror(errno) << std::endl;
+            ++nbErrors;
+        }
+        ++nbDatagrams;
+        datagram.clear();
+        nbInDatagram = 0UL;
+    };
+
+    using std::chrono::high_resolution_clock;
+    const auto start = high_resolution_clock::now();
+    for (auto begin = 0UL; begin < capture.size(); )
+    {
+        auto end = capture.find('\n', begin);
+        if (end == std::string::npos) end = capture.size();
+        const auto len = end - begin;
+        // Not a message (an empty datagram ends the feed)
+        if (0UL == len)
+        {
+            begin = end + 1;
+            continue;
+        }
+        // Whole messages only
+        if (nbInDatagram && datagram.size() + 1 + len > datagramBytes) flush();
+        if (nbInDatagram) datagram += '\n';
+        datagram.append(capture, begin, len);
+        ++nbInDatagram;
+        ++nbMessages;
+        if (nbInDatagram == messagesPerDatagram) flush();
+        begin = end + 1;
+    }
+    flush();
+    sender.end();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - start).count();
+
+    std::cout << "Published [" << nbMessages << "] messages in [" << nbDatagrams << "] datagrams to [" << address
+        << "] in [" << elapsed << "] usec";
+    if (nbErrors) std::cout << ", [" << nbErrors << "] not sent";
+    std::cout << std::endl;
+    return nbErrors ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+#include "Stats.h"
+
+#include <utils/StrStream.h>
+
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <thread>
+#include <chrono>
+
+// Poll the statistics published by a running FeedHandler.out (option -m <name>)
+int main(int argc, char **argv)
+{
+    std::string name(stats::Publisher::DEFAULT_NAME);
+    auto intervalMs = 1'000UL;
+    auto count = 0UL; // 0 => until the segment disappears
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-i") && i+1 < argc) intervalMs = std::max(1UL, std::stoul(argv[++i]));
+        else if (!strcmp(argv[i], "-n") && i+1 < argc) count = std::stoul(argv[++i]);
+        else if ('-' != argv[i][0]) name = argv[i];
+        else
+        {
+            std::cerr << "Usage:\t" << argv[0] << " [<name>] (default " << stats::Publisher::DEFAULT_NAME << ")"
+                " [-i <interval ms>] (default 1000) [-n <count>] (default until the process exits)" << std::endl;
+            return -1;
+        }
+    }
+    const auto* block = stats::attach(name);
+    if (nullptr == block)
+    {
+        std::cerr << "No statistics in shared memory segment [" << name << "] (FeedHandler.out -m <name> not running?)" << std::endl;
+        return -1;
+    }
+
+    static constexpr char actions[] = { 'A', 'M', 'X', 'T' };
+    std::array<unsigned long long, stats::FeedStats::NB_MESSAGES> previous{};
+    auto previousNs = stats::realtimeNs();
+    for (auto i = 0UL; 0UL == count || i < count; ++i)
+    {
+        if (i) std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        const auto& feed = block->feed_;
+        const auto& reporter = block->reporter_;
+        const auto now = stats::realtimeNs();
+        const auto elapsed = static_cast<double>(now - previousNs) / 1e9;
+        previousNs = now;
+
+        StrStream strstream;
+        strstream << "pid [" << static_cast<unsigned int>(block->pid_) << "] up ["
+            << static_cast<unsigned long long>((now - block->startNs_) / 1'000'000'000ULL) << "] sec\n messages";
+        auto total = 0ULL;
+        auto totalRate = 0.0;
+        for (auto m = 0U; m < stats::FeedStats::NB_MESSAGES; ++m)
+        {
+            const auto value = feed.messages_[m].get();
+            const auto rate = (i && elapsed > 0.0) ? static_cast<double>(value - previous[m]) / elapsed : 0.0;
+            strstream << ' ' << actions[m] << " [" << value << "] (" << static_cast<unsigned long long>(rate) << "/s)";
+            total += value;
+            totalRate += rate;
+            previous[m] = value;
+        }
+        strstream << " all [" << total << "] (" << static_cast<unsigned long long>(totalRate) << "/s)\n";
+        const auto published = feed.published_.get();
+        const auto consumed = reporter.consumed_.get();
+        strstream << " published [" << published << "] consumed [" << consumed << "] queue depth ["
+            << (published > consumed ? published - consumed : 0ULL) << "] book depth bids ["
+            << feed.bidLevels_.get() << "] asks [" << feed.askLevels_.get() << "]\n";
+        // Histograms merged here, not by the recording threads (histograms and errors: best effort raw reads, see Stats.h)
+        auto printLatency = [&strstream, block](const char* stage, const Latency& latency)
+        {
+            const auto summary = stats::summarize(latency, block->nsPerTick_);
+            if (0ULL == summary.count_) return;
+            strstream << " latency (ns) " << stage << " p50 [" << summary.p50_ << "] p90 [" << summary.p90_
+                << "] p99 [" << summary.p99_ << "] p99.9 [" << summary.p999_ << "] max [" << summary.max_ << "]\n";
+        };
+        printLatency("until book applied", feed.latency_);
+        printLatency("until consumed", reporter.latency_);
+        for (auto e = 0UL; e < stats::errorFields.size(); ++e)
+        {
+            const auto field = stats::errorFields[e].field_;
+            const auto value = feed.errors_.*field + reporter.errors_.*field;
+            if (value) strstream << " [" << value << "] " << stats::errorFields[e].name_ << '\n';
+        }
+        std::cout.rdbuf()->sputn(strstream.c_str(), strstream.length());
+        std::cout.flush();
+
+        if (kill(block->pid_, 0) != 0 && ESRCH == errno)
+        {
+            std::cout << "Process exited" << std::endl;
+            break;
+        }
+    }
+    stats::detach(block);
+    return 0;
+}
@@ -1,8 +1,15 @@
 #include "FeedHandler.h"
 #include "Reporter.h"
+#include "Multicast.h"
 #include <utils/SimpleBuffer.h>
+#include <utils/AsyncSink.h>
+#include <utils/Tuning.h>
+#include <utils/StrStream.h>
 
+#include <cerrno>
+#include <cmath>
 #include <cstring>
+#include <csignal>
 
 #include <sys/mman.h>
 #include <fcntl.h>
@@ -10,28 +17,179 @@
 #include <sys/stat.h>
 
 #include <thread>
+#include <memory>
+#include <vector>
 #include <chrono>
 
+static volatile sig_atomic_t stopReceiving = 0; // Ctrl-C while receiving a multicast feed
+
+// Latencies requested while running (SIGUSR1) are formatted by the thread recording them and written
+// at once to stdout: std::cout is only used by the main thread
+static void writeLatency(const StrStream& strstream)
+{
+    for (auto written = 0UL; written < strstream.length(); )
+    {
+        const auto nb = ::write(STDOUT_FILENO, strstream.c_str() + written, strstream.length() - written);
+        if (nb < 0 && EINTR == errno) continue;
+        if (nb <= 0) return;
+        written += static_cast<size_t>(nb);
+    }
+}
+
 int main(int argc, char **argv)
 {
     if (argc < 2 || !strcmp(argv[1], "-h"))
     {
-        std::cerr << "Usage:\t<program name> <file> [-v <verbose>]" << std::endl;
+        std::cerr << "Usage:\t<program name> <file>|udp:<group>:<port> [-I <interface>] [-v <verbose>] [-c] [-p <pacing>] [-b <bytes>] [-t <usec>] [-s] [-l] [-m <name>]"
+            " [-x] [-g <depth>[,<trades>]] [-o <file>] [-i <bucket>] [-R <speed>] [-w <wait>] [-B <max>] [-a <cpu>[,<cpu>]] [-f <priority>] [-k] [-r <orders>] [-H]" << std::endl;
+        std::cerr << "\tudp:<group>:<port> : messages received from UDP multicast (e.g. udp:239.255.0.1:30001, see fhpublish) until an empty datagram or Ctrl-C" << std::endl;
+        std::cerr << "\t-I : multicast group joined on the interface of this address (default 127.0.0.1, loopback)" << std::endl;
+        std::cerr << "\t-c : conflate book updates (reporter only gets latest top of book per side)" << std::endl;
+        std::cerr << "\t-p : mid-quotes pacing 'event' (default), 'n:<N>' every N events, 'us:<T>' every T usec or 'change'" << std::endl;
+        std::cerr << "\t-b : buffer mid-quotes up to <bytes> before writing them (default 0)" << std::endl;
+        std::cerr << "\t-t : write buffered mid-quotes at least every <usec> (default 0 => only on size)" << std::endl;
+        std::cerr << "\t-s : reporter writes synchronously to stderr (default is through a writer thread)" << std::endl;
+        std::cerr << "\t-l : latency histograms per action/side printed at exit (and on SIGUSR1), from exchange timestamps too when messages have some" << std::endl;
+        std::cerr << "\t-m : statistics published in shared memory segment <name> while running (read them with fhstat)" << std::endl;
+        std::cerr << "\t-x : match crossing adds price-time against resting orders (trades generated, residual rested)" << std::endl;
+        std::cerr << "\t-g : mid-quotes followed by microprice, imbalance of the <depth> best levels (default 5), spread and VWAP of the last <trades> (default 100)" << std::endl;
+        std::cerr << "\t-o : OHLCV bars of the trades written to <file> (columnar, see Bars.h)" << std::endl;
+        std::cerr << "\t-i : bars bucket 'n:<N>' every N messages (default n:1000) or 'us:<T>' every T usec of exchange time (extended format)" << std::endl;
+        std::cerr << "\t-R : replay at the pace of the exchange timestamps, <speed> times the original (e.g. 1, 2, 10) or 'max' as fast as possible (timestamps rebased)" << std::endl;
+        std::cerr << "\t-w : reporter waits for updates with 'spin' (default, pause loop), 'yield' (spin then yield) or 'park' (spin, yield then futex)" << std::endl;
+        std::cerr << "\t-B : reporter drains up to <max> updates per lock and writes their lines at once (default 1)" << std::endl;
+        std::cerr << "\t-a : pin the feed thread (and the reporter thread, default next cpu) on <cpu>" << std::endl;
+        std::cerr << "\t-f : SCHED_FIFO <priority> (1-99) for the feed and reporter threads (use distinct isolated cpus)" << std::endl;
+        std::cerr << "\t-k : lock memory (mlockall current and future pages)" << std::endl;
+        std::cerr << "\t-r : arenas planned for <orders> per side and the queue, prefaulted with heap and thread stacks" << std::endl;
+        std::cerr << "\t-H : input and arenas on huge pages (explicit when reserved, transparent otherwise)" << std::endl;
         return -1;
     }
     
     auto verbose = 0;
-    if (argc == 4)
+    std::string interfaceAddress("127.0.0.1");
+    auto conflate = false;
+    auto matching = false;
+    auto analyticsDepth = 0UL, analyticsTrades = 100UL;
+    std::string barsPath;
+    auto barsMode = Bars::Mode::MESSAGES;
+    auto barsSize = 1'000ULL;
+    auto replaySpeed = -1.0; // no replay
+    auto synchronous = false;
+    auto latency = false;
+    std::string statsName;
+    auto feedCpu = -1, reporterCpu = -1;
+    auto fifoPriority = 0;
+    auto lockMemory = false;
+    auto prefaultOrders = 0UL;
+    auto hugePages = false;
+    auto waitMode = WaitStrategy::Mode::BUSY_SPIN;
+    auto batchSize = 1UL;
+    static constexpr size_t prefaultHeapBytes = 64 * 1024 * 1024; // snapshots, arenas overflow
+    static constexpr size_t queueArenaBytes = 64 * 1024 * 1024;   // deque chunks of pending updates
+    Reporter::Pacing pacing;
+    for (auto i = 2; i < argc; ++i)
     {
-        if (!strcmp(argv[2], "-v")) verbose = std::stoi(argv[3]);
+        if (!strcmp(argv[i], "-v") && i+1 < argc) verbose = std::stoi(argv[++i]);
+        else if (!strcmp(argv[i], "-I") && i+1 < argc) interfaceAddress = argv[++i];
+        else if (!strcmp(argv[i], "-c")) conflate = true;
+        else if (!strcmp(argv[i], "-x")) matching = true;
+        else if (!strcmp(argv[i], "-g") && i+1 < argc)
+        {
+            const std::string arg(argv[++i]);
+            const auto comma = arg.find(',');
+            analyticsDepth = std::max(1UL, std::stoul(arg.substr(0, comma)));
+            if (comma != std::string::npos) analyticsTrades = std::stoul(arg.substr(comma + 1));
+        }
+        else if (!strcmp(argv[i], "-o") && i+1 < argc) barsPath = argv[++i];
+        else if (!strcmp(argv[i], "-i") && i+1 < argc)
+        {
+            const char* bucket = argv[++i];
+            // <prefix><N> with N a positive number
+            auto size = [bucket](size_t prefix, unsigned long long& size)
+            {
+                char* end = nullptr;
+                size = isdigit(static_cast<unsigned char>(bucket[prefix])) ? strtoull(bucket + prefix, &end, 10) : 0ULL;
+                return size > 0ULL && '\0' == *end;
+            };
+            if (!strncmp(bucket, "n:", 2) && size(2, barsSize)) barsMode = Bars::Mode::MESSAGES;
+            else if (!strncmp(bucket, "us:", 3) && size(3, barsSize))
+            {
+                barsMode = Bars::Mode::TIME;
+                barsSize *= 1'000ULL;
+            }
+            else
+            {
+                std::cerr << "Unknown bars bucket [" << bucket << "] (n:<N> or us:<T>)" << std::endl;
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "-R") && i+1 < argc)
+        {
+            const char* speed = argv[++i];
+            char* end = nullptr;
+            replaySpeed = strcmp(speed, "max") ? strtod(speed, &end) : 0.0;
+            // 'max' or a finite positive number
+            if (end != nullptr && (end == speed || '\0' != *end || !(replaySpeed > 0.0) || !std::isfinite(replaySpeed)))
+            {
+                std::cerr << "Unknown replay speed [" << speed << "] (positive number or max)" << std::endl;
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "-s")) synchronous = true;
+        else if (!strcmp(argv[i], "-l")) latency = true;
+        else if (!strcmp(argv[i], "-m") && i+1 < argc) statsName = argv[++i];
+        else if (!strcmp(argv[i], "-a") && i+1 < argc)
+        {
+            const char* cpus = argv[++i];
+            feedCpu = std::stoi(cpus);
+            const char* comma = strchr(cpus, ',');
+            reporterCpu = comma ? std::stoi(comma+1) : feedCpu + 1;
+        }
+        else if (!strcmp(argv[i], "-f") && i+1 < argc) fifoPriority = std::stoi(argv[++i]);
+        else if (!strcmp(argv[i], "-k")) lockMemory = true;
+        else if (!strcmp(argv[i], "-r") && i+1 < argc) prefaultOrders = std::stoul(argv[++i]);
+        else if (!strcmp(argv[i], "-H")) hugePages = true;
+        else if (!strcmp(argv[i], "-B") && i+1 < argc) batchSize = std::max(1UL, std::stoul(argv[++i]));
+        else if (!strcmp(argv[i], "-w") && i+1 < argc && !WaitStrategy::parse(argv[++i], waitMode))
+        {
+            std::cerr << "Unknown wait strategy [" << argv[i] << "] (spin, yield or park)" << std::endl;
+            return -1;
+        }
+        else if (!strcmp(argv[i], "-p") && i+1 < argc)
+        {
+            const char* mode = argv[++i];
+            // <prefix><N> with N a positive number
+            auto every = [mode](size_t prefix, unsigned long long& every)
+            {
+                char* end = nullptr;
+                every = isdigit(static_cast<unsigned char>(mode[prefix])) ? strtoull(mode + prefix, &end, 10) : 0ULL;
+                return every > 0ULL && '\0' == *end;
+            };
+            if (!strcmp(mode, "event")) pacing.mode_ = Reporter::Pacing::Mode::EVERY_EVENT;
+            else if (!strcmp(mode, "change")) pacing.mode_ = Reporter::Pacing::Mode::ON_CHANGE;
+            else if (!strncmp(mode, "n:", 2) && every(2, pacing.every_)) pacing.mode_ = Reporter::Pacing::Mode::EVERY_N;
+            else if (!strncmp(mode, "us:", 3) && every(3, pacing.every_)) pacing.mode_ = Reporter::Pacing::Mode::EVERY_US;
+            else
+            {
+                std::cerr << "Unknown pacing [" << mode << "] (event, n:<N>, us:<T> or change)" << std::endl;
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "-b") && i+1 < argc) pacing.flushSize_ = std::stoul(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i+1 < argc) pacing.flushUs_ = std::stoull(argv[++i]);
     }
     std::cout << "Verbose is " << verbose << " : default is 0, param '-v 1 or higher' to activate it" << std::endl;
     std::cout.sync_with_stdio(false);
     std::cerr.sync_with_stdio(false);
     
     const std::string filename(argv[1]);
-    int fd = open(filename.c_str(), O_RDONLY, 0);
-    if (-1 == fd)
+    // Multicast feed instead of a file: joined before anything else so no datagram is missed
+    const auto network = 0 == filename.compare(0, 4, "udp:");
+    multicast::Receiver receiver;
+    if (network && !receiver.open(filename.substr(4), interfaceAddress)) return -1;
+    int fd = network ? -1 : open(filename.c_str(), O_RDONLY, 0);
+    if (!network && -1 == fd)
     {
         std::cerr << "Expected a file (see usage) or [" << filename << "] not readable!" << std::endl;
         return -1;
@@ -42,65 +200,277 @@ int main(int argc, char **argv)
         stat(filename.c_str(), &st);
         return st.st_size;
     };
-    size_t filesize = getFilesize(filename);
+    size_t filesize = network ? 0UL : getFilesize(filename);
     
-//    mlockall(MCL_FUTURE);
+    // Feed thread is the main thread: pinned before allocating so its memory is local to its cpu
+    if (feedCpu >= 0 && !tuning::pinThread(feedCpu)) std::cerr << "Unable to pin the feed thread on cpu [" << feedCpu << "]" << std::endl;
+    if (lockMemory && !tuning::lockMemory()) std::cerr << "Unable to lock memory (see ulimit -l or CAP_IPC_LOCK)" << std::endl;
 
     using std::chrono::high_resolution_clock;
     high_resolution_clock::time_point start = high_resolution_clock::now();
     
-    void* mmappedData = mmap(0, filesize, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    void* mmappedData = network ? nullptr : mmap(0, filesize, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
     if (unlikely(mmappedData == MAP_FAILED))
     {
         std::cerr << "Unable to mmap file [" << filename << "]!" << std::endl;
         return -1;
     }
-    SimpleBuffer sbuffer(static_cast<char*>(mmappedData), filesize);
+    tuning::Mapping hugeInput;
+    if (hugePages && !network)
+    {
+        if (tuning::mapAnonymous(filesize, true, hugeInput))
+        {
+            memcpy(hugeInput.data_, mmappedData, filesize);
+            if (!hugeInput.huge_) std::cerr << "No huge page reserved (see /proc/sys/vm/nr_hugepages), transparent huge pages advised" << std::endl;
+        }
+        else std::cerr << "Unable to map [" << filesize << "] bytes for the input, file mapping kept" << std::endl;
+    }
+    SimpleBuffer sbuffer(static_cast<char*>(hugeInput.data_ != nullptr ? hugeInput.data_ : mmappedData), filesize);
     sbuffer.seekEnd(filesize);
-//    mlockall(MCL_CURRENT|MCL_FUTURE);
-//    mlock(mmappedData, filesize);
     
-    WaitFreeQueue<FeedHandler::Data> queue;
-    FeedHandler feed(queue);
-    Reporter reporter;
-    Errors errors;
+    // Order tables (feed thread) and queue chunks (under the queue lock) on their own arenas
+    Arena ordersArena, queueArena;
+    if (prefaultOrders > 0)
+    {
+        if (!ordersArena.reserve(FeedHandler::arenaBytes(prefaultOrders), hugePages)
+            || !queueArena.reserve(queueArenaBytes, hugePages)) std::cerr << "Unable to reserve arenas, heap used" << std::endl;
+        else if (hugePages && !ordersArena.hugePages()) std::cerr << "No huge page reserved for arenas, transparent huge pages advised" << std::endl;
+    }
+    Arena* orders = prefaultOrders > 0 ? &ordersArena : nullptr;
+    Arena* chunks = prefaultOrders > 0 ? &queueArena : nullptr;
+    WaitFreeQueue<FeedHandler::Data> queue(conflate ? nullptr : chunks);
+    FeedHandler::ConflatedQueue conflatedQueue(conflate ? chunks : nullptr);
+    queue.setWaitStrategy(waitMode);
+    conflatedQueue.setWaitStrategy(waitMode);
+    auto feed = conflate ? std::make_unique<FeedHandler>(conflatedQueue, orders) : std::make_unique<FeedHandler>(queue, orders);
+    feed->setMatching(matching);
+    Reporter reporter(*feed);
+    reporter.setPacing(pacing);
+    std::unique_ptr<Analytics> analytics;
+    if (analyticsDepth > 0)
+    {
+        analytics = std::make_unique<Analytics>(analyticsDepth, analyticsTrades);
+        feed->setAnalytics(analytics.get());
+        reporter.setPrintSignals(true);
+    }
+    std::unique_ptr<Bars> bars;
+    if (!barsPath.empty())
+    {
+        bars = std::make_unique<Bars>(barsMode, barsSize);
+        if (bars->open(barsPath)) reporter.setBars(bars.get());
+        else std::cerr << "Unable to write bars to [" << barsPath << "]" << std::endl;
+    }
+    if (prefaultOrders > 0)
+    {
+        feed->reserve(prefaultOrders);
+        tuning::prefaultHeap(prefaultHeapBytes);
+        tuning::prefaultStack();
+    }
+    stats::Publisher statsPublisher;
+    stats::Block* statsBlock = nullptr;
+    if (!statsName.empty())
+    {
+        if (statsPublisher.open(statsName))
+        {
+            statsBlock = statsPublisher.block();
+            feed->setStats(&statsBlock->feed_);
+        }
+        else std::cerr << "Unable to create shared memory segment [" << statsName << "], no statistics published" << std::endl;
+    }
     
-    auto threaded_reporter = [&]() 
+    // One instance per thread, merged when reported (in the shared memory segment with -m, read by fhstat)
+    Errors localFeedErrors, localReporterErrors;
+    Errors& feedErrors = statsBlock ? statsBlock->feed_.errors_ : localFeedErrors;
+    Errors& reporterErrors = statsBlock ? statsBlock->reporter_.errors_ : localReporterErrors;
+    
+    // One instance per thread (exchange to book recorded by the feed thread)
+    Latency localFeedLatency, localReporterLatency, exchangeLatency;
+    Latency& feedLatency = statsBlock ? statsBlock->feed_.latency_ : localFeedLatency;
+    Latency& reporterLatency = statsBlock ? statsBlock->reporter_.latency_ : localReporterLatency;
+    if (latency)
     {
-        auto counter = 0;
+        tsc::nsPerTick(); // calibrate once out of the critical path
+        feed->setLatency(&feedLatency);
+        feed->setExchangeLatency(&exchangeLatency);
+        reporter.setLatency(&reporterLatency);
+        signal(SIGUSR1, [](int) { Latency::requestPrint(); });
+    }
+    
+    std::unique_ptr<Replay> replay;
+    if (replaySpeed >= 0.0)
+    {
+        replay = std::make_unique<Replay>(replaySpeed);
+        feed->setReplay(replay.get());
+    }
+    
+#ifdef PERF_COUNTERS
+    // One instance per thread, each opened by its thread
+    PerfRegions feedPerf, reporterPerf;
+    if (feedPerf.open()) feed->setPerfRegions(&feedPerf);
+    else std::cerr << "Hardware counters not available (see /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+#endif
+    
+    // Reporter only formats into memory, the sink thread writes to stderr
+    auto errSink = synchronous ? nullptr : std::make_unique<AsyncSink>(STDERR_FILENO);
+    std::ostream asyncErr(errSink.get());
+    std::ostream& reporterOs = synchronous ? std::cerr : asyncErr;
+    
+    auto threaded_reporter = [&](auto& queue) 
+    {
+        if (reporterCpu >= 0 && !tuning::pinThread(reporterCpu)) std::cerr << "Unable to pin the reporter thread on cpu [" << reporterCpu << "]" << std::endl;
+        if (fifoPriority > 0 && !tuning::setFifo(fifoPriority)) std::cerr << "Unable to set SCHED_FIFO for the reporter thread (see CAP_SYS_NICE)" << std::endl;
+        if (prefaultOrders > 0) tuning::prefaultStack();
+#ifdef PERF_COUNTERS
+        if (reporterPerf.open()) reporter.setPerfRegions(&reporterPerf);
+#endif
+        // Lines buffered with -t written on time while no update comes (bounded spin before the queue wait)
+        auto waitFlushing = [&]()
+        {
+            if (unlikely(pacing.flushUs_)) while (queue.empty() && reporter.flushIfLate()) cpuRelax();
+        };
+        auto printReporterLatency = [&]()
+        {
+            StrStream strstream;
+            reporterLatency.format(strstream, "until consumed");
+            writeLatency(strstream);
+        };
+        auto counter = 0UL;
+        if (batchSize > 1UL)
+        {
+            std::vector<FeedHandler::Data> batch(batchSize);
+            while(1)
+            {
+                waitFlushing();
+                const auto nb = queue.pop_front(batch.data(), batchSize);
+                const auto nbProcessed = reporter.processBatch(batch.data(), nb, reporterOs, reporterErrors);
+                if (unlikely(statsBlock != nullptr)) statsBlock->reporter_.consumed_.add(nbProcessed);
+                if (unlikely(latency && reporterLatency.printRequested())) printReporterLatency();
+                counter += nbProcessed;
+                if (counter > 10UL)
+                {
+                    reporter.printCurrentOrderBook(reporterOs);
+                    counter = 0UL;
+                }
+                if (nbProcessed < nb || 0UL == nb) break;
+            }
+            return;
+        }
         while(1)
         {
+            waitFlushing();
             if (likely(reporter.processData(queue.pop_front())))
             {
+                if (unlikely(statsBlock != nullptr)) statsBlock->reporter_.consumed_.inc();
+                if (unlikely(latency && reporterLatency.printRequested())) printReporterLatency();
                 ++counter;
-                if (counter > 10)
+                if (counter > 10UL)
                 {
-                    reporter.printCurrentOrderBook(std::cerr);
-                    counter = 0;
+                    reporter.printCurrentOrderBook(reporterOs);
+                    counter = 0UL;
                 }
-                reporter.printMidQuotesAndTrades(std::cerr, errors);
+                reporter.printMidQuotesAndTrades(reporterOs, reporterErrors);
             }
             else break;
         }
     };
-    std::thread thr(threaded_reporter);
+    std::thread thr = conflate ? std::thread([&]() { threaded_reporter(conflatedQueue); })
+                               : std::thread([&]() { threaded_reporter(queue); });
+    
+    if (fifoPriority > 0 && !tuning::setFifo(fifoPriority)) std::cerr << "Unable to set SCHED_FIFO for the feed thread (see CAP_SYS_NICE)" << std::endl;
     
     high_resolution_clock::time_point start2 = high_resolution_clock::now();
     
+    auto onMessage = [&](const char* data, size_t len)
+    {
+        feed->processMessage(data, len, feedErrors, verbose);
+        if (unlikely(latency && feedLatency.printRequested()))
+        {
+            StrStream strstream;
+            feedLatency.format(strstream, "until book applied");
+            if (exchangeLatency.count()) exchangeLatency.format(strstream, "from exchange timestamp until book applied");
+            writeLatency(strstream);
+        }
+    };
+    if (network)
+    {
+        signal(SIGINT, [](int) { stopReceiving = 1; });
+        while (likely(!stopReceiving) && receiver.receive(onMessage));
+    }
     while(sbuffer.available())
     {
         auto pos = sbuffer.getPosition('\n');
         if (unlikely(pos < 0)) break;
-        feed.processMessage(static_cast<const char*>(&sbuffer[0]), pos, errors, verbose);
+        onMessage(static_cast<const char*>(&sbuffer[0]), pos);
         sbuffer.seek(pos+1);
     }
     high_resolution_clock::time_point end2 = high_resolution_clock::now();
     queue.dontSpin();
+    conflatedQueue.dontSpin();
     
     thr.join();
+    reporter.flush();
+    if (bars)
+    {
+        bars->close();
+        if (verbose > 0) std::cout << "Bars: [" << bars->nbBars() << "] written to [" << barsPath << "]" << std::endl;
+        if (bars->nbUntimedTrades()) std::cerr << "Bars: [" << bars->nbUntimedTrades() 
+            << "] trades without exchange timestamp left out of the time bars (use -i n:<N>)" << std::endl;
+    }
+    if (errSink)
+    {
+        errSink->close();
+        if (unlikely(verbose))
+        {
+            auto stats = errSink->stats();
+            std::cout << "Async stderr: [" << stats.nbBytes_ << "] bytes in [" << stats.nbBuffers_ << "] buffers and ["
+                << stats.nbWrites_ << "] writes, [" << stats.nbStalls_ << "] stalls (" << stats.stallNs_ << " ns), max ["
+                << stats.maxPending_ << "] pending buffers, [" << stats.nbTaken_ << "] taken before publication, [" << stats.nbErrors_ << "] errors" << std::endl;
+        }
+    }
+    
+    if (unlikely(verbose) && WaitStrategy::Mode::SPIN_PARK == waitMode)
+    {
+        const auto& wait = conflate ? conflatedQueue.waitStrategy() : queue.waitStrategy();
+        std::cout << "Reporter parked [" << wait.nbParks() << "] times waiting for updates" << std::endl;
+    }
+    if (unlikely(verbose) && network)
+    {
+        std::cout << "Multicast: [" << receiver.nbDatagrams() << "] datagrams in [" << receiver.nbBatches() << "] batches, ["
+            << receiver.nbTruncated() << "] truncated, busy poll " << (receiver.busyPoll() ? "on" : "off")
+            << (receiver.ended() ? ", feed ended" : ", interrupted") << std::endl;
+    }
+    if (unlikely(verbose) && reporter.nbSkippedBooks())
+    {
+        std::cout << "Reporter: [" << reporter.nbSkippedBooks() << "] book prints skipped (book still changing)" << std::endl;
+    }
+    if (unlikely(verbose) && matching)
+    {
+        std::cout << "Matching: [" << feed->nbFills() << "] fills" << std::endl;
+    }
+    if (unlikely(verbose) && prefaultOrders > 0)
+    {
+        for (auto arena : { std::make_pair("orders", &ordersArena), std::make_pair("queue", &queueArena) })
+        {
+            std::cout << "Arena " << arena.first << ": [" << arena.second->used() << "] of [" << arena.second->capacity()
+                << "] bytes used" << (arena.second->hugePages() ? " (huge pages)" : "") << ", ["
+                << arena.second->nbFallbacks() << "] heap allocations" << std::endl;
+        }
+    }
     
     reporter.printCurrentOrderBook(std::cout);
+    Errors errors = feedErrors;
+    errors += reporterErrors;
     reporter.printErrors(std::cout, errors, verbose);
+    if (latency)
+    {
+        feedLatency.print(std::cout, "until book applied");
+        reporterLatency.print(std::cout, "until consumed");
+        if (exchangeLatency.count()) exchangeLatency.print(std::cout, "from exchange timestamp until book applied");
+    }
+#ifdef PERF_COUNTERS
+    if (feedPerf.counters().isOpen()) feedPerf.print(std::cout, "feed thread");
+    if (reporterPerf.counters().isOpen()) reporterPerf.print(std::cout, "reporter thread");
+#endif
         
     high_resolution_clock::time_point end = high_resolution_clock::now();
     using std::chrono::seconds;
@@ -119,8 +489,12 @@ int main(int argc, char **argv)
         << " usec (building OB: " << sec2 << " sec " << usec2  % 1'000'000 << " usec)"
         << std::endl;
         
-    munmap(mmappedData, filesize);
-    close(fd);
+    tuning::unmap(hugeInput);
+    if (!network)
+    {
+        munmap(mmappedData, filesize);
+        close(fd);
+    }
     return 0;
 }
 
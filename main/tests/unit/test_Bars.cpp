@@ -0,0 +1,143 @@
+#include <rapidcheck.h>
+
+#include <Bars.h>
+
+#include <vector>
+#include <chrono>
+
+#include <unistd.h>
+
+using namespace common;
+
+int main()
+{
+    const auto path = "/tmp/test_Bars_" + std::to_string(getpid()) + ".bin";
+
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL;
+    auto nbTests = 0U;
+    rc::check("Bars written per time or messages bucket hold the OHLCV of their trades", [&]()
+    {
+        const auto mode = *rc::gen::arbitrary<bool>() ? Bars::Mode::TIME : Bars::Mode::MESSAGES;
+        const auto size = *rc::gen::inRange<unsigned long long>(1, 1'000);
+        // Across several blocks
+        const auto nb = *rc::gen::inRange<size_t>(1, 3 * Bars::BARS_PER_BLOCK);
+
+        // Messages (trade or book update) with increasing exchange times
+        struct Message { bool trade_; Trade value_; unsigned long long time_; };
+        std::vector<Message> messages;
+        auto time = *rc::gen::inRange<unsigned long long>(1, 1'000'000);
+        for (auto i = 0UL; i < nb; ++i)
+        {
+            time += *rc::gen::inRange<unsigned long long>(0, 2 * size);
+            messages.push_back(Message{*rc::gen::arbitrary<bool>(), Trade(*rc::gen::inRange<Quantity>(1, 1'000), 900.0 + *rc::gen::inRange(0, 200)), time});
+        }
+
+        // Model: bucket of each message, bar per bucket holding trades
+        std::vector<Bars::Bar> expected;
+        auto lastBucket = ~0ULL;
+        for (auto i = 0UL; i < messages.size(); ++i)
+        {
+            auto& message = messages[i];
+            if (!message.trade_) continue;
+            const auto bucket = (Bars::Mode::TIME == mode) ? message.time_ / size : i / size;
+            if (expected.empty() || bucket != lastBucket)
+            {
+                Bars::Bar bar;
+                bar.time_ = (Bars::Mode::TIME == mode) ? bucket * size : message.time_;
+                bar.open_ = bar.high_ = bar.low_ = getPrice(message.value_);
+                expected.push_back(bar);
+                lastBucket = bucket;
+            }
+            auto& bar = expected.back();
+            bar.high_ = std::max(bar.high_, getPrice(message.value_));
+            bar.low_ = std::min(bar.low_, getPrice(message.value_));
+            bar.close_ = getPrice(message.value_);
+            bar.volume_ += getQty(message.value_);
+            bar.notional_ += static_cast<double>(getQty(message.value_)) * getPrice(message.value_);
+            ++bar.nbTrades_;
+        }
+
+        {
+            Bars bars(mode, size);
+            RC_ASSERT(bars.open(path));
+            start = high_resolution_clock::now();
+            for (auto& message : messages)
+            {
+                if (message.trade_) bars.onTrade(message.value_, message.time_);
+                bars.onMessage();
+            }
+            end = high_resolution_clock::now();
+            time_span1 += static_cast<unsigned long long>(duration_cast<nanoseconds>(end - start).count()) / nb;
+            bars.close();
+            RC_ASSERT(expected.size() == bars.nbBars());
+        }
+
+        std::vector<Bars::Bar> read;
+        Bars::Mode readMode;
+        unsigned long long readSize = 0;
+        RC_ASSERT(Bars::read(path, read, &readMode, &readSize));
+        RC_ASSERT(mode == readMode);
+        RC_ASSERT(size == readSize);
+        RC_ASSERT(expected.size() == read.size());
+        for (auto i = 0UL; i < expected.size(); ++i)
+        {
+            RC_ASSERT(expected[i].time_ == read[i].time_);
+            RC_ASSERT(expected[i].open_ == read[i].open_);
+            RC_ASSERT(expected[i].high_ == read[i].high_);
+            RC_ASSERT(expected[i].low_ == read[i].low_);
+            RC_ASSERT(expected[i].close_ == read[i].close_);
+            RC_ASSERT(expected[i].volume_ == read[i].volume_);
+            RC_ASSERT(expected[i].nbTrades_ == read[i].nbTrades_);
+            RC_ASSERT(expected[i].notional_ == read[i].notional_);
+        }
+        ++nbTests;
+    });
+
+    rc::check("Time bars leave out the trades without exchange timestamp", [&]()
+    {
+        const auto size = *rc::gen::inRange<unsigned long long>(1, 1'000);
+        const auto nb = *rc::gen::inRange<size_t>(1, 1'000);
+        Bars bars(Bars::Mode::TIME, size);
+        RC_ASSERT(bars.open(path));
+        auto nbTimed = 0ULL, nbUntimed = 0ULL;
+        auto time = *rc::gen::inRange<unsigned long long>(1, 1'000'000);
+        for (auto i = 0UL; i < nb; ++i)
+        {
+            const Trade trade(*rc::gen::inRange<Quantity>(1, 1'000), 900.0 + *rc::gen::inRange(0, 200));
+            if (*rc::gen::arbitrary<bool>())
+            {
+                bars.onTrade(trade, 0ULL);
+                ++nbUntimed;
+            }
+            else
+            {
+                bars.onTrade(trade, time += *rc::gen::inRange<unsigned long long>(0, 2 * size));
+                ++nbTimed;
+            }
+            bars.onMessage();
+        }
+        bars.close();
+        RC_ASSERT(nbUntimed == bars.nbUntimedTrades());
+
+        std::vector<Bars::Bar> read;
+        RC_ASSERT(Bars::read(path, read));
+        auto nbTrades = 0ULL;
+        for (auto& bar : read)
+        {
+            RC_ASSERT(0ULL == bar.time_ % size);
+            nbTrades += bar.nbTrades_;
+        }
+        RC_ASSERT(nbTimed == nbTrades);
+    });
+    unlink(path.c_str());
+    if (nbTests)
+    {
+        std::cout << "Bars aggregation perfs [" << time_span1/nbTests << "] (in ns per message)" << std::endl;
+    }
+
+    return 0;
+}
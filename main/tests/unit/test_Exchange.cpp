@@ -0,0 +1,166 @@
+#include <rapidcheck.h>
+
+#include <Exchange.h>
+
+#include <map>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include <unistd.h>
+
+using namespace common;
+
+namespace
+{
+    constexpr OrderId MARKER_ID = 999'999'999; // never used: its cancel is rejected, last response expected
+
+    exchange::OrderMsg order(char action, char side, OrderId orderId, Quantity qty, Price price)
+    {
+        exchange::OrderMsg msg;
+        msg.action_ = action;
+        msg.side_ = side;
+        msg.orderId_ = orderId;
+        msg.qty_ = qty;
+        msg.price_ = price;
+        return msg;
+    }
+
+    // Responses until the marker reject
+    std::vector<exchange::Frame> sync(exchange::Client& client)
+    {
+        const auto marker = order('X', 'B', MARKER_ID, 1, 1.0);
+        std::vector<exchange::Frame> responses;
+        if (!client.send(&marker, 1)) return responses;
+        std::vector<exchange::Frame> frames(256);
+        for (auto nb = client.receive(frames.data(), frames.size()); nb; nb = client.receive(frames.data(), frames.size()))
+        {
+            for (auto i = 0UL; i < nb; ++i)
+            {
+                if (exchange::RejectMsg::TYPE == frames[i].type() && MARKER_ID == frames[i].get<exchange::RejectMsg>().orderId_) return responses;
+                responses.push_back(frames[i]);
+            }
+        }
+        return responses;
+    }
+
+    // Event loop thread, stopped even when an assertion fails
+    struct Running
+    {
+        explicit Running(exchange::Server& server) : server_(server), loop_([&server]() { server.run(); }) {}
+        ~Running()
+        {
+            server_.stop();
+            loop_.join();
+        }
+        exchange::Server& server_;
+        std::thread loop_;
+    };
+
+    std::vector<exchange::ExecutionMsg> executions(const std::vector<exchange::Frame>& frames)
+    {
+        std::vector<exchange::ExecutionMsg> result;
+        for (auto& frame : frames) if (exchange::ExecutionMsg::TYPE == frame.type()) result.push_back(frame.get<exchange::ExecutionMsg>());
+        return result;
+    }
+}
+
+int main()
+{
+    const auto address = "/tmp/test_Exchange_" + std::to_string(getpid()) + ".sock";
+
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL;
+    auto nbTests = 0U;
+    rc::check("Crossing order is executed price-time against resting orders of another client", [&]()
+    {
+        exchange::Server server;
+        RC_ASSERT(server.listen(address));
+        Running running(server);
+        exchange::Client maker, taker;
+        RC_ASSERT(maker.connect(address));
+        RC_ASSERT(taker.connect(address));
+
+        // Resting sells in arrival order per price (model of the priority)
+        std::map<Price, std::vector<std::pair<OrderId, Quantity>>> sells;
+        std::vector<exchange::OrderMsg> orders;
+        const auto nb = *rc::gen::inRange(1, 200);
+        for (auto i = 0; i < nb; ++i)
+        {
+            const auto orderId = static_cast<OrderId>(i + 1);
+            const auto qty = *rc::gen::inRange<Quantity>(1, 100);
+            const Price price = 1001.0 + *rc::gen::inRange(0, 10);
+            orders.push_back(order('A', 'S', orderId, qty, price));
+            sells[price].emplace_back(orderId, qty);
+        }
+        start = high_resolution_clock::now();
+        RC_ASSERT(maker.send(orders.data(), orders.size()));
+        const auto makerAcks = sync(maker);
+        end = high_resolution_clock::now();
+        time_span1 += duration_cast<nanoseconds>(end - start).count() / static_cast<unsigned long long>(nb);
+        RC_ASSERT(executions(makerAcks).empty());
+
+        // Taker can't cancel orders of the maker, nor reuse their ids
+        const exchange::OrderMsg rejected[] = { order('X', 'S', 1, orders[0].qty_, orders[0].price_), order('A', 'B', 1, 1, 900.0) };
+        RC_ASSERT(taker.send(rejected, 2));
+        auto nbRejects = 0;
+        for (auto& frame : sync(taker)) nbRejects += (exchange::RejectMsg::TYPE == frame.type());
+        RC_ASSERT(2 == nbRejects);
+
+        const auto takerId = static_cast<OrderId>(nb + 1);
+        const auto takerQty = *rc::gen::inRange<Quantity>(1, 5'000);
+        const Price takerPrice = 1001.0 + *rc::gen::inRange(0, 10);
+        const auto takerOrder = order('A', 'B', takerId, takerQty, takerPrice);
+        RC_ASSERT(taker.send(&takerOrder, 1));
+        const auto takerExecutions = executions(sync(taker));
+        const auto makerExecutions = executions(sync(maker));
+
+        std::vector<exchange::ExecutionMsg> expected;
+        auto remaining = takerQty;
+        for (auto& level : sells)
+        {
+            if (level.first > takerPrice) break;
+            for (auto& resting : level.second)
+            {
+                if (0U == remaining) break;
+                exchange::ExecutionMsg execution;
+                execution.qty_ = std::min(remaining, resting.second);
+                execution.price_ = level.first;
+                execution.counterpartyId_ = resting.first;
+                expected.push_back(execution);
+                remaining -= execution.qty_;
+            }
+        }
+        RC_ASSERT(expected.size() == takerExecutions.size());
+        RC_ASSERT(expected.size() == makerExecutions.size());
+        for (auto i = 0UL; i < expected.size(); ++i)
+        {
+            RC_ASSERT('A' == takerExecutions[i].liquidity_ && 'B' == takerExecutions[i].side_);
+            RC_ASSERT(takerId == takerExecutions[i].orderId_);
+            RC_ASSERT(expected[i].counterpartyId_ == takerExecutions[i].counterpartyId_);
+            RC_ASSERT(expected[i].qty_ == takerExecutions[i].qty_);
+            RC_ASSERT(expected[i].price_ == takerExecutions[i].price_);
+            RC_ASSERT('P' == makerExecutions[i].liquidity_ && 'S' == makerExecutions[i].side_);
+            RC_ASSERT(expected[i].counterpartyId_ == makerExecutions[i].orderId_);
+            RC_ASSERT(takerId == makerExecutions[i].counterpartyId_);
+            RC_ASSERT(expected[i].qty_ == makerExecutions[i].qty_);
+        }
+
+        // Residual rested on the bid side, book never crossed
+        const auto& bids = server.feed().getBids();
+        const auto& asks = server.feed().getAsks();
+        RC_ASSERT((remaining > 0) == !bids.empty());
+        if (remaining > 0) RC_ASSERT(Limit(remaining, takerPrice) == bids.front());
+        RC_ASSERT(bids.empty() || asks.empty() || getPrice(bids.front()) < getPrice(asks.front()));
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Exchange order entry round trip perfs [" << time_span1/nbTests << "] (in ns per order)" << std::endl;
+    }
+
+    return 0;
+}
@@ -5,12 +5,18 @@
 #include <Reporter.h>
 #include <utils/StrStream.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <cstdlib>
 #include <iterator>
+#include <map>
 #include <set>
+#include <vector>
+#include <sstream>
+#include <fstream>
 
+#include <atomic>
 #include <thread>
 #include <future>
 #include <condition_variable>
@@ -25,11 +31,15 @@ public:
     rcFeedHandler(WaitFreeQueue<Data>& queue) : FeedHandler(queue)
     {
     }
+    rcFeedHandler(ConflatedQueue& queue) : FeedHandler(queue)
+    {
+    }
     
     auto getNbBuyOrders() { return buyOrders_.size(); }
     auto getNbSellOrders() { return sellOrders_.size(); }
     auto getNbBids() { return bids_.size(); }
     auto getNbAsks() { return asks_.size(); }
+    const DepthIndex& getDepthIndex(char side) { return ('B' == side) ? *bidsDepth_ : *asksDepth_; }
     
     inline void newBuyOrder(OrderId orderId, Order&& order, Errors& errors, const int verbose = 0)
     { FeedHandler::newBuyOrder(orderId, std::forward<Order>(order), errors, verbose); }
@@ -73,8 +83,8 @@ public:
         return true;
     }
     
-    inline std::deque<Limit> copyBids() { return bids_; }
-    inline std::deque<Limit> copyAsks() { return asks_; }
+    inline std::deque<Limit> copyBids() { return std::deque<Limit>(bids_.begin(), bids_.end()); }
+    inline std::deque<Limit> copyAsks() { return std::deque<Limit>(asks_.begin(), asks_.end()); }
     
     std::map<OrderId, Order> buyOrders, sellOrders;
     std::map<Price, int> uniqueBidPrices, uniqueAskPrices;
@@ -83,10 +93,24 @@ public:
 class rcReporter : public Reporter
 {
 public:
+    rcReporter(const FeedHandler& feed) : Reporter(feed)
+    {
+    }
+    
     auto getNbBids() { return bids_.size(); }
     auto getNbAsks() { return asks_.size(); }
     
-    inline void printCurrentOrderBook(const int verbose = 0) const
+    inline const Limit& getBestBid() const { return bestBid_; }
+    inline const Limit& getBestAsk() const { return bestAsk_; }
+    
+    inline std::vector<Limit> copyBids() const { FeedHandler::Levels::Snapshot bids; bids_.snapshot(bids); return std::vector<Limit>(bids.begin(), bids.end()); }
+    inline std::vector<Limit> copyAsks() const { FeedHandler::Levels::Snapshot asks; asks_.snapshot(asks); return std::vector<Limit>(asks.begin(), asks.end()); }
+    // Snapshots of one book state (false => still changing)
+    inline bool snapshotBook() { return Reporter::snapshotBook(); }
+    inline size_t getNbSnapshotBids() const { return bidsSnapshot_.size(); }
+    inline size_t getNbSnapshotAsks() const { return asksSnapshot_.size(); }
+    
+    inline void printCurrentOrderBook(const int verbose = 0)
     {
         if (likely(0 == verbose))
         {
@@ -147,10 +171,10 @@ int main(int argc, char **argv)
     WaitFreeQueue<FeedHandler::Data> queue;
     queue.dontSpin();
     rcFeedHandler FH(queue);
-    rcReporter report;
+    rcReporter report(FH);
     
     rcFeedHandler FH_prefilled(queue);
-    rcReporter report_prefilled;
+    rcReporter report_prefilled(FH_prefilled);
     
 #if 0
     std::deque<double> bids;
@@ -1152,6 +1176,847 @@ int main(int argc, char **argv)
             << "] and in prefilled (" << FH_prefilled.getNbSellOrders() << ") : [" << time_span2/nbTests
             << "] (in ns)" << std::endl;
     }
+#endif
+#if 1
+    time_span1 = time_span2 = 0ULL;
+    nbTests = 0U;
+    rc::check("Conflated updates give the same top of book", [&]()
+    {
+        FeedHandler::ConflatedQueue conflatedQueue;
+        conflatedQueue.dontSpin();
+        rcFeedHandler FH_conflated(conflatedQueue);
+        rcReporter report_conflated(FH_conflated);
+        
+        Errors errors;
+        std::vector<std::tuple<OrderId, char, Order>> liveOrders;
+        const auto nb = *rc::gen::inRange(100, 2'000);
+        auto nbPublished = 0U;
+        for (auto i = 1; i <= nb; ++i)
+        {
+            const auto side = *rc::gen::element('B', 'S');
+            const auto action = liveOrders.empty() ? 'A' : *rc::gen::element('A', 'A', 'M', 'M', 'M', 'X');
+            if ('A' == action)
+            {
+                const Price price = ('B' == side ? 1000.0 : 1100.0) + *rc::gen::inRange(0, 50) * (('B' == side) ? -1.0 : 1.0);
+                const Order order{*rc::gen::inRange<Quantity>(1, 100), price};
+                liveOrders.emplace_back(static_cast<OrderId>(i), side, order);
+                if ('B' == side) FH_conflated.newBuyOrder(static_cast<OrderId>(i), Order(order), errors, verbose);
+                else FH_conflated.newSellOrder(static_cast<OrderId>(i), Order(order), errors, verbose);
+            }
+            else
+            {
+                const auto idx = *rc::gen::inRange<size_t>(0, liveOrders.size());
+                auto& live = liveOrders[idx];
+                if ('M' == action)
+                {
+                    const Order order{*rc::gen::inRange<Quantity>(1, 100), getPrice(std::get<2>(live))};
+                    if ('B' == std::get<1>(live)) FH_conflated.modifyBuyOrder(std::get<0>(live), Order(order), errors, verbose);
+                    else FH_conflated.modifySellOrder(std::get<0>(live), Order(order), errors, verbose);
+                    std::get<2>(live) = order;
+                }
+                else
+                {
+                    if ('B' == std::get<1>(live)) FH_conflated.cancelBuyOrder(std::get<0>(live), Order(std::get<2>(live)), errors, verbose);
+                    else FH_conflated.cancelSellOrder(std::get<0>(live), Order(std::get<2>(live)), errors, verbose);
+                    liveOrders.erase(liveOrders.begin()+static_cast<long>(idx));
+                }
+            }
+            ++nbPublished;
+            if (*rc::gen::inRange(0, 10) == 0) // reporter lagging: no trade => at most one update per side
+            {
+                auto nbPending = 0U;
+                while (report_conflated.processData(conflatedQueue.pop_front())) ++nbPending;
+                RC_ASSERT(nbPending <= 2U);
+            }
+        }
+        while (report_conflated.processData(conflatedQueue.pop_front()));
+        
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+        const auto bids = FH_conflated.copyBids();
+        const auto asks = FH_conflated.copyAsks();
+        RC_ASSERT(std::vector<Limit>(bids.begin(), bids.end()) == report_conflated.copyBids());
+        RC_ASSERT(std::vector<Limit>(asks.begin(), asks.end()) == report_conflated.copyAsks());
+        RC_ASSERT((bids.empty() ? Limit{0ULL, 0.0} : bids.front()) == report_conflated.getBestBid());
+        RC_ASSERT((asks.empty() ? Limit{0ULL, 0.0} : asks.front()) == report_conflated.getBestAsk());
+        time_span1 += conflatedQueue.nbConflated();
+        time_span2 += nbPublished;
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Conflated updates [" << time_span1 << "] over [" << time_span2 << "] published" << std::endl;
+    }
+#endif
+#if 1
+    time_span1 = time_span2 = 0ULL;
+    nbTests = 0U;
+    rc::check("Book snapshots taken while the book changes pair the bids and asks of one book state", [&]()
+    {
+        WaitFreeQueue<FeedHandler::Data> pairedQueue;
+        rcFeedHandler FH_paired(pairedQueue);
+        rcReporter report_paired(FH_paired);
+        
+        std::atomic<bool> done{false};
+        auto nbSnapshots = 0ULL, nbTorn = 0ULL;
+        std::thread reader([&]()
+        {
+            while (!done.load(std::memory_order_acquire))
+            {
+                if (!report_paired.snapshotBook()) continue;
+                ++nbSnapshots;
+                const auto nbBids = report_paired.getNbSnapshotBids(), nbAsks = report_paired.getNbSnapshotAsks();
+                if (nbBids < nbAsks || nbBids > nbAsks + 1) ++nbTorn;
+            }
+        });
+        // A bid then an ask, removed in reverse: each book state holds as many bids as asks or one more.
+        // Pauses between bursts let snapshots complete (a book changing at each message never pairs)
+        Errors errors;
+        const auto nb = *rc::gen::inRange(100, 2'000);
+        for (auto i = 1; i <= nb; ++i)
+        {
+            FH_paired.apply('A', 'B', static_cast<OrderId>(2*i), Order{1U, 1000.0 - i}, errors);
+            FH_paired.apply('A', 'S', static_cast<OrderId>(2*i+1), Order{1U, 2000.0 + i}, errors);
+            if (0 == i % 64) std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+        for (auto i = nb; i >= 1; --i)
+        {
+            FH_paired.apply('X', 'S', static_cast<OrderId>(2*i+1), Order{1U, 2000.0 + i}, errors);
+            FH_paired.apply('X', 'B', static_cast<OrderId>(2*i), Order{1U, 1000.0 - i}, errors);
+            if (0 == i % 64) std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+        done.store(true, std::memory_order_release);
+        reader.join();
+        
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+        RC_ASSERT(0ULL == nbTorn);
+        RC_ASSERT(report_paired.snapshotBook());
+        RC_ASSERT(0UL == report_paired.getNbSnapshotBids() + report_paired.getNbSnapshotAsks());
+        time_span1 += nbSnapshots;
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Paired book snapshots [" << time_span1/nbTests << "] per test while changing" << std::endl;
+    }
+#endif
+#if 1
+    time_span1 = time_span2 = 0ULL;
+    nbTests = 0U;
+    rc::check("Paced mid-quotes are a sample of all mid-quotes", [&]()
+    {
+        WaitFreeQueue<FeedHandler::Data> pacedQueue;
+        pacedQueue.dontSpin();
+        rcFeedHandler FH_paced(pacedQueue);
+        
+        Errors errors;
+        const auto nb = *rc::gen::inRange(10, 1'000);
+        std::vector<std::pair<bool, Order>> orders; // buy side, order
+        for (auto i = 0; i < nb; ++i)
+        {
+            const auto buy = *rc::gen::arbitrary<bool>();
+            const Price price = buy ? 1000.0 - *rc::gen::inRange(0, 10) : 1001.0 + *rc::gen::inRange(0, 10);
+            orders.emplace_back(buy, Order{*rc::gen::inRange<Quantity>(1, 100), price});
+        }
+        const auto every = *rc::gen::inRange<unsigned long long>(1, 20);
+        const auto flushSize = *rc::gen::inRange<size_t>(0, 4'096);
+        std::vector<FeedHandler::Data> events;
+        
+        // Same events printed by each reporter
+        auto print = [&](const Reporter::Pacing& pacing, std::ostream& os)
+        {
+            rcReporter paced(FH_paced);
+            paced.setPacing(pacing);
+            for (auto& data : events)
+            {
+                FeedHandler::Data copy(data.action_, data.side_, data.pos_, data.limit_);
+                copy.bookVersion_ = data.bookVersion_;
+                copy.bestBid_ = data.bestBid_;
+                copy.bestAsk_ = data.bestAsk_;
+                paced.processData(std::move(copy));
+                paced.printMidQuotesAndTrades(os, errors);
+            }
+            paced.flush();
+        };
+        auto lines = [](const std::ostringstream& os)
+        {
+            std::vector<std::string> lines;
+            std::istringstream is(os.str());
+            for (std::string line; std::getline(is, line);) lines.emplace_back(line);
+            return lines;
+        };
+        
+        for (auto i = 0UL; i < orders.size(); ++i)
+        {
+            if (orders[i].first) FH_paced.newBuyOrder(static_cast<OrderId>(i+1), Order(orders[i].second), errors, verbose);
+            else FH_paced.newSellOrder(static_cast<OrderId>(i+1), Order(orders[i].second), errors, verbose);
+            events.emplace_back(pacedQueue.pop_front());
+        }
+        
+        std::ostringstream all, everyN, onChange, buffered;
+        print(Reporter::Pacing(), all);
+        print(Reporter::Pacing{Reporter::Pacing::Mode::EVERY_N, every, 0UL, 0ULL}, everyN);
+        print(Reporter::Pacing{Reporter::Pacing::Mode::ON_CHANGE, 1ULL, 0UL, 0ULL}, onChange);
+        print(Reporter::Pacing{Reporter::Pacing::Mode::EVERY_EVENT, 1ULL, flushSize, 0ULL}, buffered);
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+        
+        const auto allLines = lines(all);
+        RC_ASSERT(allLines.size() == events.size());
+        std::vector<std::string> expected;
+        for (auto i = every-1; i < allLines.size(); i += every) expected.emplace_back(allLines[i]);
+        RC_ASSERT(lines(everyN) == expected);
+        expected = allLines;
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        RC_ASSERT(lines(onChange) == expected);
+        RC_ASSERT(buffered.str() == all.str());
+        
+        std::ofstream null("/dev/null");
+        start = high_resolution_clock::now();
+        print(Reporter::Pacing(), null);
+        end = high_resolution_clock::now();
+        time_span1 += duration_cast<nanoseconds>(end - start).count() / events.size();
+        start = high_resolution_clock::now();
+        print(Reporter::Pacing{Reporter::Pacing::Mode::EVERY_EVENT, 1ULL, 4'096UL, 0ULL}, null);
+        end = high_resolution_clock::now();
+        time_span2 += duration_cast<nanoseconds>(end - start).count() / events.size();
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Print mid-quotes perfs [" << time_span1/nbTests << "] and buffered by 4k [" 
+            << time_span2/nbTests << "] (in ns)" << std::endl;
+    }
+#endif
+#if 1
+    time_span1 = time_span2 = 0ULL;
+    nbTests = 0U;
+    rc::check("Batched updates print the same lines as one by one", [&]()
+    {
+        WaitFreeQueue<FeedHandler::Data> batchQueue;
+        batchQueue.dontSpin();
+        rcFeedHandler FH_batch(batchQueue);
+        
+        Errors errors;
+        const auto nb = *rc::gen::inRange(10, 1'000);
+        for (auto i = 0; i < nb; ++i)
+        {
+            const auto buy = *rc::gen::arbitrary<bool>();
+            const Price price = buy ? 1000.0 - *rc::gen::inRange(0, 10) : 1001.0 + *rc::gen::inRange(0, 10);
+            if (buy) FH_batch.newBuyOrder(static_cast<OrderId>(i+1), Order{*rc::gen::inRange<Quantity>(1, 100), price}, errors, verbose);
+            else FH_batch.newSellOrder(static_cast<OrderId>(i+1), Order{*rc::gen::inRange<Quantity>(1, 100), price}, errors, verbose);
+        }
+        const auto batchSize = *rc::gen::inRange<size_t>(1, 100);
+        const auto mode = *rc::gen::element(Reporter::Pacing::Mode::EVERY_EVENT, Reporter::Pacing::Mode::ON_CHANGE);
+        const Reporter::Pacing pacing{mode, 1ULL, *rc::gen::inRange<size_t>(0, 4'096), 0ULL};
+        
+        // Drained by batches, each batch replayed one by one then at once
+        std::ostringstream oneByOne, batched;
+        rcReporter reporterOneByOne(FH_batch), reporterBatched(FH_batch);
+        reporterOneByOne.setPacing(pacing);
+        reporterBatched.setPacing(pacing);
+        std::vector<FeedHandler::Data> batch(batchSize);
+        auto nbDrained = 0UL;
+        for (auto nbBatch = batchQueue.pop_front(batch.data(), batchSize); nbBatch; nbBatch = batchQueue.pop_front(batch.data(), batchSize))
+        {
+            RC_ASSERT(nbBatch <= batchSize);
+            nbDrained += nbBatch;
+            std::vector<FeedHandler::Data> copies;
+            for (auto i = 0UL; i < nbBatch; ++i)
+            {
+                FeedHandler::Data copy(batch[i].action_, batch[i].side_, batch[i].pos_, batch[i].limit_);
+                copy.bookVersion_ = batch[i].bookVersion_;
+                copy.bestBid_ = batch[i].bestBid_;
+                copy.bestAsk_ = batch[i].bestAsk_;
+                reporterOneByOne.processData(std::move(batch[i]));
+                reporterOneByOne.printMidQuotesAndTrades(oneByOne, errors);
+                copies.emplace_back(std::move(copy));
+            }
+            start = high_resolution_clock::now();
+            RC_ASSERT(nbBatch == reporterBatched.processBatch(copies.data(), nbBatch, batched, errors));
+            end = high_resolution_clock::now();
+            time_span1 += duration_cast<nanoseconds>(end - start).count();
+        }
+        reporterOneByOne.flush();
+        reporterBatched.flush();
+        RC_ASSERT(static_cast<size_t>(nb) == nbDrained);
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+        RC_ASSERT(oneByOne.str() == batched.str());
+        
+        // End of data stops the batch
+        FeedHandler::Data last[2];
+        last[0] = FeedHandler::Data('T', 0, 0, Limit{1ULL, 1000.5});
+        RC_ASSERT(1UL == reporterBatched.processBatch(last, 2, batched, errors));
+        time_span2 += static_cast<unsigned long long>(nb);
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Batched updates perfs [" << time_span1/time_span2 << "] (in ns)" << std::endl;
+    }
+#endif
+#if 1
+    time_span1 = time_span2 = 0ULL;
+    nbTests = 0U;
+    rc::check("Matching mode fills crossing orders price-time and never crosses the book", [&]()
+    {
+        WaitFreeQueue<FeedHandler::Data> matchQueue;
+        matchQueue.dontSpin();
+        rcFeedHandler FH_match(matchQueue);
+        FH_match.setMatching(true);
+        std::vector<FeedHandler::Fill> fills;
+        FH_match.setFillHandler([&fills](const FeedHandler::Fill& fill) { fills.push_back(fill); });
+        
+        // Model: resting orders in arrival order (id, side, qty, price)
+        struct Resting { OrderId id_; bool buy_; Quantity qty_; Price price_; };
+        std::vector<Resting> resting;
+        std::vector<FeedHandler::Fill> expectedFills;
+        Errors errors;
+        const auto nb = *rc::gen::inRange(10, 1'000);
+        for (auto i = 0; i < nb; ++i)
+        {
+            const auto orderId = static_cast<OrderId>(i+1);
+            if (!resting.empty() && *rc::gen::inRange(0, 4) == 0)
+            {
+                const auto index = *rc::gen::inRange<size_t>(0, resting.size());
+                const auto cancelled = resting[index];
+                if (cancelled.buy_) FH_match.cancelBuyOrder(cancelled.id_, Order{cancelled.qty_, cancelled.price_}, errors, verbose);
+                else FH_match.cancelSellOrder(cancelled.id_, Order{cancelled.qty_, cancelled.price_}, errors, verbose);
+                resting.erase(resting.begin() + static_cast<long>(index));
+                continue;
+            }
+            const auto buy = *rc::gen::arbitrary<bool>();
+            const Price price = 1000.0 + *rc::gen::inRange(-10, 10);
+            auto qty = *rc::gen::inRange<Quantity>(1, 100);
+            if (buy) FH_match.newBuyOrder(orderId, Order{qty, price}, errors, verbose);
+            else FH_match.newSellOrder(orderId, Order{qty, price}, errors, verbose);
+            
+            while (qty > 0)
+            {
+                auto best = resting.end();
+                for (auto it = resting.begin(); it != resting.end(); ++it)
+                {
+                    if (it->buy_ == buy || (buy ? it->price_ > price : it->price_ < price)) continue;
+                    if (best == resting.end() || (buy ? it->price_ < best->price_ : it->price_ > best->price_)) best = it;
+                }
+                if (best == resting.end()) break;
+                const auto fill = std::min(qty, best->qty_);
+                expectedFills.push_back(FeedHandler::Fill{orderId, best->id_, buy ? 'B' : 'S', fill, best->price_});
+                qty -= fill;
+                best->qty_ -= fill;
+                if (0U == best->qty_) resting.erase(best);
+            }
+            if (qty > 0) resting.push_back(Resting{orderId, buy, qty, price});
+        }
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+        RC_ASSERT(expectedFills.size() == fills.size());
+        RC_ASSERT(expectedFills.size() == FH_match.nbFills());
+        for (auto i = 0UL; i < fills.size(); ++i)
+        {
+            RC_ASSERT(expectedFills[i].aggressorId_ == fills[i].aggressorId_);
+            RC_ASSERT(expectedFills[i].restingId_ == fills[i].restingId_);
+            RC_ASSERT(expectedFills[i].side_ == fills[i].side_);
+            RC_ASSERT(expectedFills[i].qty_ == fills[i].qty_);
+            RC_ASSERT(expectedFills[i].price_ == fills[i].price_);
+        }
+        
+        std::map<Price, AggregatedQty, std::greater<Price>> bids;
+        std::map<Price, AggregatedQty> asks;
+        for (auto& order : resting) (order.buy_ ? bids[order.price_] : asks[order.price_]) += order.qty_;
+        std::deque<Limit> expectedBids, expectedAsks;
+        for (auto& level : bids) expectedBids.emplace_back(level.second, level.first);
+        for (auto& level : asks) expectedAsks.emplace_back(level.second, level.first);
+        const auto copyBids = FH_match.copyBids();
+        const auto copyAsks = FH_match.copyAsks();
+        RC_ASSERT(expectedBids == copyBids);
+        RC_ASSERT(expectedAsks == copyAsks);
+        RC_ASSERT(copyBids.empty() || copyAsks.empty() || getPrice(copyBids.front()) < getPrice(copyAsks.front()));
+        
+        // Every fill is published as a trade at the resting price
+        auto nbTrades = 0UL;
+        for (auto data = matchQueue.pop_front(); data.action_; data = matchQueue.pop_front())
+        {
+            if ('T' != data.action_) continue;
+            RC_ASSERT(nbTrades < fills.size());
+            RC_ASSERT(Trade(fills[nbTrades].qty_, fills[nbTrades].price_) == data.limit_);
+            ++nbTrades;
+        }
+        RC_ASSERT(fills.size() == nbTrades);
+    });
+
+    rc::check("Matching mode: a qty increase loses the time priority, a decrease keeps it", [&]()
+    {
+        WaitFreeQueue<FeedHandler::Data> matchQueue;
+        matchQueue.dontSpin();
+        rcFeedHandler FH_match(matchQueue);
+        FH_match.setMatching(true);
+        std::vector<FeedHandler::Fill> fills;
+        FH_match.setFillHandler([&fills](const FeedHandler::Fill& fill) { fills.push_back(fill); });
+
+        Errors errors;
+        const auto buy = *rc::gen::arbitrary<bool>();
+        const Price price = 1000.0 + *rc::gen::inRange(-10, 10);
+        const auto nbResting = *rc::gen::inRange<OrderId>(2, 10);
+        const auto qty = *rc::gen::inRange<Quantity>(2, 100);
+        for (OrderId id = 1; id <= nbResting; ++id)
+        {
+            if (buy) FH_match.newBuyOrder(id, Order{qty, price}, errors, verbose);
+            else FH_match.newSellOrder(id, Order{qty, price}, errors, verbose);
+        }
+
+        // Modify the first resting order (up or down), then sweep the whole level
+        const auto increase = *rc::gen::arbitrary<bool>();
+        const auto newQty = increase ? qty + *rc::gen::inRange<Quantity>(1, 100) : *rc::gen::inRange<Quantity>(1, qty);
+        if (buy) FH_match.modifyBuyOrder(1, Order{newQty, price}, errors, verbose);
+        else FH_match.modifySellOrder(1, Order{newQty, price}, errors, verbose);
+        const auto total = newQty + (nbResting-1) * qty;
+        if (buy) FH_match.newSellOrder(nbResting+1, Order{total, price}, errors, verbose);
+        else FH_match.newBuyOrder(nbResting+1, Order{total, price}, errors, verbose);
+
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+        RC_ASSERT(static_cast<size_t>(nbResting) == fills.size());
+        std::vector<OrderId> expected;
+        if (!increase) expected.push_back(1);
+        for (OrderId id = 2; id <= nbResting; ++id) expected.push_back(id);
+        if (increase) expected.push_back(1);
+        for (auto i = 0UL; i < fills.size(); ++i)
+        {
+            RC_ASSERT(expected[i] == fills[i].restingId_);
+            RC_ASSERT((1 == expected[i] ? newQty : qty) == fills[i].qty_);
+        }
+        RC_ASSERT(FH_match.copyBids().empty() && FH_match.copyAsks().empty());
+    });
+
+    rc::check("Latencies recorded per action and side", [&]()
+    {
+        WaitFreeQueue<FeedHandler::Data> latencyQueue;
+        latencyQueue.dontSpin();
+        rcFeedHandler FH_latency(latencyQueue);
+        rcReporter report_latency(FH_latency);
+        Latency feedLatency, reporterLatency;
+        FH_latency.setLatency(&feedLatency);
+        report_latency.setLatency(&reporterLatency);
+        
+        Errors errors;
+        const auto nb = *rc::gen::inRange<unsigned int>(1, 1'000);
+        for (auto i = 1U; i <= nb; ++i)
+        {
+            StrStream msg;
+            // Distinct prices => each order adds a level (never crossed)
+            msg << "A," << i << ',' << ((i & 1) ? "B," : "S,") << i << ',' << ((i & 1) ? i : 2'000U + i) << '\n';
+            FH_latency.processMessage(msg.c_str(), msg.length()-1, errors, verbose);
+        }
+        FH_latency.processMessage("T,10,1000", 9, errors, verbose);
+        FH_latency.processMessage("Z,10,1000", 9, errors, verbose);
+        while (report_latency.processData(latencyQueue.pop_front()));
+        
+        RC_ASSERT(1UL == errors.nbErrors());
+        RC_ASSERT(feedLatency.get('A', 'B').count() == (nb+1)/2);
+        RC_ASSERT(feedLatency.get('A', 'S').count() == nb/2);
+        RC_ASSERT(feedLatency.get('T', 0).count() == 1ULL);
+        RC_ASSERT(reporterLatency.get('A', 'B').count() == (nb+1)/2);
+        RC_ASSERT(reporterLatency.get('A', 'S').count() == nb/2);
+        RC_ASSERT(reporterLatency.get('T', 0).count() == 1ULL);
+        RC_ASSERT(reporterLatency.get('A', 'B').min() >= feedLatency.get('A', 'B').min());
+        
+        // Extended format: exchange timestamp (1 ms ago) carried by the update, recorded until book applied
+        Latency exchangeLatency;
+        FH_latency.setExchangeLatency(&exchangeLatency);
+        const auto timestamp = static_cast<unsigned long long>(std::chrono::duration_cast<nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count()) - 1'000'000ULL;
+        StrStream msg;
+        msg << "T,10,1000," << timestamp << ",42";
+        FH_latency.processMessage(msg.c_str(), msg.length(), errors, verbose);
+        FH_latency.processMessage("T,10,1000", 9, errors, verbose);
+        const auto data = latencyQueue.pop_front();
+        RC_ASSERT(timestamp == data.timestamp_);
+        RC_ASSERT(0ULL == latencyQueue.pop_front().timestamp_);
+        RC_ASSERT(1ULL == exchangeLatency.count());
+        RC_ASSERT(tsc::toNs(exchangeLatency.get('T', 0).min()) >= 0.9 * 1'000'000.0);
+        time_span1 += static_cast<unsigned long long>(tsc::toNs(feedLatency.get('A', 'B').percentile(99.0)));
+        time_span2 += static_cast<unsigned long long>(tsc::toNs(reporterLatency.get('A', 'B').percentile(99.0)));
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Latencies recorded per action and side p99 until book applied [" << time_span1/nbTests 
+            << "] and until consumed [" << time_span2/nbTests << "] (in ns)" << std::endl;
+    }
+#endif
+#if 1
+    time_span1 = 0ULL;
+    nbTests = 0U;
+    rc::check("Analytics signals carried by each update match a full recomputation", [&]()
+    {
+        WaitFreeQueue<FeedHandler::Data> analyticsQueue;
+        analyticsQueue.dontSpin();
+        rcFeedHandler FH_analytics(analyticsQueue);
+        const auto depth = *rc::gen::inRange<size_t>(1, 10);
+        const auto nbTrades = *rc::gen::inRange<size_t>(1, 20);
+        Analytics analytics(depth, nbTrades);
+        FH_analytics.setAnalytics(&analytics);
+        
+        struct Resting { bool buy_; Quantity qty_; Price price_; };
+        std::map<OrderId, Resting> resting;
+        std::vector<Trade> trades;
+        Errors errors;
+        const auto nb = *rc::gen::inRange(1, 2'000);
+        for (auto i = 0; i < nb; ++i)
+        {
+            StrStream msg;
+            const auto draw = *rc::gen::inRange(0, 10);
+            if (!resting.empty() && draw < 4)
+            {
+                auto it = resting.begin();
+                std::advance(it, *rc::gen::inRange<long>(0, static_cast<long>(resting.size())));
+                if (draw < 2)
+                {
+                    msg << "X," << it->first << ',' << (it->second.buy_ ? 'B' : 'S') << ',' << it->second.qty_ << ',' << it->second.price_;
+                    resting.erase(it);
+                }
+                else
+                {
+                    it->second.qty_ = *rc::gen::inRange<Quantity>(1, 100);
+                    msg << "M," << it->first << ',' << (it->second.buy_ ? 'B' : 'S') << ',' << it->second.qty_ << ',' << it->second.price_;
+                }
+            }
+            else if (draw < 5)
+            {
+                const Trade trade(*rc::gen::inRange<Quantity>(1, 100), 1000.0 + *rc::gen::inRange(-20, 20));
+                msg << "T," << getQty(trade) << ',' << getPrice(trade);
+                trades.push_back(trade);
+            }
+            else
+            {
+                const auto orderId = static_cast<OrderId>(i+1);
+                const auto buy = *rc::gen::arbitrary<bool>();
+                const Resting order{buy, *rc::gen::inRange<Quantity>(1, 100), (buy ? 990.0 : 1010.0) + *rc::gen::inRange(-10, 10)};
+                msg << "A," << orderId << ',' << (buy ? 'B' : 'S') << ',' << order.qty_ << ',' << order.price_;
+                resting.emplace(orderId, order);
+            }
+            start = high_resolution_clock::now();
+            FH_analytics.processMessage(msg.c_str(), msg.length(), errors, verbose);
+            end = high_resolution_clock::now();
+            time_span1 += static_cast<unsigned long long>(duration_cast<nanoseconds>(end - start).count());
+            ++nbTests;
+            
+            FeedHandler::Data last;
+            for (auto data = analyticsQueue.pop_front(); data.action_; data = analyticsQueue.pop_front()) last = std::move(data);
+            RC_ASSERT(0 != last.action_);
+            
+            const auto bids = FH_analytics.copyBids();
+            const auto asks = FH_analytics.copyAsks();
+            AggregatedQty bidQty = 0, askQty = 0;
+            for (auto j = 0UL; j < std::min(depth, bids.size()); ++j) bidQty += getQty(bids[j]);
+            for (auto j = 0UL; j < std::min(depth, asks.size()); ++j) askQty += getQty(asks[j]);
+            RC_ASSERT(bidQty == analytics.bidDepthQty());
+            RC_ASSERT(askQty == analytics.askDepthQty());
+            const auto& signals = last.signals_;
+            if (bidQty + askQty) RC_ASSERT((static_cast<double>(bidQty) - static_cast<double>(askQty)) / static_cast<double>(bidQty + askQty) == signals.imbalance_);
+            else RC_ASSERT(std::isnan(signals.imbalance_));
+            if (!bids.empty() && !asks.empty())
+            {
+                const auto bestBidQty = static_cast<double>(getQty(bids.front()));
+                const auto bestAskQty = static_cast<double>(getQty(asks.front()));
+                RC_ASSERT(getPrice(asks.front()) - getPrice(bids.front()) == signals.spread_);
+                RC_ASSERT((getPrice(bids.front()) * bestAskQty + getPrice(asks.front()) * bestBidQty) / (bestBidQty + bestAskQty) == signals.microprice_);
+            }
+            else RC_ASSERT(std::isnan(signals.spread_) && std::isnan(signals.microprice_));
+            if (!trades.empty())
+            {
+                auto qty = 0.0, notional = 0.0;
+                for (auto j = trades.size() - std::min(nbTrades, trades.size()); j < trades.size(); ++j)
+                {
+                    qty += static_cast<double>(getQty(trades[j]));
+                    notional += static_cast<double>(getQty(trades[j])) * getPrice(trades[j]);
+                }
+                RC_ASSERT(std::fabs(notional / qty - signals.vwap_) < 1e-9 * notional / qty);
+            }
+            else RC_ASSERT(std::isnan(signals.vwap_));
+        }
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+    });
+    if (nbTests)
+    {
+        std::cout << "Messages applied with analytics perfs [" << time_span1/nbTests << "] (in ns)" << std::endl;
+    }
+#endif
+#if 1
+    time_span1 = time_span2 = 0ULL;
+    nbTests = 0U;
+    rc::check("Depth queries match a walk of the levels", [&]()
+    {
+        WaitFreeQueue<FeedHandler::Data> depthQueue;
+        depthQueue.dontSpin();
+        rcFeedHandler FH_depth(depthQueue);
+        const Price tick = 0.5;
+        // Prices spread over a random range (index rebuilt when out of range)
+        const auto range = *rc::gen::inRange(1, 1'999);
+        const auto enableAt = *rc::gen::inRange(0, 100);
+        
+        struct Resting { bool buy_; Quantity qty_; Price price_; };
+        std::map<OrderId, Resting> resting;
+        Errors errors;
+        const auto nb = *rc::gen::inRange(1, 1'000);
+        for (auto i = 0; i < nb; ++i)
+        {
+            if (i == enableAt) FH_depth.enableDepthQueries(tick);
+            const auto draw = *rc::gen::inRange(0, 10);
+            if (!resting.empty() && draw < 4)
+            {
+                auto it = resting.begin();
+                std::advance(it, *rc::gen::inRange<long>(0, static_cast<long>(resting.size())));
+                auto& order = it->second;
+                if (draw < 2)
+                {
+                    if (order.buy_) FH_depth.cancelBuyOrder(it->first, Order{order.qty_, order.price_}, errors, verbose);
+                    else FH_depth.cancelSellOrder(it->first, Order{order.qty_, order.price_}, errors, verbose);
+                    resting.erase(it);
+                }
+                else
+                {
+                    order.qty_ = *rc::gen::inRange<Quantity>(1, 100);
+                    if (order.buy_) FH_depth.modifyBuyOrder(it->first, Order{order.qty_, order.price_}, errors, verbose);
+                    else FH_depth.modifySellOrder(it->first, Order{order.qty_, order.price_}, errors, verbose);
+                }
+            }
+            else
+            {
+                const auto orderId = static_cast<OrderId>(i+1);
+                const Resting order{*rc::gen::arbitrary<bool>(), *rc::gen::inRange<Quantity>(1, 100), 1000.0 + tick * *rc::gen::inRange(-range, range)};
+                if (order.buy_) FH_depth.newBuyOrder(orderId, Order{order.qty_, order.price_}, errors, verbose);
+                else FH_depth.newSellOrder(orderId, Order{order.qty_, order.price_}, errors, verbose);
+                resting.emplace(orderId, order);
+            }
+            while (depthQueue.pop_front().action_);
+        }
+        if (nb <= enableAt) FH_depth.enableDepthQueries(tick);
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+        
+        for (auto side : { 'B', 'S' })
+        {
+            const auto levels = ('B' == side) ? FH_depth.copyBids() : FH_depth.copyAsks();
+            const auto ticks = *rc::gen::inRange<unsigned long long>(0, 2 * static_cast<unsigned long long>(range));
+            AggregatedQty within = 0, total = 0;
+            for (auto& level : levels)
+            {
+                total += getQty(level);
+                if (std::fabs(getPrice(level) - getPrice(levels.front())) <= static_cast<double>(ticks) * tick) within += getQty(level);
+            }
+            start = high_resolution_clock::now();
+            const auto depth = FH_depth.depthWithin(side, ticks);
+            end = high_resolution_clock::now();
+            time_span1 += static_cast<unsigned long long>(duration_cast<nanoseconds>(end - start).count());
+            RC_ASSERT(within == depth);
+            
+            const auto qty = *rc::gen::inRange<AggregatedQty>(1, total + 100);
+            AggregatedQty swept = 0;
+            Price worst = 0.0, notional = 0.0;
+            start = high_resolution_clock::now();
+            for (auto& level : levels)
+            {
+                if (swept == qty) break;
+                const auto fill = std::min(qty - swept, getQty(level));
+                swept += fill;
+                notional += static_cast<double>(fill) * getPrice(level);
+                worst = getPrice(level);
+            }
+            end = high_resolution_clock::now();
+            time_span2 += static_cast<unsigned long long>(duration_cast<nanoseconds>(end - start).count());
+            const auto sweep = FH_depth.sweep(side, qty);
+            RC_ASSERT(swept == sweep.qty_);
+            if (swept)
+            {
+                RC_ASSERT(worst == sweep.worstPrice_);
+                RC_ASSERT(std::fabs(notional / static_cast<double>(swept) - sweep.averagePrice_) < 1e-9 * notional);
+            }
+            else RC_ASSERT(std::isnan(sweep.worstPrice_));
+            ++nbTests;
+        }
+    });
+    if (nbTests)
+    {
+        std::cout << "Depth queries perfs [" << time_span1/nbTests << "] and levels walk [" << time_span2/nbTests << "] (in ns)" << std::endl;
+    }
+#endif
+#if 1
+    time_span1 = 0ULL;
+    nbTests = 0U;
+    rc::check("Depth queries cover a bounded window: far and off grid levels not indexed", [&]()
+    {
+        WaitFreeQueue<FeedHandler::Data> depthQueue;
+        depthQueue.dontSpin();
+        rcFeedHandler FH_depth(depthQueue);
+        const Price tick = 0.5, base = 1'000'000.0;
+        const auto maxTicks = *rc::gen::inRange<size_t>(64, 1'024);
+        FH_depth.enableDepthQueries(tick, maxTicks);
+        
+        // Near levels (within an eighth of the window), far ones up to a million ticks away, one off grid
+        struct Resting { bool buy_; Quantity qty_; Price price_; bool near_; };
+        std::vector<Resting> resting;
+        const auto nb = *rc::gen::inRange(1, 200);
+        for (auto i = 0; i < nb; ++i)
+        {
+            const auto buy = *rc::gen::arbitrary<bool>();
+            const auto near = *rc::gen::inRange(0, 4) > 0;
+            const auto ticks = near ? *rc::gen::inRange<long>(0, static_cast<long>(maxTicks / 8))
+                                    : static_cast<long>(maxTicks) + *rc::gen::inRange<long>(0, 1'000'000);
+            const auto price = buy ? base - tick * static_cast<double>(ticks) : base + tick * static_cast<double>(1 + ticks);
+            resting.push_back({buy, *rc::gen::inRange<Quantity>(1, 100), price, near});
+        }
+        resting.push_back({true, 1, base - tick / 2.0 - tick * static_cast<double>(maxTicks / 16), false});
+        Errors errors;
+        start = high_resolution_clock::now();
+        for (auto i = 0UL; i < resting.size(); ++i)
+        {
+            const auto& order = resting[i];
+            if (order.buy_) FH_depth.newBuyOrder(static_cast<OrderId>(i+1), Order{order.qty_, order.price_}, errors, verbose);
+            else FH_depth.newSellOrder(static_cast<OrderId>(i+1), Order{order.qty_, order.price_}, errors, verbose);
+        }
+        end = high_resolution_clock::now();
+        time_span1 += static_cast<unsigned long long>(duration_cast<nanoseconds>(end - start).count()) / resting.size();
+        while (depthQueue.pop_front().action_);
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+        
+        for (auto side : { 'B', 'S' })
+        {
+            AggregatedQty nearQty = 0;
+            for (auto& order : resting) if (order.near_ && order.buy_ == ('B' == side)) nearQty += order.qty_;
+            const auto& index = FH_depth.getDepthIndex(side);
+            RC_ASSERT(index.nbTicks() <= maxTicks);
+            RC_ASSERT(('B' == side ? 1ULL : 0ULL) == index.nbOffGrid());
+            // Only the near levels (the far ones are indexed once no near level is left)
+            if (nearQty)
+            {
+                RC_ASSERT(nearQty == FH_depth.depthWithin(side, std::numeric_limits<unsigned long long>::max()));
+                RC_ASSERT(nearQty == FH_depth.sweep(side, nearQty + 100).qty_);
+            }
+        }
+        
+        // Near bids cancelled: window recentred on the best far bid
+        for (auto i = 0UL; i < resting.size(); ++i)
+        {
+            const auto& order = resting[i];
+            if (order.buy_ && order.near_) FH_depth.cancelBuyOrder(static_cast<OrderId>(i+1), Order{order.qty_, order.price_}, errors, verbose);
+        }
+        while (depthQueue.pop_front().action_);
+        const auto& index = FH_depth.getDepthIndex('B');
+        AggregatedQty expected = 0;
+        Price best = 0.0;
+        for (auto& level : FH_depth.copyBids())
+        {
+            if (std::fabs(getPrice(level) / tick - std::round(getPrice(level) / tick)) > 1e-9) continue; // off grid
+            if (0.0 == best) best = getPrice(level);
+            if ((best - getPrice(level)) / tick < static_cast<double>(index.nbTicks() - index.nbTicks() / 4)) expected += getQty(level);
+        }
+        RC_ASSERT(expected == FH_depth.depthWithin('B', std::numeric_limits<unsigned long long>::max()));
+        RC_ASSERT(index.nbTicks() <= maxTicks);
+        RC_ASSERT(0UL == errors.nbErrors() + errors.nbCriticalErrors());
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Orders applied with a bounded depth index perfs [" << time_span1/nbTests << "] (in ns)" << std::endl;
+    }
+#endif
+#if 1
+    time_span1 = 0ULL;
+    nbTests = 0U;
+    rc::check("Sequenced messages dropped, duplicated or reordered give the in order book once recovered", [&]()
+    {
+        // Adds (distinct prices, never crossed) and cancels of the previous add, sequence = line + 1
+        const auto nb = *rc::gen::inRange<unsigned int>(2, 500);
+        std::vector<std::string> lines;
+        for (auto i = 1U; i <= nb; ++i)
+        {
+            StrStream msg;
+            if (i % 3 == 0) msg << "X," << i-1 << ',' << (((i-1) & 1) ? "B," : "S,") << i-1 << ',' << (((i-1) & 1) ? i-1 : 2'000U + i-1);
+            else msg << "A," << i << ',' << ((i & 1) ? "B," : "S,") << i << ',' << ((i & 1) ? i : 2'000U + i);
+            msg << ",0," << i;
+            lines.emplace_back(msg.c_str(), msg.length());
+        }
+        
+        WaitFreeQueue<FeedHandler::Data> inOrderQueue, sequencedQueue;
+        rcFeedHandler FH_inOrder(inOrderQueue), FH_sequenced(sequencedQueue);
+        Errors inOrderErrors, errors;
+        for (auto& line : lines) FH_inOrder.processMessage(line.c_str(), line.size(), inOrderErrors, verbose);
+        
+        // First one delivered first (sets the expected sequence), then pairs swapped, lines dropped or duplicated
+        std::vector<unsigned int> delivered{0}, dropped;
+        auto nbDuplicates = 0ULL;
+        for (auto i = 1U; i < nb; ++i)
+        {
+            const auto draw = *rc::gen::inRange(0, 10);
+            if (0 == draw) dropped.push_back(i);
+            else if (1 == draw && i+1 < nb)
+            {
+                delivered.push_back(i+1);
+                delivered.push_back(i++);
+            }
+            else
+            {
+                delivered.push_back(i);
+                if (2 == draw)
+                {
+                    delivered.push_back(i);
+                    ++nbDuplicates;
+                }
+            }
+        }
+        std::vector<std::pair<unsigned long long, unsigned long long>> gaps;
+        FH_sequenced.setRecoveryHandler([&](unsigned long long from, unsigned long long to) { gaps.emplace_back(from, to); });
+        FH_sequenced.setMaxBufferedMessages(nb);
+        start = high_resolution_clock::now();
+        for (auto i : delivered) FH_sequenced.processMessage(lines[i].c_str(), lines[i].size(), errors, verbose);
+        end = high_resolution_clock::now();
+        time_span1 += static_cast<unsigned long long>(duration_cast<nanoseconds>(end - start).count()) / delivered.size();
+        // Dropped after the last delivered one => no gap seen
+        const auto last = *std::max_element(delivered.begin(), delivered.end());
+        RC_ASSERT((dropped.empty() || dropped.front() > last) == (0UL == FH_sequenced.nbBufferedMessages()));
+        for (auto i : dropped)
+        {
+            const auto sequence = i + 1ULL;
+            if (i > last) break;
+            RC_ASSERT(std::any_of(gaps.begin(), gaps.end(), [&](auto& gap) { return gap.first <= sequence && sequence <= gap.second; }));
+        }
+        // Retransmitted
+        for (auto i : dropped) FH_sequenced.processMessage(lines[i].c_str(), lines[i].size(), errors, verbose);
+        
+        RC_ASSERT(0UL == FH_sequenced.nbBufferedMessages());
+        RC_ASSERT(nb + 1ULL == FH_sequenced.nextSequence());
+        RC_ASSERT(nbDuplicates == errors.duplicateSequences);
+        RC_ASSERT(0ULL == errors.lostSequences);
+        RC_ASSERT(errors.nbErrors() == errors.sequenceGaps + errors.duplicateSequences + errors.outOfOrderSequences);
+        RC_ASSERT(FH_inOrder.bookVersion() == FH_sequenced.bookVersion());
+        RC_ASSERT(FH_inOrder.getBids().size() == FH_sequenced.getBids().size());
+        RC_ASSERT(FH_inOrder.getAsks().size() == FH_sequenced.getAsks().size());
+        for (auto i = 0UL; i < FH_inOrder.getBids().size(); ++i) RC_ASSERT(FH_inOrder.getBids()[i] == FH_sequenced.getBids()[i]);
+        for (auto i = 0UL; i < FH_inOrder.getAsks().size(); ++i) RC_ASSERT(FH_inOrder.getAsks()[i] == FH_sequenced.getAsks()[i]);
+        
+        // Never retransmitted: abandoned once too many buffered, the following ones applied
+        const auto next = FH_sequenced.nextSequence();
+        FH_sequenced.setMaxBufferedMessages(2);
+        for (auto sequence = next + 1; sequence <= next + 3; ++sequence)
+        {
+            StrStream msg;
+            msg << "T,10,1000,0," << sequence;
+            FH_sequenced.processMessage(msg.c_str(), msg.length(), errors, verbose);
+        }
+        RC_ASSERT(1ULL == errors.lostSequences);
+        RC_ASSERT(next + 4 == FH_sequenced.nextSequence());
+        RC_ASSERT(0UL == FH_sequenced.nbBufferedMessages());
+        
+        // Snapshot applied up to a buffered one: the following ones applied
+        FH_sequenced.processMessage("T,10,1000,0,1000000", 19, errors, verbose);
+        FH_sequenced.processMessage("T,10,1000,0,1000001", 19, errors, verbose);
+        RC_ASSERT(2UL == FH_sequenced.nbBufferedMessages());
+        FH_sequenced.resetSequence(1'000'000ULL, errors, verbose);
+        RC_ASSERT(1'000'002ULL == FH_sequenced.nextSequence());
+        RC_ASSERT(0UL == FH_sequenced.nbBufferedMessages());
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Sequenced messages perfs [" << time_span1/nbTests << "] (in ns per message)" << std::endl;
+    }
 #endif
     return 0;
 }
@@ -0,0 +1,73 @@
+#include <rapidcheck.h>
+
+#include <Multicast.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include <unistd.h>
+
+using namespace common;
+
+int main()
+{
+    // Loopback only (ttl 0), port distinct per process
+    const auto address = "239.255.0.1:" + std::to_string(20'000 + getpid() % 20'000);
+
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL;
+    auto nbTests = 0U;
+    rc::check("Messages packed in datagrams are received in order until the end of the feed", [&]()
+    {
+        multicast::Receiver receiver;
+        multicast::Sender sender;
+        RC_ASSERT(receiver.open(address));
+        RC_ASSERT(sender.open(address));
+
+        // Lines of the text feed, packed by up to <perDatagram> (last one with or without '\n')
+        const auto nb = *rc::gen::inRange<size_t>(1, 500);
+        const auto perDatagram = *rc::gen::inRange<size_t>(1, 20);
+        std::vector<std::string> messages;
+        for (auto i = 0UL; i < nb; ++i)
+        {
+            messages.push_back("A," + std::to_string(i + 1) + ",B," + std::to_string(*rc::gen::inRange(1, 1'000)) + ","
+                + std::to_string(*rc::gen::inRange(1, 100'000)));
+        }
+        auto nbDatagrams = 0UL;
+        for (auto i = 0UL; i < nb; i += perDatagram)
+        {
+            std::string datagram;
+            for (auto j = i; j < std::min(nb, i + perDatagram); ++j) datagram += messages[j] + '\n';
+            if (*rc::gen::arbitrary<bool>()) datagram.pop_back();
+            RC_ASSERT(sender.send(datagram.data(), datagram.size()));
+            ++nbDatagrams;
+        }
+        // Too long: dropped
+        const std::string tooLong(multicast::Receiver::DATAGRAM_BYTES + 1, 'A');
+        RC_ASSERT(sender.send(tooLong.data(), tooLong.size()));
+        RC_ASSERT(sender.end());
+
+        std::vector<std::string> received;
+        start = high_resolution_clock::now();
+        while (receiver.receive([&](const char* data, size_t len) { received.emplace_back(data, len); }));
+        end = high_resolution_clock::now();
+        time_span1 += static_cast<unsigned long long>(duration_cast<nanoseconds>(end - start).count()) / nb;
+
+        RC_ASSERT(receiver.ended());
+        RC_ASSERT(nbDatagrams + 1 == receiver.nbDatagrams());
+        RC_ASSERT(1ULL == receiver.nbTruncated());
+        RC_ASSERT(receiver.nbBatches() <= receiver.nbDatagrams());
+        RC_ASSERT(messages == received);
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Multicast receive perfs [" << time_span1/nbTests << "] (in ns per message)" << std::endl;
+    }
+
+    return 0;
+}
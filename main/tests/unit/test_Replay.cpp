@@ -0,0 +1,75 @@
+#include <rapidcheck.h>
+
+#include <Replay.h>
+
+#include <algorithm>
+#include <vector>
+#include <chrono>
+
+using namespace common;
+
+int main()
+{
+    using std::chrono::steady_clock;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    std::vector<unsigned long long> lateness; // all tests, median printed
+    auto nbTests = 0U;
+    rc::check("Messages released at the pace of their timestamps with rebased timestamps", [&]()
+    {
+        const double speeds[] = { 1.0, 2.0, 10.0 };
+        const auto speed = speeds[*rc::gen::inRange(0, 3)];
+        Replay replay(speed);
+
+        // Bursts (same timestamp) and gaps up to 100 us, a few going backward
+        const auto nb = *rc::gen::inRange<size_t>(1, 50);
+        std::vector<unsigned long long> timestamps;
+        auto timestamp = 1'700'000'000'000'000'000ULL + *rc::gen::inRange<unsigned long long>(0, 1'000'000'000);
+        for (auto i = 0UL; i < nb; ++i)
+        {
+            const auto draw = *rc::gen::inRange(0, 10);
+            if (0 == draw && i) timestamps.push_back(timestamp - 1'000);
+            else
+            {
+                if (draw > 3) timestamp += *rc::gen::inRange<unsigned long long>(1, 100'000);
+                timestamps.push_back(timestamp);
+            }
+        }
+
+        RC_ASSERT(0ULL == replay.release(0ULL));
+        // Before the first release (the replay start)
+        const auto start = steady_clock::now();
+        const auto first = replay.release(timestamps[0]);
+        auto last = first;
+        for (auto i = 1UL; i < nb; ++i)
+        {
+            const auto rebased = replay.release(timestamps[i]);
+            const auto elapsed = static_cast<unsigned long long>(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+            // Never before its time (calibration tolerance), rebased on the first one
+            const auto expected = timestamps[i] > timestamps[0] ? static_cast<unsigned long long>(static_cast<double>(timestamps[i] - timestamps[0]) / speed) : 0ULL;
+            RC_ASSERT(static_cast<double>(elapsed) >= 0.99 * static_cast<double>(expected));
+            RC_ASSERT(rebased - first <= expected + 1 && rebased - first + 1 >= expected);
+            RC_ASSERT(rebased == replay.rebase(timestamps[i]));
+            lateness.push_back(elapsed - std::min(elapsed, expected));
+            if (timestamps[i] >= timestamps[i-1]) RC_ASSERT(rebased >= last);
+            last = rebased;
+        }
+
+        // As fast as possible: rebased on the release time
+        Replay fastest(0.0);
+        const auto before = static_cast<unsigned long long>(duration_cast<nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        const auto rebased = fastest.release(timestamps.back());
+        RC_ASSERT(rebased >= before);
+        RC_ASSERT(fastest.rebase(timestamps.front()) >= rebased);
+        ++nbTests;
+    });
+    if (nbTests && !lateness.empty())
+    {
+        // Median: a preemption delays all the following releases
+        std::nth_element(lateness.begin(), lateness.begin() + lateness.size()/2, lateness.end());
+        std::cout << "Replay release median lateness [" << lateness[lateness.size()/2] << "] (in ns)" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+#! /usr/bin/python
+
+# Prints the OHLCV bars written by FeedHandler.out -o <file> (columnar format, see main/src/Bars.h)
+# as CSV: time,open,high,low,close,volume,trades,vwap
+
+from __future__ import print_function
+
+import struct, sys
+
+COLUMNS = ['Q', 'd', 'd', 'd', 'd', 'Q', 'Q', 'd'] # time, open, high, low, close, volume, trades, notional
+
+def read_bars(path):
+    with open(path, 'rb') as f:
+        if f.read(8) != b'FHBARS1\n':
+            raise ValueError(path + ' is not a bars file')
+        mode, size = struct.unpack('<QQ', f.read(16))
+        bars = []
+        header = f.read(8)
+        while len(header) == 8:
+            nb, = struct.unpack('<Q', header)
+            columns = [struct.unpack('<%d%s' % (nb, c), f.read(8 * nb)) for c in COLUMNS]
+            bars.extend(zip(*columns))
+            header = f.read(8)
+        return ('time' if mode == 0 else 'messages'), size, bars
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print('Usage: ' + sys.argv[0] + ' <bars file>', file=sys.stderr)
+        sys.exit(1)
+    mode, size, bars = read_bars(sys.argv[1])
+    print('# bucket %s %d' % (mode, size))
+    print('time,open,high,low,close,volume,trades,vwap')
+    for time, o, h, l, c, volume, trades, notional in bars:
+        print('%d,%f,%f,%f,%f,%d,%d,%f' % (time, o, h, l, c, volume, trades, notional / volume if volume else 0.0))
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "utils/Common.h"
+#include "utils/Tuning.h"
+
+#include <array>
+#include <cstddef>
+#include <new>
+
+// !! Not thread safe: one arena per owning thread (or per lock, e.g. a queue) !!
+// Memory pool for node based containers (std::unordered_map nodes, std::deque chunks):
+//   - one contiguous region reserved at startup, prefaulted, on huge pages when available,
+//     so the containers spread over a few TLB entries instead of many 4K heap pages,
+//   - blocks are carved with a bump pointer and recycled through a free list per size class
+//     (LIFO => the hottest block is reused first),
+//   - once the region is exhausted (or without region) blocks come from the heap.
+
+class Arena
+{
+public:
+    static constexpr size_t ALIGNMENT = 16;
+    static constexpr size_t SMALL_LIMIT = 4096; // classes every ALIGNMENT bytes, powers of two above
+
+    Arena() = default;
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Size of the region (rounded up to its page size), false => heap only
+    bool reserve(size_t bytes, bool hugePages);
+
+    FORCE_INLINE void* allocate(size_t bytes)
+    {
+        const auto index = sizeClass(bytes);
+        auto* block = free_[index];
+        if (likely(block != nullptr))
+        {
+            free_[index] = block->next_;
+            return block;
+        }
+        const auto size = classSize(index);
+        if (likely(static_cast<size_t>(end_ - current_) >= size))
+        {
+            void* memory = current_;
+            current_ += size;
+            return memory;
+        }
+        ++nbFallbacks_;
+        return ::operator new(bytes);
+    }
+
+    FORCE_INLINE void deallocate(void* memory, size_t bytes)
+    {
+        if (unlikely(static_cast<char*>(memory) < begin_ || static_cast<char*>(memory) >= end_))
+        {
+            ::operator delete(memory);
+            return;
+        }
+        const auto index = sizeClass(bytes);
+        auto* block = static_cast<FreeBlock*>(memory);
+        block->next_ = free_[index];
+        free_[index] = block;
+    }
+
+    size_t capacity() const { return static_cast<size_t>(end_ - begin_); }
+    size_t used() const { return static_cast<size_t>(current_ - begin_); } // high water mark
+    bool hugePages() const { return mapping_.huge_; }
+    unsigned long long nbFallbacks() const { return nbFallbacks_; } // heap allocations
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next_;
+    };
+    static constexpr size_t NB_SMALL_CLASSES = SMALL_LIMIT / ALIGNMENT;
+    static constexpr size_t NB_CLASSES = NB_SMALL_CLASSES + 64;
+
+    static FORCE_INLINE size_t sizeClass(size_t bytes)
+    {
+        if (likely(bytes <= SMALL_LIMIT)) return bytes ? (bytes - 1) / ALIGNMENT : 0UL;
+        return NB_SMALL_CLASSES + static_cast<size_t>(64 - __builtin_clzll(bytes - 1)); // next power of two
+    }
+    static FORCE_INLINE size_t classSize(size_t index)
+    {
+        if (likely(index < NB_SMALL_CLASSES)) return (index + 1) * ALIGNMENT;
+        return 1UL << (index - NB_SMALL_CLASSES);
+    }
+
+    tuning::Mapping mapping_;
+    char* begin_ = nullptr;
+    char* current_ = nullptr;
+    char* end_ = nullptr;
+    std::array<FreeBlock*, NB_CLASSES> free_{};
+    unsigned long long nbFallbacks_ = 0ULL;
+};
+
+// STL allocator over an Arena, the default one (no arena) is the heap
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(size_t n)
+    {
+        if (arena_ == nullptr) return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+    }
+    void deallocate(T* memory, size_t n)
+    {
+        if (arena_ == nullptr) ::operator delete(memory);
+        else arena_->deallocate(memory, n * sizeof(T));
+    }
+
+    Arena* arena() const { return arena_; }
+
+private:
+    Arena* arena_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) { return lhs.arena() == rhs.arena(); }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) { return lhs.arena() != rhs.arena(); }
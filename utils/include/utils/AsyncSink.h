@@ -0,0 +1,83 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <atomic>
+#include <memory>
+#include <streambuf>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <sys/uio.h>
+
+// !! Only One producer !!
+// Output sink (std::streambuf) formatting into a ring of preallocated buffers,
+// a dedicated writer thread writes published buffers to the file descriptor
+// with writev (many buffers per system call).
+// Producer only waits when the whole ring is pending (backpressure, see Stats).
+// sync() (i.e. os.flush()) publishes the current buffer when the writer is idle,
+// otherwise lines are batched: the writer writes the synced part of the current
+// buffer once done with the previous ones (then the rest when it is published).
+
+class AsyncSink : public std::streambuf
+{
+public:
+    static constexpr size_t DEFAULT_NB_BUFFERS = 64;
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 65'536;
+
+    struct Stats
+    {
+        unsigned long long nbBuffers_ = 0ULL;   // published
+        unsigned long long nbWrites_ = 0ULL;    // writev calls
+        unsigned long long nbTaken_ = 0ULL;     // synced parts of the current buffer written before its publication
+        unsigned long long nbBytes_ = 0ULL;     // written
+        unsigned long long nbErrors_ = 0ULL;    // failed writev
+        unsigned long long nbStalls_ = 0ULL;    // producer waited for a free buffer
+        unsigned long long stallNs_ = 0ULL;     // total producer waiting time
+        unsigned long long maxPending_ = 0ULL;  // max buffers waiting for the writer
+    };
+
+    AsyncSink(int fd, size_t nbBuffers = DEFAULT_NB_BUFFERS, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+    ~AsyncSink();
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+
+    // Publish pending output, wait for the writer to write it all and stop it
+    void close();
+
+    // Writer counters are only complete once closed
+    Stats stats() const;
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+private:
+    void publish();
+    void run();
+    // All of <iovcnt> iovecs (updated), errors counted
+    void write(struct iovec* iov, int iovcnt);
+
+    const int fd_;
+    const size_t nbBuffers_;
+    const size_t bufferSize_;
+    std::unique_ptr<char[]> buffers_;
+    std::unique_ptr<size_t[]> sizes_;
+
+    // Producer side
+    Stats stats_;
+
+    alignas(common::cacheLinesSze) std::atomic<unsigned long long> head_{0ULL}; // published buffers
+    alignas(common::cacheLinesSze) std::atomic<unsigned long long> tail_{0ULL}; // written buffers
+    std::atomic<size_t> synced_{0UL}; // bytes of the current (unpublished) buffer the writer may take
+
+    // Writer side
+    std::atomic<unsigned long long> nbWrites_{0ULL}, nbTaken_{0ULL}, nbBytes_{0ULL}, nbErrors_{0ULL};
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> stop_{false};
+    std::mutex mutex_;
+    std::condition_variable wakeUp_;
+    std::thread writer_;
+};
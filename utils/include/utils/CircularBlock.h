@@ -1,6 +1,7 @@
 #pragma once
 
 #include "utils/Common.h"
+#include "utils/WaitStrategy.h"
 
 #include <atomic>
 #include <array>
@@ -8,7 +9,7 @@
 using namespace common;
 
 // !! Only One publisher / One Listener !!
-// Could consider yielding instead of spin loop
+// Listener waits when empty, publisher when full, both with the same wait strategy
 
 template <typename T, size_t _BlockCapacity = 262'144>
 class CircularBlock
@@ -27,29 +28,55 @@ public:
     CircularBlock(const CircularBlock&) = delete;
     CircularBlock& operator=(const CircularBlock&) = delete;
     
+    // Set before publisher and listener start (default BUSY_SPIN)
+    void setWaitStrategy(WaitStrategy::Mode mode)
+    {
+        dataWait_.setMode(mode);
+        roomWait_.setMode(mode);
+    }
+    
     void fill(T&& data)
     {
-        while (size_.load(std::memory_order::memory_order_acquire) >=  CAPACITY-1) // spin loop
-            if (unlikely(dontSpin_)) return;
+        auto attempt = 0U;
+        while (size_.load(std::memory_order::memory_order_acquire) >=  CAPACITY-1)
+        {
+            if (unlikely(dontSpin_.load(std::memory_order::memory_order_acquire))) return;
+            roomWait_.wait(attempt, [this]() { return size_.load(std::memory_order::memory_order_acquire) < CAPACITY-1 || dontSpin_.load(std::memory_order::memory_order_acquire); });
+        }
         if (++last_ == CAPACITY) last_ = 0;
         array_[last_] = std::forward<T>(data);
         size_.fetch_add(1, std::memory_order::memory_order_release);
+        dataWait_.notify();
     }
     
     auto&& empty()
     {
         static T nodata;
-        while (size_.load(std::memory_order::memory_order_acquire) == 0) // spin loop
-            if (unlikely(dontSpin_)) return std::move(nodata);
+        auto attempt = 0U;
+        while (size_.load(std::memory_order::memory_order_acquire) == 0)
+        {
+            // Emptiness checked again once stopped: publications made before dontSpin() are never missed
+            if (unlikely(dontSpin_.load(std::memory_order::memory_order_acquire)) &&
+                0 == size_.load(std::memory_order::memory_order_acquire)) return std::move(nodata);
+            dataWait_.wait(attempt, [this]() { return size_.load(std::memory_order::memory_order_acquire) != 0 || dontSpin_.load(std::memory_order::memory_order_acquire); });
+        }
         if (++first_ == CAPACITY) first_ = 0;
         size_.fetch_sub(1, std::memory_order::memory_order_release);
+        roomWait_.notify();
         return std::move(array_[first_]);
     }
     
-    void dontSpin() { dontSpin_ = true; }
+    void dontSpin()
+    {
+        dontSpin_.store(true, std::memory_order::memory_order_release);
+        dataWait_.wake();
+        roomWait_.wake();
+    }
 
 protected:
-    bool dontSpin_ = false;
+    std::atomic<bool> dontSpin_{false};
+    WaitStrategy dataWait_; // listener side
+    WaitStrategy roomWait_; // publisher side
     size_t first_ = CAPACITY-1;
     size_t last_ = CAPACITY-1;
     std::atomic<size_t> size_{0UL};
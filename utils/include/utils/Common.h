@@ -58,7 +58,8 @@ namespace common
     static constexpr int nbCharOfOrderPrice = nbChar(maxOrderPrice);
     static constexpr int nbCharOfPricePrecision = 6;
     
-    struct Errors
+    // One instance per thread (feed, reporter) merged when reported: each on its own cache lines
+    struct alignas(cacheLinesSze) Errors
     {
         // Parsing
         unsigned long long commentedLines = 0;
@@ -95,6 +96,12 @@ namespace common
         unsigned long long cancelsNotMatchedQtyOrPrice = 0;
         unsigned long long bestBidEqualOrUpperThanBestAsk = 0;
         
+        // Sequencing (messages with a sequence number, see FeedHandler::setRecoveryHandler)
+        unsigned long long sequenceGaps = 0;
+        unsigned long long duplicateSequences = 0;
+        unsigned long long outOfOrderSequences = 0;
+        unsigned long long lostSequences = 0;
+        
         // Critical errors that should never happen
         unsigned long long modifiesLimitQtyTooLow = 0;
         unsigned long long modifiesLimitNotFound = 0;
@@ -126,7 +133,11 @@ namespace common
                     modifiesNotMatchedPrice +
                     cancelsWithUnknownOrderId +
                     cancelsNotMatchedQtyOrPrice +
-                    bestBidEqualOrUpperThanBestAsk;
+                    bestBidEqualOrUpperThanBestAsk +
+                    sequenceGaps +
+                    duplicateSequences +
+                    outOfOrderSequences +
+                    lostSequences;
         }
         
         unsigned long long nbCriticalErrors()
@@ -136,6 +147,45 @@ namespace common
                     cancelsLimitQtyTooLow +
                     cancelsLimitNotFound;
         }
+        
+        Errors& operator+=(const Errors& other)
+        {
+            commentedLines += other.commentedLines;
+            blankLines += other.blankLines;
+            corruptedMessages += other.corruptedMessages;
+            IncompleteMessages += other.IncompleteMessages;
+            wrongActions += other.wrongActions;
+            wrongSides += other.wrongSides;
+            negativeOrderIds += other.negativeOrderIds;
+            negativeQuantities += other.negativeQuantities;
+            negativePrices += other.negativePrices;
+            missingActions += other.missingActions;
+            missingOrderIds += other.missingOrderIds;
+            missingSides += other.missingSides;
+            missingQuantities += other.missingQuantities;
+            missingPrices += other.missingPrices;
+            zeroOrderIds += other.zeroOrderIds;
+            zeroQuantities += other.zeroQuantities;
+            zeroPrices += other.zeroPrices;
+            outOfBoundsOrderIds += other.outOfBoundsOrderIds;
+            outOfBoundsQuantities += other.outOfBoundsQuantities;
+            outOfBoundsPrices += other.outOfBoundsPrices;
+            duplicateOrderIds += other.duplicateOrderIds;
+            modifiesWithUnknownOrderId += other.modifiesWithUnknownOrderId;
+            modifiesNotMatchedPrice += other.modifiesNotMatchedPrice;
+            cancelsWithUnknownOrderId += other.cancelsWithUnknownOrderId;
+            cancelsNotMatchedQtyOrPrice += other.cancelsNotMatchedQtyOrPrice;
+            bestBidEqualOrUpperThanBestAsk += other.bestBidEqualOrUpperThanBestAsk;
+            sequenceGaps += other.sequenceGaps;
+            duplicateSequences += other.duplicateSequences;
+            outOfOrderSequences += other.outOfOrderSequences;
+            lostSequences += other.lostSequences;
+            modifiesLimitQtyTooLow += other.modifiesLimitQtyTooLow;
+            modifiesLimitNotFound += other.modifiesLimitNotFound;
+            cancelsLimitQtyTooLow += other.cancelsLimitQtyTooLow;
+            cancelsLimitNotFound += other.cancelsLimitNotFound;
+            return *this;
+        }
     };
 }
 
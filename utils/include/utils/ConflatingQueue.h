@@ -0,0 +1,156 @@
+#pragma once
+
+#include "utils/Common.h"
+#include "utils/WaitFreeQueue.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// !! Only One publisher / One Listener !!
+// Same deque + spinlock channel as WaitFreeQueue, but an entry published with a key
+// is overwritten in place by the next publication with the same key as long as the
+// listener has not read it yet => listener only sees the latest state per key.
+// One dirty bit and one slot per key (keys >= NB_KEYS are never conflated). Only keyed entries
+// are conflated, the others (e.g. trades) are queued: pending entries are bounded by NB_KEYS plus
+// the unkeyed ones.
+
+template<typename T, size_t _NbKeys = 8192>
+class ConflatingQueue
+{
+public:
+    static constexpr size_t NB_KEYS = _NbKeys;
+    static_assert(NB_KEYS > 0 && (NB_KEYS % 64) == 0, "Number of keys must be a positive multiple of 64");
+
+    ConflatingQueue() = default;
+    // Deque chunks from <arena> (allocated and freed under the lock)
+    explicit ConflatingQueue(Arena* arena) : datas_(ArenaAllocator<T>(arena)) {}
+    ~ConflatingQueue() = default;
+    ConflatingQueue(const ConflatingQueue&) = delete;
+    ConflatingQueue& operator=(const ConflatingQueue&) = delete;
+
+    // Consumer side wait once empty (default BUSY_SPIN), set before the consumer starts
+    void setWaitStrategy(WaitStrategy::Mode mode) { wait_.setMode(mode); }
+    const WaitStrategy& waitStrategy() const { return wait_; }
+
+    // Never conflated (e.g. trades)
+    void push_back(T&& data)
+    {
+        lock_.lock();
+        datas_.emplace_back(std::forward<T>(data));
+        lock_.unlock();
+        wait_.notify();
+    }
+
+    // Replace the pending entry published with the same key (if any) otherwise append it
+    void push_back(size_t key, T&& data)
+    {
+        if (unlikely(key >= NB_KEYS))
+        {
+            push_back(std::forward<T>(data));
+            return;
+        }
+        lock_.lock();
+        if (isDirty(key) && slots_[key] >= popped_)
+        {
+            datas_[slots_[key] - popped_] = std::forward<T>(data);
+            lock_.unlock();
+            ++nbConflated_;
+            return; // still pending => consumer already notified
+        }
+        datas_.emplace_back(std::forward<T>(data));
+        slots_[key] = popped_ + datas_.size() - 1;
+        lock_.unlock();
+        dirty_[key >> 6] |= (1ULL << (key & 63));
+        wait_.notify();
+    }
+
+    // Keys in [first, last) changed meaning (e.g. levels shifted): next publications must be appended
+    void invalidate(size_t first, size_t last)
+    {
+        if (last > NB_KEYS) last = NB_KEYS;
+        for (; first < last && (first & 63); ++first)
+            dirty_[first >> 6] &= ~(1ULL << (first & 63));
+        for (; first + 64 <= last; first += 64)
+            dirty_[first >> 6] = 0ULL;
+        for (; first < last; ++first)
+            dirty_[first >> 6] &= ~(1ULL << (first & 63));
+    }
+
+    T pop_front()
+    {
+        if (unlikely(!lockNotEmpty())) return T();
+        T data = std::move(datas_.front()); // by value: front() is freed by pop_front()
+        datas_.pop_front();
+        ++popped_;
+        lock_.unlock();
+        return data;
+    }
+    
+    // Drain up to <max> available entries with one lock (waits like pop_front() while empty), 0 => end
+    size_t pop_front(T* datas, size_t max)
+    {
+        if (unlikely(!lockNotEmpty())) return 0UL;
+        const auto nb = std::min(max, datas_.size());
+        std::move(datas_.begin(), datas_.begin() + static_cast<std::ptrdiff_t>(nb), datas);
+        datas_.erase(datas_.begin(), datas_.begin() + static_cast<std::ptrdiff_t>(nb));
+        popped_ += nb;
+        lock_.unlock();
+        return nb;
+    }
+    
+    // Consumer side: nothing to pop yet (does not wait)
+    bool empty()
+    {
+        lock_.lock();
+        const bool empty = datas_.empty();
+        lock_.unlock();
+        return empty;
+    }
+    
+    void dontSpin()
+    {
+        dontSpin_.store(true, std::memory_order_release);
+        wait_.wake();
+    }
+
+    auto nbConflated() const { return nbConflated_; }
+
+private:
+    // Lock taken once not empty, false => empty and stopped (lock released)
+    bool lockNotEmpty()
+    {
+        auto attempt = 0U;
+        do
+        {
+            // Read (acquire) before emptiness to never miss the publications made before dontSpin()
+            const bool lastCheck = dontSpin_.load(std::memory_order_acquire);
+            lock_.lock();
+            if (!datas_.empty()) return true;
+            lock_.unlock();
+            if (unlikely(lastCheck)) return false;
+            wait_.wait(attempt, [this]()
+            {
+                lock_.lock();
+                const bool ready = !datas_.empty();
+                lock_.unlock();
+                return ready || dontSpin_.load(std::memory_order_acquire);
+            });
+        } while(1);
+    }
+
+    bool isDirty(size_t key) const { return (dirty_[key >> 6] >> (key & 63)) & 1ULL; }
+
+    std::atomic<bool> dontSpin_{false};
+    WaitStrategy wait_;
+
+    std::deque<T, ArenaAllocator<T>> datas_;
+    unsigned long long popped_ = 0ULL; // absolute index of datas_.front()
+
+    // Publisher side only
+    std::array<uint64_t, NB_KEYS/64> dirty_{};
+    std::array<unsigned long long, NB_KEYS> slots_{}; // absolute index of the pending entry
+    unsigned long long nbConflated_ = 0ULL;
+
+    SpinLock lock_;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <algorithm>
+#include <vector>
+
+// Fenwick (binary indexed) tree of non negative values: point updates, prefix sums and
+// search of the first prefix reaching a sum, all in O(log n) on a contiguous array.
+
+template <typename T>
+class FenwickTree
+{
+public:
+    explicit FenwickTree(size_t size = 0) { resize(size); }
+
+    // Size rounded to a power of two (for lowerBound), all values reset to zero
+    void resize(size_t size)
+    {
+        size_ = 1;
+        while (size_ < size) size_ <<= 1;
+        tree_.assign(size_ + 1, T());
+    }
+    void clear() { std::fill(tree_.begin(), tree_.end(), T()); }
+    size_t size() const { return size_; }
+
+    // value[i] += delta (delta may be negative, as long as values stay non negative)
+    FORCE_INLINE void add(size_t i, T delta)
+    {
+        for (++i; i <= size_; i += i & (~i + 1)) tree_[i] += delta;
+    }
+
+    // Sum of values[0..i] (i included, whole tree when i >= size)
+    FORCE_INLINE T prefix(size_t i) const
+    {
+        if (unlikely(i >= size_)) i = size_ - 1;
+        T sum = T();
+        for (++i; i > 0; i -= i & (~i + 1)) sum += tree_[i];
+        return sum;
+    }
+
+    T total() const { return tree_[size_]; }
+
+    // First i such that prefix(i) >= sum (size() when total() < sum)
+    FORCE_INLINE size_t lowerBound(T sum) const
+    {
+        if (unlikely(!(T() < sum))) return 0;
+        size_t pos = 0;
+        for (auto step = size_; step > 0; step >>= 1)
+        {
+            if (pos + step <= size_ && tree_[pos + step] < sum)
+            {
+                pos += step;
+                sum -= tree_[pos];
+            }
+        }
+        return pos;
+    }
+
+private:
+    size_t size_ = 1;
+    std::vector<T> tree_; // 1-based: tree_[i] sums values (i - lowbit(i), i]
+};
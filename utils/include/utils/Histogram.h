@@ -0,0 +1,87 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <array>
+#include <limits>
+
+// HDR style histogram of unsigned values (e.g. TSC ticks):
+//   - values below 2^SUB_BUCKET_BITS are counted exactly,
+//   - above, each power of 2 is split in 2^SUB_BUCKET_BITS linear sub-buckets,
+// so any percentile is known with a relative error below 1/2^SUB_BUCKET_BITS
+// (3% by default) for a fixed memory (no allocation when recording).
+
+template <unsigned int _SubBucketBits = 5>
+class Histogram
+{
+public:
+    static constexpr unsigned int SUB_BUCKET_BITS = _SubBucketBits;
+    static constexpr unsigned long long SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    static constexpr size_t NB_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+    static_assert(SUB_BUCKET_BITS > 0 && SUB_BUCKET_BITS < 16, "Sub-buckets bits must be in [1, 15]");
+
+    FORCE_INLINE void record(unsigned long long value)
+    {
+        ++counts_[index(value)];
+        ++count_;
+        sum_ += value;
+        if (unlikely(value < min_)) min_ = value;
+        if (unlikely(value > max_)) max_ = value;
+    }
+
+    Histogram& operator+=(const Histogram& other)
+    {
+        for (auto i = 0UL; i < NB_BUCKETS; ++i) counts_[i] += other.counts_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        if (other.min_ < min_) min_ = other.min_;
+        if (other.max_ > max_) max_ = other.max_;
+        return *this;
+    }
+
+    void reset() { *this = Histogram(); }
+
+    unsigned long long count() const { return count_; }
+    unsigned long long min() const { return count_ ? min_ : 0ULL; }
+    unsigned long long max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0; }
+
+    // Highest value of the bucket holding the given percentile (in [0, 100])
+    unsigned long long percentile(double p) const
+    {
+        if (unlikely(0ULL == count_)) return 0ULL;
+        auto rank = static_cast<unsigned long long>(p / 100.0 * static_cast<double>(count_) + 0.5);
+        if (rank < 1ULL) rank = 1ULL;
+        auto seen = 0ULL;
+        for (auto i = 0UL; i < NB_BUCKETS; ++i)
+        {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(highest(i), max_);
+        }
+        return max_;
+    }
+
+private:
+    static FORCE_INLINE size_t index(unsigned long long value)
+    {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        const auto msb = 63U - static_cast<unsigned int>(__builtin_clzll(value));
+        const auto shift = msb - SUB_BUCKET_BITS;
+        const auto sub = (value >> shift) & (SUB_BUCKETS - 1);
+        return static_cast<size_t>((shift + 1) * SUB_BUCKETS + sub);
+    }
+    static unsigned long long highest(size_t i)
+    {
+        if (i < SUB_BUCKETS) return i;
+        const auto shift = i / SUB_BUCKETS - 1;
+        const auto sub = i % SUB_BUCKETS;
+        const auto lowest = (SUB_BUCKETS + sub) << shift;
+        return lowest + ((1ULL << shift) - 1);
+    }
+
+    std::array<unsigned long long, NB_BUCKETS> counts_{};
+    unsigned long long count_ = 0ULL;
+    unsigned long long sum_ = 0ULL;
+    unsigned long long min_ = std::numeric_limits<unsigned long long>::max();
+    unsigned long long max_ = 0ULL;
+};
@@ -33,6 +33,9 @@ public:
     auto getSide() { return side_; }
     auto getPrice() { return price_; }
     auto getQty() { return qty_; }
+    // Optional trailing fields of the extended format (0 when absent)
+    auto getTimestamp() { return timestamp_; }
+    auto getSequence() { return sequence_; }
     
 private:
     char action_ = 0;
@@ -40,5 +43,7 @@ private:
     char side_ = 0;
     Price price_ = 0.0;
     Quantity qty_ = 0;
+    unsigned long long timestamp_ = 0;
+    unsigned long long sequence_ = 0;
 };
 
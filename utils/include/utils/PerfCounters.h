@@ -0,0 +1,83 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <array>
+
+#include <linux/perf_event.h>
+
+// Hardware counters of the calling thread (perf_event_open, user space only):
+// cycles, instructions, L1 data read misses, last level cache misses and branch misses.
+// Read with rdpmc when the kernel allows it (a few ns, no system call),
+// otherwise with read() on each counter (around 1 us).
+// An event not supported by the cpu (e.g. in a VM) stays at 0.
+
+class PerfCounters
+{
+public:
+    enum Event : unsigned int
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        NB_EVENTS
+    };
+    using Sample = std::array<unsigned long long, NB_EVENTS>;
+
+    PerfCounters() = default;
+    ~PerfCounters() { close(); }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Count for the calling thread only, false if not permitted (see /proc/sys/kernel/perf_event_paranoid)
+    bool open();
+    void close();
+    bool isOpen() const { return -1 != fds_[CYCLES]; }
+    bool isSupported(Event event) const { return -1 != fds_[event]; }
+    static const char* name(Event event);
+
+    FORCE_INLINE void read(Sample& sample) const
+    {
+        for (auto i = 0U; i < NB_EVENTS; ++i) sample[i] = read(i);
+    }
+
+private:
+    FORCE_INLINE unsigned long long read(unsigned int event) const
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        const auto* page = pages_[event];
+        if (likely(page != nullptr))
+        {
+            // Seqlock against the kernel rescheduling the counter
+            unsigned int seq;
+            unsigned long long count;
+            do
+            {
+                seq = page->lock;
+                asm volatile("" ::: "memory");
+                const auto index = page->index;
+                count = static_cast<unsigned long long>(page->offset);
+                if (likely(page->cap_user_rdpmc && index))
+                {
+                    unsigned int low, high;
+                    asm volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(index - 1));
+                    const auto shift = 64U - page->pmc_width;
+                    auto pmc = static_cast<long long>((static_cast<unsigned long long>(high) << 32) | low);
+                    pmc = static_cast<long long>(static_cast<unsigned long long>(pmc) << shift) >> shift;
+                    count += static_cast<unsigned long long>(pmc);
+                }
+                else count = readSyscall(event);
+                asm volatile("" ::: "memory");
+            } while (unlikely(page->lock != seq));
+            return count;
+        }
+#endif
+        return readSyscall(event);
+    }
+    unsigned long long readSyscall(unsigned int event) const;
+
+    std::array<int, NB_EVENTS> fds_{{-1, -1, -1, -1, -1}};
+    std::array<perf_event_mmap_page*, NB_EVENTS> pages_{};
+};
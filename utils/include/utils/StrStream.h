@@ -23,6 +23,7 @@ public:
         {
             delete [] strOver_;
             strOver_ = nullptr;
+            sizeOver_ = 0;
         }
     }
     
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <chrono>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Time Stamp Counter: cheapest timestamp (no serialization, no system call).
+// Ticks are converted in nanoseconds with a ratio calibrated once against steady_clock
+// (invariant TSC assumed, i.e. constant rate whatever the frequency scaling).
+// Falls back on steady_clock nanoseconds when no TSC.
+
+namespace tsc
+{
+    FORCE_INLINE unsigned long long now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // First call takes around 10 ms (do it before the critical path)
+    inline double nsPerTick()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        static const double ratio = []()
+        {
+            auto start = std::chrono::steady_clock::now();
+            const auto ticks = now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            const auto elapsedTicks = now() - ticks;
+            const auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            return elapsedTicks ? static_cast<double>(elapsedNs) / static_cast<double>(elapsedTicks) : 1.0;
+        }();
+        return ratio;
+#else
+        return 1.0;
+#endif
+    }
+
+    FORCE_INLINE double toNs(unsigned long long ticks)
+    {
+        return static_cast<double>(ticks) * nsPerTick();
+    }
+}
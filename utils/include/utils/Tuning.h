@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+// Runtime tuning of a latency sensitive process (Linux):
+// thread affinity and real-time scheduling, memory locking, prefaulting and huge pages.
+// Every function returns false (errno set) when refused, e.g. missing CAP_SYS_NICE/CAP_IPC_LOCK
+// or no huge page reserved, so the caller can go on untuned.
+
+namespace tuning
+{
+    // Calling thread only
+    bool pinThread(int cpu);
+    bool setFifo(int priority); // SCHED_FIFO, 1 (lowest) to 99
+
+    // Current and future pages stay in RAM (no major fault, no swap)
+    bool lockMemory();
+
+    // Heap pages touched once and kept by malloc (no trim, no mmap for big blocks), so later
+    // allocations up to <bytes> do not fault; stack pages of the calling thread are touched too
+    void prefaultHeap(size_t bytes);
+    void prefaultStack(size_t bytes = 256 * 1024);
+
+    // Anonymous read/write mapping, prefaulted: explicit huge pages (MAP_HUGETLB, 1 GB ones first
+    // for 1 GB or more) when reserved (/proc/sys/vm/nr_hugepages, /sys/kernel/mm/hugepages),
+    // otherwise regular pages advised for transparent huge pages
+    struct Mapping
+    {
+        void* data_ = nullptr;
+        size_t size_ = 0;   // rounded up to the page size
+        bool huge_ = false; // MAP_HUGETLB
+    };
+    bool mapAnonymous(size_t size, bool hugePages, Mapping& mapping);
+    void unmap(Mapping& mapping);
+
+    static constexpr size_t HUGE_PAGE_SIZE = 2UL * 1024 * 1024;
+    static constexpr size_t GIGANTIC_PAGE_SIZE = 1024UL * 1024 * 1024;
+}
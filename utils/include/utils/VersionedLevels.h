@@ -0,0 +1,253 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// !! Only One writer / Many readers !!
+// Sorted levels shared between the thread owning them (writer) and readers without lock:
+//   - values are contiguous in the middle of a bigger array and insert/erase shift the
+//     shorter side (like a deque), they are recentered in place when an end is reached,
+//   - the array is split in pages of LEVELS_PER_PAGE values, each with its own version
+//     (odd while the writer is modifying it, seqlock style),
+//   - when more than half full, a bigger array is published (RCU style) and the previous
+//     ones are only released at destruction, so a reader never reads freed memory.
+// Writer API is the one of a sorted container, readers only use snapshot().
+
+template <typename T, size_t _LevelsPerPage = 64>
+class VersionedLevels
+{
+public:
+    static constexpr size_t LEVELS_PER_PAGE = _LevelsPerPage;
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    static_assert(LEVELS_PER_PAGE > 0, "Pages can't be empty");
+
+    using const_iterator = const T*;
+
+    // Reader side copy, only pages modified since the previous snapshot are copied again
+    class Snapshot
+    {
+    public:
+        size_t size() const { return size_; }
+        bool empty() const { return 0UL == size_; }
+        const T& operator[](size_t i) const { return values_[first_+i]; }
+        const T* begin() const { return values_.data() + first_; }
+        const T* end() const { return values_.data() + first_ + size_; }
+
+    private:
+        friend class VersionedLevels;
+        const void* storage_ = nullptr;
+        std::vector<T> values_;          // mirror of the whole shared array
+        std::vector<unsigned int> copied_; // version of each page when copied
+        size_t first_ = 0;
+        size_t size_ = 0;
+    };
+
+    VersionedLevels(size_t capacity = DEFAULT_CAPACITY)
+    {
+        if (unlikely(capacity < 2)) capacity = DEFAULT_CAPACITY;
+        storages_.emplace_back(std::make_unique<Storage>(capacity));
+        values_ = storages_.back()->values_.get();
+        first_ = capacity / 2;
+        current_.store(storages_.back().get(), std::memory_order_release);
+        publishRange();
+    }
+    ~VersionedLevels() = default;
+    VersionedLevels(const VersionedLevels&) = delete;
+    VersionedLevels& operator=(const VersionedLevels&) = delete;
+
+    // Writer side
+
+    size_t size() const { return size_; }
+    bool empty() const { return 0UL == size_; }
+    size_t capacity() const { return storages_.back()->capacity_; }
+
+    const_iterator begin() const { return values_ + first_; }
+    const_iterator end() const { return values_ + first_ + size_; }
+
+    const T& operator[](size_t i) const { return values_[first_+i]; }
+    const T& front() const { return values_[first_]; }
+
+    void insert(const_iterator pos, const T& value)
+    {
+        const auto i = static_cast<size_t>(pos - begin());
+        const bool shiftDown = (i < size_/2);
+        // Never shift the longer side: recentering is amortized over the next inserts
+        if (unlikely(shiftDown ? 0UL == first_ : first_ + size_ == capacity())) recenter(size_ + 1);
+        if (shiftDown)
+        {
+            // Shift [0, i) one step down
+            beginWrite(first_-1, first_+i-1);
+            std::move(values_+first_, values_+first_+i, values_+first_-1);
+            values_[first_+i-1] = value;
+            --first_;
+            ++size_;
+            publishRange();
+            endWrite(first_, first_+i);
+            return;
+        }
+        // Shift [i, size) one step up
+        beginWrite(first_+i, first_+size_);
+        std::move_backward(values_+first_+i, values_+first_+size_, values_+first_+size_+1);
+        values_[first_+i] = value;
+        ++size_;
+        publishRange();
+        endWrite(first_+i, first_+size_-1);
+    }
+
+    void erase(const_iterator pos)
+    {
+        const auto i = static_cast<size_t>(pos - begin());
+        if (i < size_/2)
+        {
+            // Shift [0, i) one step up
+            beginWrite(first_, first_+i);
+            std::move_backward(values_+first_, values_+first_+i, values_+first_+i+1);
+            ++first_;
+            --size_;
+            publishRange();
+            endWrite(first_-1, first_+i-1);
+        }
+        else
+        {
+            // Shift (i, size) one step down
+            beginWrite(first_+i, first_+size_-1);
+            std::move(values_+first_+i+1, values_+first_+size_, values_+first_+i);
+            --size_;
+            publishRange();
+            endWrite(first_+i, first_+size_);
+        }
+    }
+
+    void set(const_iterator pos, const T& value)
+    {
+        const auto physical = static_cast<size_t>(pos - values_);
+        beginWrite(physical, physical);
+        values_[physical] = value;
+        endWrite(physical, physical);
+    }
+
+    // Reader side
+
+    // Refresh snapshot page by page (re-copying only the pages modified meanwhile).
+    // Return false if it is still not consistent as a whole after maxRounds (each page is always).
+    bool snapshot(Snapshot& snapshot, unsigned int maxRounds = 8) const
+    {
+        static constexpr unsigned int notCopied = 1U; // odd => never equal to a stable version
+        auto consistent = false;
+        for (auto round = 0U; round < maxRounds && !consistent; ++round)
+        {
+            // Range before storage: a new range is never published before its storage
+            const auto range = range_.load(std::memory_order_acquire);
+            const Storage* storage = current_.load(std::memory_order_acquire);
+            const auto capacity = storage->capacity_;
+            if (storage != snapshot.storage_)
+            {
+                snapshot.storage_ = storage;
+                snapshot.values_.resize(capacity);
+                snapshot.copied_.assign(nbPages(capacity), notCopied);
+            }
+            snapshot.first_ = static_cast<size_t>(range >> 32);
+            snapshot.size_ = static_cast<size_t>(range & 0xFFFFFFFFULL);
+            if (unlikely(0UL == snapshot.size_)) return true;
+
+            const auto firstPage = snapshot.first_ / LEVELS_PER_PAGE;
+            const auto lastPage = (snapshot.first_ + snapshot.size_ - 1) / LEVELS_PER_PAGE;
+            for (auto page = firstPage; page <= lastPage; ++page)
+            {
+                const auto version = storage->versions_[page].load(std::memory_order_acquire);
+                if (version == snapshot.copied_[page] || (version & 1U)) continue;
+                const auto first = page * LEVELS_PER_PAGE;
+                const auto last = std::min(first + LEVELS_PER_PAGE, capacity);
+                std::copy(&storage->values_[first], &storage->values_[last], &snapshot.values_[first]);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                snapshot.copied_[page] = (storage->versions_[page].load(std::memory_order_relaxed) == version) ? version : notCopied;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            consistent = (range_.load(std::memory_order_relaxed) == range &&
+                          current_.load(std::memory_order_relaxed) == storage);
+            for (auto page = firstPage; consistent && page <= lastPage; ++page)
+            {
+                consistent = (storage->versions_[page].load(std::memory_order_relaxed) == snapshot.copied_[page]);
+            }
+        }
+        return consistent;
+    }
+
+private:
+    static constexpr size_t nbPages(size_t capacity) { return (capacity + LEVELS_PER_PAGE - 1) / LEVELS_PER_PAGE; }
+
+    struct Storage
+    {
+        Storage(size_t capacity)
+            : capacity_(capacity), values_(new T[capacity]), versions_(new std::atomic<unsigned int>[nbPages(capacity)])
+        {
+            for (auto page = 0UL; page < nbPages(capacity); ++page) versions_[page].store(0U, std::memory_order_relaxed);
+        }
+        const size_t capacity_;
+        std::unique_ptr<T[]> values_;
+        std::unique_ptr<std::atomic<unsigned int>[]> versions_;
+    };
+
+    FORCE_INLINE void publishRange()
+    {
+        range_.store((static_cast<uint64_t>(first_) << 32) | static_cast<uint64_t>(size_), std::memory_order_release);
+    }
+
+    // Pages holding physical indexes [first, last] become odd (writing) then even again
+    void beginWrite(size_t first, size_t last)
+    {
+        auto& versions = storages_.back()->versions_;
+        for (auto page = first / LEVELS_PER_PAGE; page <= last / LEVELS_PER_PAGE; ++page)
+        {
+            versions[page].store(versions[page].load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    void endWrite(size_t first, size_t last)
+    {
+        auto& versions = storages_.back()->versions_;
+        for (auto page = first / LEVELS_PER_PAGE; page <= last / LEVELS_PER_PAGE; ++page)
+        {
+            versions[page].store(versions[page].load(std::memory_order_relaxed) + 1U, std::memory_order_release);
+        }
+    }
+
+    // Center levels in place (or in a bigger array when more than half full) before inserting
+    void recenter(size_t newSize)
+    {
+        auto capacity = this->capacity();
+        if (newSize > capacity / 2)
+        {
+            while (newSize > capacity / 2) capacity *= 2;
+            storages_.emplace_back(std::make_unique<Storage>(capacity));
+            const auto first = (capacity - size_) / 2;
+            std::copy(values_+first_, values_+first_+size_, storages_.back()->values_.get()+first);
+            values_ = storages_.back()->values_.get();
+            first_ = first;
+            current_.store(storages_.back().get(), std::memory_order_release);
+            publishRange();
+            return;
+        }
+        const auto first = (capacity - size_) / 2;
+        const auto low = std::min(first, first_), high = std::max(first, first_) + size_ - 1;
+        beginWrite(low, high);
+        if (first < first_) std::move(values_+first_, values_+first_+size_, values_+first);
+        else std::move_backward(values_+first_, values_+first_+size_, values_+first+size_);
+        first_ = first;
+        publishRange();
+        endWrite(low, high);
+    }
+
+    // Writer side only (previous storages kept for readers)
+    std::vector<std::unique_ptr<Storage>> storages_;
+    T* values_ = nullptr;
+    size_t first_ = 0;
+    size_t size_ = 0;
+
+    std::atomic<const Storage*> current_{nullptr};
+    std::atomic<uint64_t> range_{0ULL}; // first (32 high bits) and size (32 low bits)
+};
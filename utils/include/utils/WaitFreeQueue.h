@@ -1,5 +1,9 @@
 #pragma once
 
+#include "utils/Arena.h"
+#include "utils/WaitStrategy.h"
+
+#include <algorithm>
 #include <atomic>
 #include <deque>
 
@@ -12,8 +16,16 @@ struct SpinLock
     }
     FORCE_INLINE void lock()
     {
+        auto attempt = 0U;
         while(std::atomic_exchange_explicit(&lock_, true, std::memory_order_acquire))
-             ; // spin until acquired
+        {
+            // Spin on a read (no cache line ping-pong), yield when the holder looks preempted
+            while(lock_.load(std::memory_order_relaxed))
+            {
+                if (likely(++attempt <= WaitStrategy::SPINS)) cpuRelax();
+                else std::this_thread::yield();
+            }
+        }
     }
 };
 
@@ -23,40 +35,86 @@ class WaitFreeQueue
 public:
     
     WaitFreeQueue() = default;
+    // Deque chunks from <arena> (allocated and freed under the lock)
+    explicit WaitFreeQueue(Arena* arena) : datas_(ArenaAllocator<T>(arena)) {}
     ~WaitFreeQueue() = default;
     WaitFreeQueue(const WaitFreeQueue&) = delete;
     WaitFreeQueue& operator=(const WaitFreeQueue&) = delete;
     
+    // Consumer side wait once empty (default BUSY_SPIN), set before the consumer starts
+    void setWaitStrategy(WaitStrategy::Mode mode) { wait_.setMode(mode); }
+    const WaitStrategy& waitStrategy() const { return wait_; }
+    
     void push_back(T&& data)
     {
         lock_.lock();
         datas_.emplace_back(std::forward<T>(data));
         lock_.unlock();
+        wait_.notify();
     }
     
-    auto&& pop_front()
+    T pop_front()
     {
-        static T nodata;
+        if (unlikely(!lockNotEmpty())) return T();
+        T data = std::move(datas_.front()); // by value: front() is freed by pop_front()
+        datas_.pop_front();
+        lock_.unlock();
+        return data;
+    }
+    
+    // Drain up to <max> available entries with one lock (waits like pop_front() while empty), 0 => end
+    size_t pop_front(T* datas, size_t max)
+    {
+        if (unlikely(!lockNotEmpty())) return 0UL;
+        const auto nb = std::min(max, datas_.size());
+        std::move(datas_.begin(), datas_.begin() + static_cast<std::ptrdiff_t>(nb), datas);
+        datas_.erase(datas_.begin(), datas_.begin() + static_cast<std::ptrdiff_t>(nb));
+        lock_.unlock();
+        return nb;
+    }
+    
+    // Consumer side: nothing to pop yet (does not wait)
+    bool empty()
+    {
+        lock_.lock();
+        const bool empty = datas_.empty();
+        lock_.unlock();
+        return empty;
+    }
+    
+    void dontSpin()
+    {
+        dontSpin_.store(true, std::memory_order_release);
+        wait_.wake();
+    }
+    
+private:
+    // Lock taken once not empty, false => empty and stopped (lock released)
+    bool lockNotEmpty()
+    {
+        auto attempt = 0U;
         do
         {
+            // Read (acquire) before emptiness to never miss the publications made before dontSpin()
+            const bool lastCheck = dontSpin_.load(std::memory_order_acquire);
             lock_.lock();
-            if (!datas_.empty()) break;
+            if (!datas_.empty()) return true;
             lock_.unlock();
-//            std::this_thread::yield();
-            if (unlikely(dontSpin_)) return std::move(nodata);
+            if (unlikely(lastCheck)) return false;
+            wait_.wait(attempt, [this]()
+            {
+                lock_.lock();
+                const bool ready = !datas_.empty();
+                lock_.unlock();
+                return ready || dontSpin_.load(std::memory_order_acquire);
+            });
         } while(1);
-        T&& data = std::move(datas_.front());
-        datas_.pop_front();
-        lock_.unlock();
-        return std::forward<T>(data);
     }
     
-    void dontSpin() { dontSpin_ = true; }
-    
-private:
-    bool dontSpin_ = false;
+    std::atomic<bool> dontSpin_{false};
+    WaitStrategy wait_;
     
-    std::deque<T> datas_;
+    std::deque<T, ArenaAllocator<T>> datas_;
     
     SpinLock lock_;
 };
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "utils/Common.h"
+
+#include <atomic>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// !! One waiting thread / One notifying thread !!
+// How a consumer waits for data (or a producer for room) once nothing is ready:
+//   - BUSY_SPIN: `pause` loop, lowest latency, burns its core (dedicated cpu),
+//   - SPIN_YIELD: `pause` loop for SPINS attempts then sched_yield, gives the cpu back to
+//     other ready threads but never sleeps,
+//   - SPIN_PARK: `pause` then yields, then sleeps on a futex until notified (idle => no cpu).
+// Notifier only pays a fence and a load after each publication in SPIN_PARK mode.
+// Waiter protocol (Dekker style): parked flag set, fence, ready() checked again, then
+// futex wait on the epoch read before => a notification can't be missed.
+
+FORCE_INLINE void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+class WaitStrategy
+{
+public:
+    enum class Mode : unsigned char { BUSY_SPIN, SPIN_YIELD, SPIN_PARK };
+    static constexpr unsigned int SPINS = 4096; // pause attempts before yielding
+    static constexpr unsigned int YIELDS = 64;  // yield attempts before parking
+
+    // Names used on command lines: spin, yield, park
+    static bool parse(const char* name, Mode& mode);
+    static const char* name(Mode mode);
+
+    void setMode(Mode mode) { mode_ = mode; }
+    Mode mode() const { return mode_; }
+
+    // Waiter: called each time nothing is ready, <attempt> starts at 0 for each new wait,
+    // ready() is only evaluated before parking (thread safe check of the condition)
+    template <typename Ready>
+    FORCE_INLINE void wait(unsigned int& attempt, Ready&& ready)
+    {
+        ++attempt;
+        if (likely(Mode::BUSY_SPIN == mode_ || attempt <= SPINS)) cpuRelax();
+        else if (Mode::SPIN_YIELD == mode_ || attempt <= SPINS + YIELDS) std::this_thread::yield();
+        else
+        {
+            const auto epoch = epoch_.load(std::memory_order_acquire);
+            parked_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!ready())
+            {
+                park(epoch);
+                ++nbParks_;
+            }
+            parked_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // Notifier: after each publication (outside of any lock)
+    FORCE_INLINE void notify()
+    {
+        if (likely(mode_ != Mode::SPIN_PARK)) return;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (unlikely(parked_.load(std::memory_order_relaxed))) wake();
+    }
+    // Whatever the mode (e.g. stop request)
+    void wake();
+
+    unsigned long long nbParks() const { return nbParks_; } // waiter side
+
+private:
+    void park(unsigned int epoch);
+
+    Mode mode_ = Mode::BUSY_SPIN;
+    unsigned long long nbParks_ = 0ULL;
+    alignas(common::cacheLinesSze) std::atomic<unsigned int> epoch_{0U}; // futex word
+    std::atomic<bool> parked_{false};
+};
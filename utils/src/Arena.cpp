@@ -0,0 +1,15 @@
+#include "utils/Arena.h"
+
+Arena::~Arena()
+{
+    tuning::unmap(mapping_);
+}
+
+bool Arena::reserve(size_t bytes, bool hugePages)
+{
+    if (mapping_.data_ != nullptr) return false; // blocks may still be in use
+    if (!tuning::mapAnonymous(bytes, hugePages, mapping_)) return false;
+    begin_ = current_ = static_cast<char*>(mapping_.data_);
+    end_ = begin_ + mapping_.size_;
+    return true;
+}
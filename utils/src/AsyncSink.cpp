@@ -0,0 +1,204 @@
+#include "utils/AsyncSink.h"
+
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+
+AsyncSink::AsyncSink(int fd, size_t nbBuffers, size_t bufferSize)
+    : fd_(fd),
+      nbBuffers_(nbBuffers < 2 ? 2 : nbBuffers),
+      bufferSize_(bufferSize ? bufferSize : DEFAULT_BUFFER_SIZE),
+      buffers_(new char[nbBuffers_ * bufferSize_]),
+      sizes_(new size_t[nbBuffers_])
+{
+    // Prefault the ring: no page fault while formatting
+    memset(buffers_.get(), 0, nbBuffers_ * bufferSize_);
+    setp(&buffers_[0], &buffers_[0] + bufferSize_);
+    writer_ = std::thread(&AsyncSink::run, this);
+}
+
+AsyncSink::~AsyncSink()
+{
+    close();
+}
+
+void AsyncSink::close()
+{
+    if (!writer_.joinable()) return;
+    publish();
+    stop_.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakeUp_.notify_one();
+    }
+    writer_.join();
+}
+
+AsyncSink::Stats AsyncSink::stats() const
+{
+    Stats stats = stats_;
+    stats.nbWrites_ = nbWrites_.load(std::memory_order_relaxed);
+    stats.nbTaken_ = nbTaken_.load(std::memory_order_relaxed);
+    stats.nbBytes_ = nbBytes_.load(std::memory_order_relaxed);
+    stats.nbErrors_ = nbErrors_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Hand the current buffer over to the writer and wait (if needed) for the next one to be free
+void AsyncSink::publish()
+{
+    const auto len = static_cast<size_t>(pptr() - pbase());
+    if (0UL == len) return;
+    auto head = head_.load(std::memory_order_relaxed);
+    sizes_[head % nbBuffers_] = len;
+    synced_.store(0UL, std::memory_order_relaxed); // next buffer (ordered by head_)
+    head_.store(++head, std::memory_order_release);
+    ++stats_.nbBuffers_;
+    if (sleeping_.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakeUp_.notify_one();
+    }
+
+    auto pending = head - tail_.load(std::memory_order_acquire);
+    if (pending > stats_.maxPending_) stats_.maxPending_ = pending;
+    if (unlikely(pending >= nbBuffers_))
+    {
+        ++stats_.nbStalls_;
+        auto start = std::chrono::steady_clock::now();
+        while (head - tail_.load(std::memory_order_acquire) >= nbBuffers_)
+            std::this_thread::yield();
+        stats_.stallNs_ += static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+    char* next = &buffers_[(head % nbBuffers_) * bufferSize_];
+    setp(next, next + bufferSize_);
+}
+
+AsyncSink::int_type AsyncSink::overflow(int_type c)
+{
+    publish();
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+    return c;
+}
+
+std::streamsize AsyncSink::xsputn(const char* s, std::streamsize n)
+{
+    auto left = n;
+    while (left > 0)
+    {
+        if (pptr() == epptr()) publish();
+        const auto len = std::min<std::streamsize>(left, epptr() - pptr());
+        memcpy(pptr(), s, static_cast<size_t>(len));
+        pbump(static_cast<int>(len));
+        s += len;
+        left -= len;
+    }
+    return n;
+}
+
+int AsyncSink::sync()
+{
+    const auto len = static_cast<size_t>(pptr() - pbase());
+    if (0UL == len) return 0;
+    if (head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire)) publish();
+    else
+    {
+        // Writer busy => keep batching, it takes the synced bytes once done with the previous buffers
+        synced_.store(len, std::memory_order_release);
+        if (sleeping_.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wakeUp_.notify_one();
+        }
+    }
+    return 0;
+}
+
+void AsyncSink::run()
+{
+    static constexpr size_t maxIov = IOV_MAX < 1024 ? IOV_MAX : 1024;
+    struct iovec iov[maxIov];
+    auto tail = tail_.load(std::memory_order_relaxed);
+    auto taken = 0UL; // bytes of the buffer at tail already written
+    while (1)
+    {
+        auto head = head_.load(std::memory_order_acquire);
+        if (head == tail)
+        {
+            // Producer's current buffer: synced bytes are final, it only appends after them
+            const auto synced = synced_.load(std::memory_order_acquire);
+            if (synced > taken && head_.load(std::memory_order_relaxed) == tail)
+            {
+                iov[0].iov_base = &buffers_[(tail % nbBuffers_) * bufferSize_ + taken];
+                iov[0].iov_len = synced - taken;
+                write(iov, 1);
+                nbTaken_.fetch_add(1ULL, std::memory_order_relaxed);
+                taken = synced;
+                continue;
+            }
+            if (stop_.load(std::memory_order_acquire))
+            {
+                // Last publications may come along with stop
+                if (head_.load(std::memory_order_acquire) == tail) break;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_.store(true, std::memory_order_release);
+            // Timed wait bounds the (unlikely) lost wake-up between the check and the wait
+            wakeUp_.wait_for(lock, std::chrono::milliseconds(1), [&]()
+            {
+                return head_.load(std::memory_order_acquire) != tail || stop_.load(std::memory_order_acquire)
+                    || synced_.load(std::memory_order_acquire) > taken;
+            });
+            sleeping_.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        const auto nb = std::min<unsigned long long>(head - tail, maxIov);
+        for (auto i = 0ULL; i < nb; ++i)
+        {
+            const auto idx = (tail + i) % nbBuffers_;
+            iov[i].iov_base = &buffers_[idx * bufferSize_];
+            iov[i].iov_len = sizes_[idx];
+        }
+        // Part already taken before its publication
+        iov[0].iov_base = static_cast<char*>(iov[0].iov_base) + taken;
+        iov[0].iov_len -= taken;
+        taken = 0UL;
+        write(iov, static_cast<int>(nb));
+        tail += nb;
+        tail_.store(tail, std::memory_order_release);
+    }
+}
+
+void AsyncSink::write(struct iovec* iov, int iovcnt)
+{
+    while (iovcnt > 0)
+    {
+        auto written = writev(fd_, iov, iovcnt);
+        nbWrites_.fetch_add(1ULL, std::memory_order_relaxed);
+        if (unlikely(written < 0))
+        {
+            if (errno == EINTR) continue;
+            nbErrors_.fetch_add(1ULL, std::memory_order_relaxed);
+            return; // drop them rather than blocking the producer forever
+        }
+        nbBytes_.fetch_add(static_cast<unsigned long long>(written), std::memory_order_relaxed);
+        auto len = static_cast<size_t>(written);
+        while (iovcnt > 0 && len >= iov->iov_len)
+        {
+            len -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + len;
+            iov->iov_len -= len;
+        }
+    }
+}
@@ -6,6 +6,8 @@
 // action = A (add), X (remove), M (modify)
 // side = B (buy), S (sell)
 // if action = T (Trade) : action,quantity,price
+// Extended format (detected per message): optional trailing fields ,timestamp[,sequence]
+// timestamp = exchange time in ns since epoch, sequence = message sequence number
 bool Parser::parse(const char* str, size_t len, Errors& errors, const int verbose)
 {
     auto i = 0UL;
@@ -335,6 +337,7 @@ bool Parser::parse(const char* str, size_t len, Errors& errors, const int verbos
                 return false;
             }
             if (unlikely(verbose > 2)) std::cerr << "extractPrice true : " << str << std::endl;
+            i = end;
             return true;
         }
         if (verbose > 0) std::cerr << "Missing price in [" << str << "]" << std::endl;
@@ -342,11 +345,31 @@ bool Parser::parse(const char* str, size_t len, Errors& errors, const int verbos
         return false;
     };
     
+    // Unsigned field after a comma, true when absent (end of line, comment or other separator)
+    auto extractOptional = [&](unsigned long long& value) -> bool
+    {
+        for (; i < len && ' ' == str[i]; ++i);
+        if (likely(i == len || ',' != str[i])) return true;
+        auto start = ++i;
+        for (; i < len && ' ' == str[i]; ++i) ++start;
+        for (; i < len && std::isdigit(str[i]); ++i);
+        const auto dataLen = i - start;
+        if (unlikely(0UL == dataLen || dataLen > 19UL || (i < len && ' ' != str[i] && ',' != str[i] && '/' != str[i])))
+        {
+            if (verbose > 0) std::cerr << "Expected valid timestamp or sequence in [" << str << "]" << std::endl;
+            ++errors.corruptedMessages;
+            return false;
+        }
+        value = Decoder::retreive_unsigned_integer<unsigned long long>(&str[start], dataLen);
+        return true;
+    };
+    
     return (firstField()      &&
             extractAction()   && nextField() &&
             extractOrderId()  && nextField() &&
             extractSide()     && nextField() &&
             extractQty()      && nextField() &&
-            extractPrice());
+            extractPrice()    &&
+            extractOptional(timestamp_) && extractOptional(sequence_));
 }
 
@@ -0,0 +1,88 @@
+#include "utils/PerfCounters.h"
+
+#include <cstring>
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+    int perfEventOpen(unsigned int type, unsigned long long config, int groupFd)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = (-1 == groupFd) ? 1 : 0; // the group leader starts all of them
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0UL));
+    }
+}
+
+bool PerfCounters::open()
+{
+    if (isOpen()) return true;
+    static constexpr unsigned long long l1dReadMiss = PERF_COUNT_HW_CACHE_L1D
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const std::array<std::pair<unsigned int, unsigned long long>, NB_EVENTS> events{{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, l1dReadMiss},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+    }};
+    // One group => counters scheduled together on the PMU
+    for (auto i = 0U; i < NB_EVENTS; ++i)
+    {
+        fds_[i] = perfEventOpen(events[i].first, events[i].second, fds_[CYCLES]);
+        if (CYCLES == i && -1 == fds_[i]) return false;
+    }
+    const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    for (auto i = 0U; i < NB_EVENTS; ++i)
+    {
+        if (-1 == fds_[i]) continue;
+        void* page = mmap(nullptr, pageSize, PROT_READ, MAP_SHARED, fds_[i], 0);
+        pages_[i] = (MAP_FAILED == page) ? nullptr : static_cast<perf_event_mmap_page*>(page);
+    }
+    ioctl(fds_[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void PerfCounters::close()
+{
+    const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    // Leader last
+    for (auto i = static_cast<unsigned int>(NB_EVENTS); i-- > 0U; )
+    {
+        if (pages_[i] != nullptr) munmap(pages_[i], pageSize);
+        pages_[i] = nullptr;
+        if (-1 != fds_[i]) ::close(fds_[i]);
+        fds_[i] = -1;
+    }
+}
+
+const char* PerfCounters::name(Event event)
+{
+    switch(event)
+    {
+    case CYCLES: return "cycles";
+    case INSTRUCTIONS: return "instructions";
+    case L1D_MISSES: return "L1D misses";
+    case LLC_MISSES: return "LLC misses";
+    case BRANCH_MISSES: return "branch misses";
+    case NB_EVENTS: break;
+    }
+    return "";
+}
+
+unsigned long long PerfCounters::readSyscall(unsigned int event) const
+{
+    unsigned long long count = 0ULL;
+    if (-1 == fds_[event] || ::read(fds_[event], &count, sizeof(count)) != sizeof(count)) return 0ULL;
+    return count;
+}
@@ -0,0 +1,105 @@
+#include "utils/Tuning.h"
+
+#include <cstring>
+#include <cstdlib>
+
+#include <alloca.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << 26) // log2(1 GB) << MAP_HUGE_SHIFT
+#endif
+
+namespace tuning
+{
+    bool pinThread(int cpu)
+    {
+        if (cpu < 0) return false;
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(static_cast<size_t>(cpu) % CPU_SETSIZE, &cpuset);
+        return 0 == pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+    }
+
+    bool setFifo(int priority)
+    {
+        sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = priority;
+        return 0 == pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    }
+
+    bool lockMemory()
+    {
+        return 0 == mlockall(MCL_CURRENT | MCL_FUTURE);
+    }
+
+    void prefaultHeap(size_t bytes)
+    {
+        // Freed memory stays in the heap instead of going back to the kernel
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+        auto* heap = static_cast<volatile char*>(malloc(bytes));
+        if (heap == nullptr) return;
+        const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        for (auto i = 0UL; i < bytes; i += pageSize) heap[i] = 0;
+        free(const_cast<char*>(heap));
+    }
+
+    void prefaultStack(size_t bytes)
+    {
+        auto* stack = static_cast<volatile char*>(alloca(bytes));
+        const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        for (auto i = 0UL; i < bytes; i += pageSize) stack[i] = 0;
+    }
+
+    bool mapAnonymous(size_t size, bool hugePages, Mapping& mapping)
+    {
+        unmap(mapping);
+        if (0UL == size) return false;
+        static constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE;
+        if (hugePages && size >= GIGANTIC_PAGE_SIZE)
+        {
+            const auto gigaSize = (size + GIGANTIC_PAGE_SIZE - 1) / GIGANTIC_PAGE_SIZE * GIGANTIC_PAGE_SIZE;
+            void* data = mmap(nullptr, gigaSize, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB | MAP_HUGE_1GB, -1, 0);
+            if (data != MAP_FAILED)
+            {
+                mapping = Mapping{data, gigaSize, true};
+                return true;
+            }
+        }
+        if (hugePages)
+        {
+            const auto hugeSize = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            void* data = mmap(nullptr, hugeSize, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+            if (data != MAP_FAILED)
+            {
+                mapping = Mapping{data, hugeSize, true};
+                return true;
+            }
+        }
+        const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const auto regularSize = (size + pageSize - 1) / pageSize * pageSize;
+        void* data = mmap(nullptr, regularSize, PROT_READ | PROT_WRITE, hugePages ? flags & ~MAP_POPULATE : flags, -1, 0);
+        if (MAP_FAILED == data) return false;
+        if (hugePages)
+        {
+            // Advised before the first touch, so faults can already allocate transparent huge pages
+            madvise(data, regularSize, MADV_HUGEPAGE);
+            auto* bytes = static_cast<volatile char*>(data);
+            for (auto i = 0UL; i < regularSize; i += pageSize) bytes[i] = 0;
+        }
+        mapping = Mapping{data, regularSize, false};
+        return true;
+    }
+
+    void unmap(Mapping& mapping)
+    {
+        if (mapping.data_ != nullptr) munmap(mapping.data_, mapping.size_);
+        mapping = Mapping{};
+    }
+}
@@ -0,0 +1,43 @@
+#include "utils/WaitStrategy.h"
+
+#include <cstring>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static_assert(sizeof(std::atomic<unsigned int>) == sizeof(int), "Futex word must be a plain int");
+
+bool WaitStrategy::parse(const char* name, Mode& mode)
+{
+    if (!strcmp(name, "spin")) mode = Mode::BUSY_SPIN;
+    else if (!strcmp(name, "yield")) mode = Mode::SPIN_YIELD;
+    else if (!strcmp(name, "park")) mode = Mode::SPIN_PARK;
+    else return false;
+    return true;
+}
+
+const char* WaitStrategy::name(Mode mode)
+{
+    switch(mode)
+    {
+    case Mode::BUSY_SPIN: return "spin";
+    case Mode::SPIN_YIELD: return "yield";
+    case Mode::SPIN_PARK: return "park";
+    }
+    return "";
+}
+
+void WaitStrategy::park(unsigned int epoch)
+{
+    // Bounded sleep: a stop flag set without wake() is still seen
+    timespec timeout{0, 10'000'000L};
+    syscall(SYS_futex, reinterpret_cast<unsigned int*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, &timeout, nullptr, 0);
+}
+
+void WaitStrategy::wake()
+{
+    epoch_.fetch_add(1U, std::memory_order_release);
+    syscall(SYS_futex, reinterpret_cast<unsigned int*>(&epoch_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
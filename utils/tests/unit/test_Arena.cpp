@@ -0,0 +1,113 @@
+#include <rapidcheck.h>
+
+#include "utils/Arena.h"
+#include "utils/WaitFreeQueue.h"
+
+#include <unordered_map>
+#include <map>
+#include <deque>
+#include <chrono>
+
+int main()
+{
+    rc::check("Blocks are aligned, distinct and recycled once freed", []()
+    {
+        Arena arena;
+        RC_ASSERT(arena.reserve(1024 * 1024, false));
+        RC_ASSERT(arena.capacity() >= 1024 * 1024);
+        const auto bytes = static_cast<size_t>(*rc::gen::inRange(1, 10'000));
+        std::map<char*, size_t> blocks;
+        for (auto i = 0; i < 20; ++i)
+        {
+            auto* block = static_cast<char*>(arena.allocate(bytes));
+            RC_ASSERT(0UL == reinterpret_cast<uintptr_t>(block) % Arena::ALIGNMENT);
+            auto next = blocks.lower_bound(block);
+            RC_ASSERT(next == blocks.end() || block + bytes <= next->first);
+            RC_ASSERT(next == blocks.begin() || std::prev(next)->first + bytes <= block);
+            blocks.emplace(block, bytes);
+        }
+        const auto used = arena.used();
+        auto* last = blocks.rbegin()->first;
+        arena.deallocate(last, bytes);
+        RC_ASSERT(last == arena.allocate(bytes));
+        RC_ASSERT(used == arena.used());
+        RC_ASSERT(0ULL == arena.nbFallbacks());
+    });
+
+    rc::check("Exhausted arena falls back on the heap", []()
+    {
+        Arena arena;
+        RC_ASSERT(arena.reserve(4096, false));
+        const auto bytes = static_cast<size_t>(*rc::gen::inRange(1, 4096));
+        std::vector<void*> blocks;
+        while (0ULL == arena.nbFallbacks()) blocks.push_back(arena.allocate(bytes));
+        RC_ASSERT(arena.used() <= arena.capacity());
+        for (auto* block : blocks) arena.deallocate(block, bytes); // heap one included
+        RC_ASSERT(arena.nbFallbacks() == 1ULL);
+    });
+
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL, time_span2 = 0ULL;
+    auto nbTests = 0U;
+    rc::check("Containers on an arena behave like on the heap", [&]()
+    {
+        Arena arena;
+        RC_ASSERT(arena.reserve(16 * 1024 * 1024, *rc::gen::arbitrary<bool>()));
+        using Allocator = ArenaAllocator<std::pair<const unsigned int, double>>;
+        std::unordered_map<unsigned int, double, std::hash<unsigned int>, std::equal_to<unsigned int>, Allocator>
+            arenaMap(0, std::hash<unsigned int>(), std::equal_to<unsigned int>(), Allocator(&arena));
+        std::unordered_map<unsigned int, double> heapMap;
+        const auto nb = *rc::gen::inRange(1'000, 50'000);
+        std::vector<std::pair<unsigned int, bool>> operations; // key, insert
+        for (auto i = 0; i < nb; ++i) operations.emplace_back(*rc::gen::inRange(0U, 10'000U), *rc::gen::arbitrary<bool>());
+
+        start = high_resolution_clock::now();
+        for (auto& operation : operations)
+        {
+            if (operation.second) arenaMap.emplace(operation.first, operation.first);
+            else arenaMap.erase(operation.first);
+        }
+        end = high_resolution_clock::now();
+        time_span1 += duration_cast<nanoseconds>(end - start).count() / static_cast<unsigned long long>(nb);
+        start = high_resolution_clock::now();
+        for (auto& operation : operations)
+        {
+            if (operation.second) heapMap.emplace(operation.first, operation.first);
+            else heapMap.erase(operation.first);
+        }
+        end = high_resolution_clock::now();
+        time_span2 += duration_cast<nanoseconds>(end - start).count() / static_cast<unsigned long long>(nb);
+
+        RC_ASSERT(arenaMap.size() == heapMap.size());
+        for (auto& order : heapMap) RC_ASSERT(arenaMap.at(order.first) == order.second);
+        RC_ASSERT(0ULL == arena.nbFallbacks());
+
+        WaitFreeQueue<unsigned int> queue(&arena);
+        queue.dontSpin();
+        std::deque<unsigned int> model;
+        for (auto& operation : operations)
+        {
+            if (operation.second || model.empty())
+            {
+                queue.push_back(static_cast<unsigned int>(operation.first));
+                model.push_back(operation.first);
+            }
+            else
+            {
+                RC_ASSERT(queue.pop_front() == model.front());
+                model.pop_front();
+            }
+        }
+        for (auto value : model) RC_ASSERT(queue.pop_front() == value);
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Unordered map on arena perfs [" << time_span1/nbTests << "] vs heap [" << time_span2/nbTests << "] (in ns)" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <rapidcheck.h>
+
+#include "utils/AsyncSink.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+int main()
+{
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL, time_span2 = 0ULL;
+    auto nbTests = 0U;
+    auto nbStalls = 0ULL;
+    rc::check("Written output is the formatted output", [&]()
+    {
+        char filename[] = "/tmp/test_AsyncSinkXXXXXX";
+        const int fd = mkstemp(filename);
+        RC_ASSERT(fd >= 0);
+        unlink(filename);
+
+        // Small ring and buffers to also test backpressure and lines over many buffers
+        const auto nbBuffers = *rc::gen::inRange<size_t>(2, 8);
+        const auto bufferSize = *rc::gen::inRange<size_t>(16, 256);
+        const auto nbLines = *rc::gen::inRange<size_t>(0, 500);
+        const auto lines = *rc::gen::container<std::vector<std::string>>(nbLines, rc::gen::arbitrary<std::string>());
+        std::string expected;
+        AsyncSink::Stats stats;
+        {
+            AsyncSink sink(fd, nbBuffers, bufferSize);
+            std::ostream os(&sink);
+            for (auto& line : lines)
+            {
+                if (line.size() & 1) os << line << '\n';
+                else
+                {
+                    os.rdbuf()->sputn(line.c_str(), static_cast<std::streamsize>(line.size()));
+                    os.rdbuf()->sputn("\n", 1);
+                }
+                os.flush();
+                expected += line;
+                expected += '\n';
+            }
+            sink.close();
+            stats = sink.stats();
+        }
+        nbStalls += stats.nbStalls_;
+        RC_ASSERT(expected.size() == stats.nbBytes_);
+        RC_ASSERT(0ULL == stats.nbErrors_);
+        RC_ASSERT(stats.nbWrites_ <= stats.nbBuffers_ + stats.nbTaken_);
+        RC_ASSERT(stats.maxPending_ <= nbBuffers);
+
+        std::string written(expected.size(), '\0');
+        RC_ASSERT(static_cast<ssize_t>(written.size()) == pread(fd, &written[0], written.size(), 0));
+        close(fd);
+        RC_ASSERT(written == expected);
+    });
+    std::cout << "Written output is the formatted output with [" << nbStalls << "] stalls" << std::endl;
+
+    rc::check("A flushed line is written without more output while the writer is busy", [&]()
+    {
+        int fds[2];
+        RC_ASSERT(0 == pipe(fds));
+        // Longer than the pipe capacity: writer blocked until it is read
+        const std::string first(*rc::gen::inRange<size_t>(70'000, 200'000), 'a');
+        const auto last = *rc::gen::arbitrary<std::string>() + '\n';
+        std::string read;
+        AsyncSink::Stats stats;
+        {
+            AsyncSink sink(fds[1]);
+            std::ostream os(&sink);
+            os << first;
+            os.flush();
+            os << last;
+            os.flush();
+
+            // Nothing else formatted: all read only if the writer took the last line
+            const auto expected = first.size() + last.size();
+            char buffer[65'536];
+            pollfd pfd{fds[0], POLLIN, 0};
+            while (read.size() < expected && poll(&pfd, 1, 1'000) > 0)
+            {
+                const auto len = ::read(fds[0], buffer, sizeof(buffer));
+                if (len <= 0) break;
+                read.append(buffer, static_cast<size_t>(len));
+            }
+            sink.close();
+            stats = sink.stats();
+        }
+        close(fds[0]);
+        close(fds[1]);
+        RC_ASSERT(first + last == read);
+        RC_ASSERT(stats.nbTaken_ >= 1ULL);
+    });
+
+    rc::check("Write lines to /dev/null", [&]()
+    {
+        const int fd = open("/dev/null", O_WRONLY);
+        RC_ASSERT(fd >= 0);
+        const auto nb = *rc::gen::inRange(100, 10'000);
+        const std::string line = "1234.500000\n";
+
+        start = high_resolution_clock::now();
+        for (auto i = 0; i < nb; ++i)
+        {
+            RC_ASSERT(static_cast<ssize_t>(line.size()) == write(fd, line.c_str(), line.size()));
+        }
+        end = high_resolution_clock::now();
+        time_span1 += duration_cast<nanoseconds>(end - start).count() / nb;
+
+        AsyncSink sink(fd);
+        std::ostream os(&sink);
+        start = high_resolution_clock::now();
+        for (auto i = 0; i < nb; ++i)
+        {
+            os.rdbuf()->sputn(line.c_str(), static_cast<std::streamsize>(line.size()));
+            os.flush();
+        }
+        end = high_resolution_clock::now();
+        time_span2 += duration_cast<nanoseconds>(end - start).count() / nb;
+        sink.close();
+        RC_ASSERT(nb * line.size() == sink.stats().nbBytes_);
+        close(fd);
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Write lines to /dev/null perfs [" << time_span1/nbTests
+            << "] and through AsyncSink [" << time_span2/nbTests << "] (in ns)" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <rapidcheck.h>
+
+#include "utils/ConflatingQueue.h"
+
+#include <thread>
+#include <future>
+#include <map>
+#include <vector>
+#include <chrono>
+
+struct Update
+{
+    size_t key_ = 0;
+    unsigned int value_ = 0;
+};
+
+int main()
+{
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL, time_span2 = 0ULL;
+    auto nbTests = 0U;
+    rc::check("Only latest pending update per key", [&]()
+    {
+        ConflatingQueue<Update, 256> queue;
+        queue.dontSpin();
+        const auto nb = *rc::gen::inRange<unsigned int>(10, 10'000);
+        std::map<size_t, unsigned int> latest;
+
+        start = high_resolution_clock::now();
+        for (auto i = 1U; i <= nb; ++i)
+        {
+            const auto key = *rc::gen::inRange<size_t>(0, 256);
+            latest[key] = i;
+            queue.push_back(key, Update{key, i});
+        }
+        end = high_resolution_clock::now();
+        time_span1 += (duration_cast<nanoseconds>(end - start).count()) / nb;
+        RC_ASSERT(nb - latest.size() == queue.nbConflated());
+
+        const auto nbPending = latest.size();
+        for (auto i = 0UL; i < nbPending; ++i)
+        {
+            auto update = queue.pop_front();
+            RC_ASSERT(latest[update.key_] == update.value_);
+            RC_ASSERT(update.value_ > 0U);
+            latest.erase(update.key_);
+        }
+        RC_ASSERT(latest.empty());
+        RC_ASSERT(0U == queue.pop_front().value_);
+
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Only latest pending update per key perfs [" << time_span1/nbTests << "] (in ns)" << std::endl;
+    }
+
+    rc::check("Never conflate updates already read or invalidated", [&]()
+    {
+        ConflatingQueue<Update, 256> queue;
+        queue.dontSpin();
+        const auto key = *rc::gen::inRange<size_t>(0, 256);
+
+        queue.push_back(key, Update{key, 1U});
+        RC_ASSERT(1U == queue.pop_front().value_);
+        queue.push_back(key, Update{key, 2U});
+        RC_ASSERT(0ULL == queue.nbConflated());
+
+        queue.invalidate(*rc::gen::inRange<size_t>(0, key+1), 256);
+        queue.push_back(key, Update{key, 3U});
+        RC_ASSERT(0ULL == queue.nbConflated());
+        queue.push_back(key, Update{key, 4U});
+        RC_ASSERT(1ULL == queue.nbConflated());
+
+        queue.push_back(Update{key, 5U});
+        queue.push_back(key, Update{key, 6U});
+        RC_ASSERT(2ULL == queue.nbConflated());
+
+        RC_ASSERT(2U == queue.pop_front().value_);
+        RC_ASSERT(6U == queue.pop_front().value_);
+        RC_ASSERT(5U == queue.pop_front().value_);
+        RC_ASSERT(0U == queue.pop_front().value_);
+
+        queue.push_back(1'000, Update{1'000, 7U}); // out of bitmap => appended
+        queue.push_back(1'000, Update{1'000, 8U});
+        RC_ASSERT(7U == queue.pop_front().value_);
+        RC_ASSERT(8U == queue.pop_front().value_);
+    });
+
+    rc::check("Batches drain the latest pending updates and keep conflating the rest", [&]()
+    {
+        ConflatingQueue<Update, 256> queue;
+        queue.dontSpin();
+        const auto nb = *rc::gen::inRange<unsigned int>(1, 1'000);
+        const auto max = *rc::gen::inRange<size_t>(1, 100);
+        std::map<size_t, unsigned int> latest;
+        std::vector<Update> batch(max);
+        auto nbRead = 0ULL;
+        for (auto i = 1U; i <= nb; ++i)
+        {
+            const auto key = *rc::gen::inRange<size_t>(0, 256);
+            latest[key] = i;
+            queue.push_back(key, Update{key, i});
+            if (*rc::gen::inRange(0, 10) == 0)
+            {
+                const auto nbBatch = queue.pop_front(batch.data(), max);
+                RC_ASSERT(nbBatch > 0UL && nbBatch <= max);
+                nbRead += nbBatch;
+            }
+        }
+        for (auto nbBatch = queue.pop_front(batch.data(), max); nbBatch; nbBatch = queue.pop_front(batch.data(), max))
+        {
+            RC_ASSERT(nbBatch <= max);
+            nbRead += nbBatch;
+            for (auto i = 0UL; i < nbBatch; ++i) RC_ASSERT(latest[batch[i].key_] == batch[i].value_);
+        }
+        RC_ASSERT(nbRead + queue.nbConflated() == nb);
+        queue.push_back(latest.begin()->first, Update{latest.begin()->first, nb+1});
+        RC_ASSERT(1UL == queue.pop_front(batch.data(), max)); // popped ones are never conflated
+        RC_ASSERT(nb+1 == batch[0].value_);
+    });
+
+    time_span1 = 0ULL, time_span2 = 0ULL;
+    nbTests = 0U;
+    rc::check("Dual threads publish and read", [&]()
+    {
+        std::promise<void> ready;
+        std::shared_future<void> go(ready.get_future());
+
+        ConflatingQueue<Update, 256> queue;
+        const auto nb = *rc::gen::inRange<unsigned int>(10, 100'000);
+        std::array<unsigned int, 256> lastRead{};
+        auto nbRead = 0ULL;
+        auto backInTime = false;
+
+        auto threaded_read = [&]()
+        {
+            go.wait();
+            high_resolution_clock::time_point start = high_resolution_clock::now();
+            while (1)
+            {
+                auto update = queue.pop_front();
+                if (update.value_ == 0U) break;
+                if (update.value_ <= lastRead[update.key_]) backInTime = true;
+                lastRead[update.key_] = update.value_;
+                ++nbRead;
+            }
+            high_resolution_clock::time_point end = high_resolution_clock::now();
+            if (nbRead) time_span2 += (duration_cast<nanoseconds>(end - start).count()) / nbRead;
+        };
+        std::thread thr(threaded_read);
+
+        ready.set_value();
+        start = high_resolution_clock::now();
+        for (auto i = 1U; i <= nb; ++i)
+        {
+            const size_t key = i & 255;
+            queue.push_back(key, Update{key, i});
+        }
+        end = high_resolution_clock::now();
+        time_span1 += (duration_cast<nanoseconds>(end - start).count()) / nb;
+        queue.dontSpin();
+        thr.join();
+
+        RC_ASSERT(!backInTime);
+        RC_ASSERT(nbRead + queue.nbConflated() == nb);
+        RC_ASSERT(lastRead[nb & 255] == nb);
+
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Dual threads publish and read perfs [" << time_span1/nbTests
+            << '|' << time_span2/nbTests << "] (in ns)" << std::endl;
+    }
+
+    return 0;
+}
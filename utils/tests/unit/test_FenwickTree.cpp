@@ -0,0 +1,69 @@
+#include <rapidcheck.h>
+
+#include "utils/FenwickTree.h"
+
+#include <algorithm>
+#include <vector>
+#include <chrono>
+
+int main()
+{
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL, time_span2 = 0ULL;
+    auto nbTests = 0U;
+    rc::check("Prefix sums and lower bounds match the values", [&]()
+    {
+        const auto size = *rc::gen::inRange<size_t>(1, 5'000);
+        FenwickTree<unsigned long long> tree(size);
+        RC_ASSERT(tree.size() >= size);
+        RC_ASSERT(0ULL == (tree.size() & (tree.size() - 1)));
+        std::vector<unsigned long long> values(tree.size(), 0ULL);
+
+        const auto nb = *rc::gen::inRange<size_t>(1, 10'000);
+        start = high_resolution_clock::now();
+        for (auto i = 0UL; i < nb; ++i)
+        {
+            const auto index = *rc::gen::inRange<size_t>(0, size);
+            const auto value = *rc::gen::inRange<unsigned long long>(0, 1'000);
+            tree.add(index, value - values[index]); // decreases wrap around
+            values[index] = value;
+        }
+        end = high_resolution_clock::now();
+        time_span1 += static_cast<unsigned long long>(duration_cast<nanoseconds>(end - start).count()) / nb;
+
+        auto sum = 0ULL;
+        for (auto i = 0UL; i < values.size(); ++i)
+        {
+            sum += values[i];
+            RC_ASSERT(sum == tree.prefix(i));
+        }
+        RC_ASSERT(sum == tree.total());
+        RC_ASSERT(sum == tree.prefix(values.size() + 10));
+
+        start = high_resolution_clock::now();
+        for (auto target = 1ULL; target <= sum; target += 1 + sum / 100)
+        {
+            const auto bound = tree.lowerBound(target);
+            RC_ASSERT(bound < values.size());
+            RC_ASSERT(tree.prefix(bound) >= target);
+            RC_ASSERT(0UL == bound || tree.prefix(bound - 1) < target);
+        }
+        end = high_resolution_clock::now();
+        time_span2 += static_cast<unsigned long long>(duration_cast<nanoseconds>(end - start).count()) / 101;
+        RC_ASSERT(tree.size() == tree.lowerBound(sum + 1));
+        RC_ASSERT(0UL == tree.lowerBound(0ULL));
+
+        tree.clear();
+        RC_ASSERT(0ULL == tree.total());
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Fenwick tree add perfs [" << time_span1/nbTests << "] and lower bound [" << time_span2/nbTests << "] (in ns)" << std::endl;
+    }
+
+    return 0;
+}
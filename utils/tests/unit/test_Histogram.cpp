@@ -0,0 +1,84 @@
+#include <rapidcheck.h>
+
+#include "utils/Histogram.h"
+#include "utils/Tsc.h"
+
+#include <vector>
+#include <chrono>
+
+int main()
+{
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL;
+    auto nbTests = 0U;
+    rc::check("Percentiles within the sub-bucket precision", [&]()
+    {
+        Histogram<> hist;
+        const auto nb = *rc::gen::inRange<size_t>(1, 10'000);
+        const auto maxValue = *rc::gen::element(100ULL, 100'000ULL, 10'000'000'000ULL);
+        std::vector<unsigned long long> values;
+        for (auto i = 0UL; i < nb; ++i) values.emplace_back(*rc::gen::inRange<unsigned long long>(0, maxValue));
+
+        start = high_resolution_clock::now();
+        for (auto value : values) hist.record(value);
+        end = high_resolution_clock::now();
+        time_span1 += duration_cast<nanoseconds>(end - start).count() / nb;
+
+        std::sort(values.begin(), values.end());
+        RC_ASSERT(hist.count() == nb);
+        RC_ASSERT(hist.min() == values.front());
+        RC_ASSERT(hist.max() == values.back());
+        for (auto p : { 50.0, 90.0, 99.0, 99.9, 100.0 })
+        {
+            auto rank = static_cast<size_t>(p / 100.0 * static_cast<double>(nb) + 0.5);
+            if (rank < 1UL) rank = 1UL;
+            const auto expected = values[rank-1];
+            const auto percentile = hist.percentile(p);
+            RC_ASSERT(percentile >= expected);
+            RC_ASSERT(percentile - expected <= expected / Histogram<>::SUB_BUCKETS);
+        }
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Percentiles within the sub-bucket precision record perfs [" << time_span1/nbTests << "] (in ns)" << std::endl;
+    }
+
+    rc::check("Merged histograms count every value", [&]()
+    {
+        Histogram<> hist1, hist2, all;
+        const auto nb = *rc::gen::inRange(1, 1'000);
+        for (auto i = 0; i < nb; ++i)
+        {
+            const auto value = *rc::gen::arbitrary<unsigned long long>();
+            (*rc::gen::arbitrary<bool>() ? hist1 : hist2).record(value);
+            all.record(value);
+        }
+        hist1 += hist2;
+        RC_ASSERT(hist1.count() == all.count());
+        RC_ASSERT(hist1.min() == all.min());
+        RC_ASSERT(hist1.max() == all.max());
+        RC_ASSERT(hist1.percentile(99.0) == all.percentile(99.0));
+        hist1.reset();
+        RC_ASSERT(0ULL == hist1.count());
+        RC_ASSERT(0ULL == hist1.percentile(50.0));
+    });
+
+    rc::check("TSC calibrated against steady_clock", [&]()
+    {
+        const auto ticks = tsc::now();
+        const auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const auto elapsedNs = static_cast<double>(std::chrono::duration_cast<nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        const auto measuredNs = tsc::toNs(tsc::now() - ticks);
+        RC_ASSERT(measuredNs > 0.5 * elapsedNs);
+        RC_ASSERT(measuredNs < 2.0 * elapsedNs + 1'000'000.0);
+    });
+    std::cout << "TSC [" << tsc::nsPerTick() << "] ns per tick" << std::endl;
+
+    return 0;
+}
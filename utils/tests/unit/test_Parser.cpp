@@ -720,6 +720,60 @@ int main(int argc, char **argv)
             << time_span2/nbTests << "] (in ns)" << std::endl;
     }
     
+    time_span1 = 0ULL;
+    nbTests = 0U;
+    rc::check("Parse extended lines with timestamp and sequence", [&](std::string comment) 
+    {
+        const auto action = *rc::gen::element('A', 'X', 'M', 'T');
+        const auto orderId = *rc::gen::inRange<OrderId>(1, maxOrderId);
+        const auto side = *rc::gen::element('B', 'S');
+        const auto qty = *rc::gen::inRange<Quantity>(1, maxOrderQty);
+        const auto price = *rc::gen::inRange(1, maxOrderPrice);
+        const auto timestamp = *rc::gen::inRange<unsigned long long>(1, 10'000'000'000'000'000'000ULL);
+        const auto sequence = *rc::gen::inRange<unsigned long long>(1, 1'000'000'000'000ULL);
+        const auto nbFields = *rc::gen::inRange(0, 3);
+        
+        std::string line = spaces(10) + action + spaces(10) + ',';
+        if ('T' != action) line += std::to_string(orderId) + spaces(10) + ',' + spaces(10) + side + ',';
+        line += spaces(10) + std::to_string(qty) + ',' + std::to_string(price) + spaces(10);
+        if (nbFields > 0) line += ',' + spaces(10) + std::to_string(timestamp) + spaces(10);
+        if (nbFields > 1) line += ',' + std::to_string(sequence);
+        
+        auto test_parse = [&]() 
+        {
+            Errors errors;
+            Parser parser;
+            start = high_resolution_clock::now();
+            bool ret = parser.parse(line.c_str(), line.length(), errors, verbose);
+            end = high_resolution_clock::now();
+            time_span1 += duration_cast<nanoseconds>(end - start).count();
+            RC_LOG() << "line [" << line << ']' << std::endl;
+            RC_ASSERT(true == ret);
+            RC_ASSERT(errors.nbErrors() == 0ULL);
+            RC_ASSERT(action == parser.getAction());
+            if ('T' != action) RC_ASSERT(orderId == parser.getOrderId());
+            RC_ASSERT(qty == parser.getQty());
+            RC_ASSERT(static_cast<Price>(price) == parser.getPrice());
+            RC_ASSERT((nbFields > 0 ? timestamp : 0ULL) == parser.getTimestamp());
+            RC_ASSERT((nbFields > 1 ? sequence : 0ULL) == parser.getSequence());
+        };
+        test_parse();
+        line += ("//" + comment);
+        test_parse();
+        nbTests += 2;
+        
+        // Empty or non numeric trailing field
+        Errors errors;
+        Parser parser;
+        line = std::string("A,1,B,10,100,") + *rc::gen::element("", "12a", "-5", "1.5");
+        RC_ASSERT(false == parser.parse(line.c_str(), line.length(), errors, verbose));
+        RC_ASSERT(1ULL == errors.corruptedMessages);
+    });
+    if (nbTests)
+    {
+        std::cout << "Parse extended lines perfs  [" << time_span1/nbTests << "] (in ns)" << std::endl;
+    }
+    
     return 0;
 }
 
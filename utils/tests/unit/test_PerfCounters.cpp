@@ -0,0 +1,54 @@
+#include <rapidcheck.h>
+
+#include "utils/PerfCounters.h"
+
+#include <chrono>
+
+int main()
+{
+    PerfCounters counters;
+    if (!counters.open())
+    {
+        // Containers and CI runners often forbid perf_event_open
+        std::cout << "Hardware counters not available (see /proc/sys/kernel/perf_event_paranoid), tests skipped" << std::endl;
+        return 0;
+    }
+
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL;
+    auto nbReads = 0ULL;
+    rc::check("Instructions grow with the work done", [&]()
+    {
+        const auto nb = *rc::gen::inRange(1'000, 100'000);
+        PerfCounters::Sample before, middle, after;
+        start = high_resolution_clock::now();
+        counters.read(before);
+        end = high_resolution_clock::now();
+        time_span1 += duration_cast<nanoseconds>(end - start).count();
+        ++nbReads;
+        volatile auto sum = 0ULL;
+        for (auto i = 0; i < nb; ++i) sum = sum + static_cast<unsigned long long>(i);
+        counters.read(middle);
+        for (auto i = 0; i < 2 * nb; ++i) sum = sum + static_cast<unsigned long long>(i);
+        counters.read(after);
+
+        for (auto e = 0U; e < PerfCounters::NB_EVENTS; ++e)
+        {
+            RC_ASSERT(middle[e] >= before[e]);
+            RC_ASSERT(after[e] >= middle[e]);
+        }
+        const auto first = middle[PerfCounters::INSTRUCTIONS] - before[PerfCounters::INSTRUCTIONS];
+        const auto second = after[PerfCounters::INSTRUCTIONS] - middle[PerfCounters::INSTRUCTIONS];
+        RC_ASSERT(first >= static_cast<unsigned long long>(nb));
+        RC_ASSERT(second > first);
+    });
+    if (nbReads)
+    {
+        std::cout << "Counters read perfs [" << time_span1/nbReads << "] (in ns)" << std::endl;
+    }
+
+    return 0;
+}
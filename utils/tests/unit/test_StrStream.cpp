@@ -161,6 +161,20 @@ int main()
             << "] std::string [" << time_span2/nbTests << "] (in ns)" << std::endl;
     }
     
+    rc::check("Reuse a string after clear (> 1024 characters)", [&]() 
+    {
+        StrStream strstream;
+        for (auto i = 0; i < 3; ++i)
+        {
+            auto size = *rc::gen::inRange<int>(static_cast<int>(StrStream::capacity()+1), static_cast<int>(2*StrStream::capacity()));
+            auto str = *rc::gen::container<std::string>(size, rc::gen::character<typename std::string::value_type>());
+            strstream.clear();
+            strstream.append(str.c_str(), str.length());
+            RC_ASSERT(strstream.length() == str.length());
+            RC_ASSERT(strstream.c_str() == str);
+        }
+    });
+    
     time_span1 = 0ULL, time_span2 = 0ULL;
     nbTests = 0U;
     rc::check("Append an unsigned int to a string (< 1024 characters)", [&](std::string strOrigin, const unsigned int intToAppend)
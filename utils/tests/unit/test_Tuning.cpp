@@ -0,0 +1,63 @@
+#include <rapidcheck.h>
+
+#include "utils/Tuning.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+#include <unistd.h>
+
+int main()
+{
+    rc::check("Anonymous mappings are writable and rounded up to their page size", [](bool hugePages)
+    {
+        const auto size = static_cast<size_t>(*rc::gen::inRange(1, 8 * 1024 * 1024));
+        const auto fill = *rc::gen::arbitrary<char>();
+        tuning::Mapping mapping;
+        RC_ASSERT(tuning::mapAnonymous(size, hugePages, mapping));
+        RC_ASSERT(mapping.data_ != nullptr);
+        RC_ASSERT(mapping.size_ >= size);
+        const auto pageSize = mapping.huge_ ? tuning::HUGE_PAGE_SIZE : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        RC_ASSERT(0UL == mapping.size_ % pageSize);
+        RC_ASSERT(hugePages || !mapping.huge_);
+        auto* bytes = static_cast<char*>(mapping.data_);
+        RC_ASSERT(0 == bytes[0]);
+        memset(bytes, fill, size);
+        RC_ASSERT(fill == bytes[size-1]);
+        tuning::unmap(mapping);
+        RC_ASSERT(nullptr == mapping.data_);
+    });
+
+    rc::check("Threads can be pinned on any cpu they are allowed on", []()
+    {
+        cpu_set_t allowed;
+        RC_ASSERT(0 == sched_getaffinity(0, sizeof(allowed), &allowed));
+        std::vector<int> cpus;
+        for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu) if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+        const auto cpu = *rc::gen::elementOf(cpus);
+        auto pinned = false;
+        std::thread thr([&]() { pinned = tuning::pinThread(cpu); });
+        thr.join();
+        RC_ASSERT(pinned);
+        RC_ASSERT(!tuning::pinThread(-1));
+    });
+
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    std::thread thr([&]()
+    {
+        start = high_resolution_clock::now();
+        tuning::prefaultHeap(64 * 1024 * 1024);
+        tuning::prefaultStack();
+        end = high_resolution_clock::now();
+    });
+    thr.join();
+    std::cout << "Prefault 64 MB heap and stack perfs [" << duration_cast<nanoseconds>(end - start).count() << "] (in ns)" << std::endl;
+
+    return 0;
+}
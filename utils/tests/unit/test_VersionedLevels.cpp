@@ -0,0 +1,135 @@
+#include <rapidcheck.h>
+
+#include "utils/VersionedLevels.h"
+
+#include <thread>
+#include <future>
+#include <deque>
+#include <chrono>
+
+int main()
+{
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    auto time_span1 = 0ULL, time_span2 = 0ULL;
+    auto nbTests = 0U;
+    rc::check("Insert, set and erase like a sorted deque", [&]()
+    {
+        VersionedLevels<int, 8> levels(16); // small pages and capacity to also test growth
+        std::deque<int> expected;
+        const auto nb = *rc::gen::inRange(10, 5'000);
+        auto desc = [](int l, int v) { return l > v; };
+
+        for (auto i = 0; i < nb; ++i)
+        {
+            const auto value = *rc::gen::inRange(0, 1'000);
+            auto it = std::lower_bound(levels.begin(), levels.end(), value, desc);
+            auto itExpected = std::lower_bound(expected.begin(), expected.end(), value, desc);
+            RC_ASSERT(it - levels.begin() == itExpected - expected.begin());
+            if (it != levels.end() && *it == value)
+            {
+                if (*rc::gen::inRange(0, 2))
+                {
+                    levels.erase(it);
+                    expected.erase(itExpected);
+                }
+                else
+                {
+                    levels.set(it, value);
+                    *itExpected = value;
+                }
+            }
+            else
+            {
+                start = high_resolution_clock::now();
+                levels.insert(it, value);
+                end = high_resolution_clock::now();
+                time_span1 += duration_cast<nanoseconds>(end - start).count();
+                expected.insert(itExpected, value);
+            }
+            RC_ASSERT(levels.size() == expected.size());
+        }
+        RC_ASSERT(std::equal(levels.begin(), levels.end(), expected.begin(), expected.end()));
+        for (auto i = 0UL; i < expected.size(); ++i) RC_ASSERT(levels[i] == expected[i]);
+
+        VersionedLevels<int, 8>::Snapshot snapshot;
+        start = high_resolution_clock::now();
+        RC_ASSERT(levels.snapshot(snapshot));
+        end = high_resolution_clock::now();
+        time_span2 += duration_cast<nanoseconds>(end - start).count();
+        RC_ASSERT(std::equal(snapshot.begin(), snapshot.end(), expected.begin(), expected.end()));
+
+        time_span1 /= nb;
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Insert, set and erase like a sorted deque perfs [" << time_span1/nbTests
+            << "] and snapshot [" << time_span2/nbTests << "] (in ns)" << std::endl;
+    }
+
+    time_span1 = 0ULL, time_span2 = 0ULL;
+    nbTests = 0U;
+    rc::check("Dual threads update and snapshot", [&]()
+    {
+        std::promise<void> ready;
+        std::shared_future<void> go(ready.get_future());
+
+        VersionedLevels<int, 16> levels(64);
+        const auto depth = *rc::gen::inRange(10, 2'000);
+        for (auto i = 0; i < depth; ++i) levels.insert(levels.end(), 1'000'000 - 2*i);
+        std::atomic<bool> stop{false};
+        auto nbSnapshots = 0U, nbConsistents = 0U;
+        auto sorted = true;
+
+        auto threaded_snapshot = [&]()
+        {
+            go.wait();
+            VersionedLevels<int, 16>::Snapshot snapshot;
+            while (!stop.load(std::memory_order_acquire))
+            {
+                if (levels.snapshot(snapshot))
+                {
+                    ++nbConsistents;
+                    sorted &= std::is_sorted(snapshot.begin(), snapshot.end(), std::greater<int>())
+                           && std::adjacent_find(snapshot.begin(), snapshot.end()) == snapshot.end();
+                }
+                ++nbSnapshots;
+            }
+        };
+        std::thread thr(threaded_snapshot);
+
+        ready.set_value();
+        const auto nb = *rc::gen::inRange(1'000, 50'000);
+        start = high_resolution_clock::now();
+        for (auto i = 0; i < nb; ++i)
+        {
+            // Most of the activity around the best level (odd values never collide with the prefilled ones)
+            const auto value = 1'000'001 + 2 * (i % 100);
+            auto it = std::lower_bound(levels.begin(), levels.end(), value, [](int l, int v) { return l > v; });
+            if (it != levels.end() && *it == value) levels.erase(it);
+            else levels.insert(it, value);
+        }
+        end = high_resolution_clock::now();
+        time_span1 += duration_cast<nanoseconds>(end - start).count() / nb;
+        stop.store(true, std::memory_order_release);
+        thr.join();
+
+        RC_ASSERT(sorted);
+        VersionedLevels<int, 16>::Snapshot snapshot;
+        RC_ASSERT(levels.snapshot(snapshot));
+        RC_ASSERT(std::equal(snapshot.begin(), snapshot.end(), levels.begin(), levels.end()));
+        time_span2 += nbSnapshots ? (100ULL * nbConsistents) / nbSnapshots : 100ULL;
+
+        ++nbTests;
+    });
+    if (nbTests)
+    {
+        std::cout << "Dual threads update and snapshot perfs [" << time_span1/nbTests
+            << "] (in ns) with [" << time_span2/nbTests << "%] consistent snapshots" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <rapidcheck.h>
+
+#include "utils/WaitStrategy.h"
+#include "utils/WaitFreeQueue.h"
+#include "utils/CircularBlock.h"
+
+#include <thread>
+#include <future>
+#include <chrono>
+
+int main()
+{
+    const auto modes = { WaitStrategy::Mode::BUSY_SPIN, WaitStrategy::Mode::SPIN_YIELD, WaitStrategy::Mode::SPIN_PARK };
+
+    rc::check("Wait strategies are parsed from their names", [&]()
+    {
+        for (auto mode : modes)
+        {
+            auto parsed = WaitStrategy::Mode::BUSY_SPIN;
+            RC_ASSERT(WaitStrategy::parse(WaitStrategy::name(mode), parsed));
+            RC_ASSERT(mode == parsed);
+        }
+        const auto unknown = *rc::gen::suchThat<std::string>([](const std::string& name)
+            { return name != "spin" && name != "yield" && name != "park"; });
+        auto parsed = WaitStrategy::Mode::SPIN_PARK;
+        RC_ASSERT(!WaitStrategy::parse(unknown.c_str(), parsed));
+        RC_ASSERT(WaitStrategy::Mode::SPIN_PARK == parsed);
+    });
+
+    using std::chrono::high_resolution_clock;
+    high_resolution_clock::time_point start, end;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    for (auto mode : modes)
+    {
+        auto time_span1 = 0ULL;
+        auto nbTests = 0U;
+        rc::check(std::string("Every publication is consumed in order (") + WaitStrategy::name(mode) + ")", [&]()
+        {
+            WaitFreeQueue<unsigned int> queue;
+            queue.setWaitStrategy(mode);
+            const auto nb = *rc::gen::inRange(1U, 20'000U);
+            const auto pauses = *rc::gen::inRange(0U, 5U); // idle periods => consumer parks
+            auto consumer = std::async(std::launch::async, [&]()
+            {
+                auto expected = 1U;
+                for (auto value = queue.pop_front(); value != 0U; value = queue.pop_front())
+                {
+                    if (value != expected) return false;
+                    ++expected;
+                }
+                return expected == nb + 1;
+            });
+            start = high_resolution_clock::now();
+            for (auto i = 1U; i <= nb; ++i)
+            {
+                queue.push_back(static_cast<unsigned int>(i));
+                if (pauses && 0U == i % (nb / pauses + 1)) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+            queue.dontSpin();
+            RC_ASSERT(consumer.get());
+            end = high_resolution_clock::now();
+            time_span1 += duration_cast<nanoseconds>(end - start).count() / nb;
+            ++nbTests;
+        });
+        if (nbTests)
+        {
+            std::cout << "Queue handoff (" << WaitStrategy::name(mode) << ") perfs [" << time_span1/nbTests << "] (in ns)" << std::endl;
+        }
+    }
+
+    rc::check("Parked consumer sleeps until notified or stopped", []()
+    {
+        WaitFreeQueue<unsigned int> queue;
+        queue.setWaitStrategy(WaitStrategy::Mode::SPIN_PARK);
+        const auto value = *rc::gen::inRange(1U, 1'000U);
+        auto consumer = std::async(std::launch::async, [&]()
+        {
+            const auto first = queue.pop_front();
+            return std::make_pair(first, queue.pop_front());
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        RC_ASSERT(queue.waitStrategy().nbParks() > 0ULL);
+        queue.push_back(static_cast<unsigned int>(value));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        queue.dontSpin();
+        const auto values = consumer.get();
+        RC_ASSERT(value == values.first);
+        RC_ASSERT(0U == values.second);
+    });
+
+    rc::check("Full or empty circular block waits with the strategy", [&]()
+    {
+        const auto mode = *rc::gen::element(WaitStrategy::Mode::BUSY_SPIN, WaitStrategy::Mode::SPIN_YIELD, WaitStrategy::Mode::SPIN_PARK);
+        auto block = std::make_unique<CircularBlock<unsigned int, 64>>();
+        block->setWaitStrategy(mode);
+        const auto nb = *rc::gen::inRange(1U, 10'000U);
+        auto consumer = std::async(std::launch::async, [&]()
+        {
+            auto sum = 0ULL;
+            for (auto i = 0U; i < nb; ++i) sum += block->empty();
+            return sum;
+        });
+        auto expected = 0ULL;
+        for (auto i = 1U; i <= nb; ++i)
+        {
+            block->fill(static_cast<unsigned int>(i));
+            expected += i;
+        }
+        RC_ASSERT(expected == consumer.get());
+    });
+
+    return 0;
+}